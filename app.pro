@@ -0,0 +1,40 @@
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++17
+
+TARGET = Voronoi_Diagram
+
+include(core/core.pri)
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+SOURCES += \
+	dialog/newmap/newmapdialog.cpp \
+	main.cpp \
+	mainwindow.cpp \
+	mywidget/clickgraphicsscene.cpp \
+	mywidget/linelayer.cpp \
+	mywidget/sitelayer.cpp
+
+HEADERS += \
+	dialog/newmap/newmapdialog.h \
+	mainwindow.h \
+	mywidget/clickgraphicsscene.h \
+	mywidget/linelayer.h \
+	mywidget/sitelayer.h
+
+FORMS += \
+	dialog/newmap/newmapdialog.ui \
+	mainwindow.ui
+
+CONFIG += lrelease
+CONFIG += embed_translations
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
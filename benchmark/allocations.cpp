@@ -0,0 +1,127 @@
+#include "allocations.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef __unix__
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+std::atomic<uint64_t> allocations{0};
+std::atomic<uint64_t> allocatedBytes{0};
+std::atomic<size_t> liveBytes{0};
+std::atomic<size_t> peakBytes{0};
+
+// every block starts with its size, padded to keep the alignment of malloc
+const size_t header = alignof(std::max_align_t);
+
+void* allocate(size_t size) noexcept
+{
+    auto* block = static_cast<char*>(std::malloc(size + header));
+    if (!block)
+        return nullptr;
+    *reinterpret_cast<size_t*>(block) = size;
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    size_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak &&
+           !peakBytes.compare_exchange_weak(peak, live,
+                                            std::memory_order_relaxed))
+        ;
+    return block + header;
+}
+
+void release(void* p) noexcept
+{
+    if (!p)
+        return;
+    char* block = static_cast<char*>(p) - header;
+    liveBytes.fetch_sub(*reinterpret_cast<size_t*>(block),
+                        std::memory_order_relaxed);
+    std::free(block);
+}
+
+void* allocateOrThrow(size_t size)
+{
+    void* p = allocate(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+}  // namespace
+
+void* operator new(size_t size)
+{
+    return allocateOrThrow(size);
+}
+void* operator new[](size_t size)
+{
+    return allocateOrThrow(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+void operator delete(void* p) noexcept
+{
+    release(p);
+}
+void operator delete[](void* p) noexcept
+{
+    release(p);
+}
+void operator delete(void* p, size_t) noexcept
+{
+    release(p);
+}
+void operator delete[](void* p, size_t) noexcept
+{
+    release(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    release(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    release(p);
+}
+
+AllocationCount allocationCount()
+{
+    return {allocations.load(std::memory_order_relaxed),
+            allocatedBytes.load(std::memory_order_relaxed)};
+}
+
+size_t liveHeapBytes()
+{
+    return liveBytes.load(std::memory_order_relaxed);
+}
+
+size_t peakHeapBytes()
+{
+    return peakBytes.load(std::memory_order_relaxed);
+}
+
+void resetPeakHeap()
+{
+    peakBytes.store(liveHeapBytes(), std::memory_order_relaxed);
+}
+
+long peakResidentKb()
+{
+#ifdef __unix__
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;
+#endif
+    return 0;
+}
@@ -0,0 +1,41 @@
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The benchmark replaces the global operator new and delete to count heap
+ * allocations and to track how many bytes are live. Over-aligned allocations
+ * aren't counted.
+ */
+struct AllocationCount {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+
+    AllocationCount operator-(const AllocationCount& rhs) const
+    {
+        return {allocations - rhs.allocations, bytes - rhs.bytes};
+    }
+};
+
+/**
+ * @brief allocations made so far by all threads
+ */
+AllocationCount allocationCount();
+/**
+ * @brief bytes currently allocated
+ */
+size_t liveHeapBytes();
+/**
+ * @brief most bytes allocated at once since the last resetPeakHeap()
+ */
+size_t peakHeapBytes();
+void resetPeakHeap();
+/**
+ * @brief peak resident set size of the process in kilobytes, 0 where
+ * unknown
+ */
+long peakResidentKb();
+
+#endif  // ALLOCATIONS_H
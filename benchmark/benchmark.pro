@@ -0,0 +1,18 @@
+CONFIG += c++17 console
+CONFIG -= qt
+CONFIG -= app_bundle
+
+TARGET = voronoi_benchmark
+
+include(../core/core.pri)
+
+SOURCES += \
+	allocations.cpp \
+	main.cpp \
+	sites.cpp \
+	suite.cpp
+
+HEADERS += \
+	allocations.h \
+	sites.h \
+	suite.h
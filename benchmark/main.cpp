@@ -0,0 +1,557 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <string>
+#include <thread>
+
+#include "sites.h"
+#include "suite.h"
+#include "allocations.h"
+#include "voronoi/cellarrays.h"
+#include "voronoi/lloydrelaxation.h"
+#include "voronoi/pointlocator.h"
+#include "voronoi/stripsweep.h"
+#include "voronoi/sweepline.h"
+
+namespace
+{
+double timeFortune(int n, const SiteGenerator& gen)
+{
+    std::mt19937 rng(n);
+    auto vmap = std::make_shared<Voronoi>(mapSize, mapSize);
+    gen(*vmap, n, rng);
+
+    auto start = std::chrono::steady_clock::now();
+    SweepLine sl(vmap);
+    sl.performFortune();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void runGrowth(const char* name, const SiteGenerator& gen, int maxN)
+{
+    std::printf("%-10s %10s %12s %16s %8s\n", name, "sites", "ms",
+                "ns/(n log2 n)", "growth");
+    double prev = 0;
+    for (int n = 1000; n <= maxN; n *= 2) {
+        double ms = timeFortune(n, gen);
+        double perNLogN = ms * 1e6 / (n * std::log2((double) n));
+        std::printf("%-10s %10d %12.2f %16.2f", "", n, ms, perNLogN);
+        if (prev > 0)
+            std::printf(" %8.2f", ms / prev);
+        std::printf("\n");
+        prev = ms;
+    }
+    std::printf("\n");
+}
+
+void runThreads(const char* name, const SiteGenerator& gen, int n)
+{
+    std::printf("%-10s %10s %12s %12s\n", name, "threads", "ms", "speedup");
+    double single = 0;
+    const unsigned maxThreads =
+        std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        std::mt19937 rng(n);
+        auto vmap = std::make_shared<Voronoi>(mapSize, mapSize);
+        gen(*vmap, n, rng);
+
+        auto start = std::chrono::steady_clock::now();
+        StripSweep(vmap).performFortune(threads);
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start)
+                        .count();
+        if (threads == 1)
+            single = ms;
+        std::printf("%-10s %10u %12.2f %11.2fx\n", "", threads, ms,
+                    single / ms);
+    }
+    std::printf("\n");
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/**
+ * @brief k nearest polygons of point by scanning every polygon
+ */
+void bruteNearest(const Voronoi& vmap,
+                  const PointF& point,
+                  size_t k,
+                  std::vector<uint32_t>& cells)
+{
+    std::priority_queue<std::pair<double, uint32_t>> best;
+    for (size_t i = 0; i < vmap.polygons.size(); ++i) {
+        double d = PointF(vmap.polygons[i]->focus).distance(point);
+        if (best.size() < k) {
+            best.emplace(d, (uint32_t) i);
+        } else if (d < best.top().first) {
+            best.pop();
+            best.emplace(d, (uint32_t) i);
+        }
+    }
+    cells.resize(best.size());
+    for (size_t i = best.size(); i-- > 0; best.pop())
+        cells[i] = best.top().second;
+}
+
+void bruteWithin(const Voronoi& vmap,
+                 const PointF& point,
+                 double radius,
+                 std::vector<uint32_t>& cells)
+{
+    cells.clear();
+    for (size_t i = 0; i < vmap.polygons.size(); ++i) {
+        if (PointF(vmap.polygons[i]->focus).distance(point) <= radius)
+            cells.push_back((uint32_t) i);
+    }
+}
+
+void runQueries(int n)
+{
+    const size_t k = 8;
+    const int queries = 1 << 20;
+    const int bruteQueries = std::max(16, (int) (2e8 / n) >> 4 << 4);
+    std::mt19937 rng(n);
+    auto vmap = std::make_shared<Voronoi>(mapSize, mapSize);
+    uniformSites(*vmap, n, rng);
+    SweepLine sl(vmap);
+    sl.performFortune();
+
+    auto start = std::chrono::steady_clock::now();
+    PointLocator locator(*vmap);
+    double buildMs = secondsSince(start) * 1e3;
+
+    std::uniform_real_distribution<double> coord(0, mapSize);
+    std::vector<PointF> points(queries);
+    for (auto& p : points)
+        p = PointF(coord(rng), coord(rng));
+    // radius with about 2k sites in range on average
+    const double radius = std::sqrt(2.0 * k * mapSize * mapSize / (M_PI * n));
+
+    std::printf("queries on %d uniform sites, locator built in %.2f ms\n", n,
+                buildMs);
+    std::printf("%-16s %14s %14s %14s %10s\n", "", "1 thread q/s",
+                "all threads q/s", "brute q/s", "speedup");
+
+    std::vector<uint32_t> cells((size_t) queries * k), offsets, found;
+    auto report = [&](const char* name, auto one, auto batch, auto brute) {
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < queries; ++i)
+            one(points[i]);
+        double single = queries / secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        batch();
+        double threaded = queries / secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < bruteQueries; ++i)
+            brute(points[i]);
+        double scan = bruteQueries / secondsSince(start);
+        std::printf("%-16s %14.0f %14.0f %14.0f %9.0fx\n", name, single,
+                    threaded, scan, single / scan);
+    };
+    report(
+        "locate",
+        [&](const PointF& p) { cells[0] = locator.locate(p); },
+        [&] { locator.locate(points.data(), queries, cells.data()); },
+        [&](const PointF& p) { bruteNearest(*vmap, p, 1, found); });
+    report(
+        "nearest k=8",
+        [&](const PointF& p) { locator.nearest(p, k, found); },
+        [&] { locator.nearest(points.data(), queries, k, cells.data()); },
+        [&](const PointF& p) { bruteNearest(*vmap, p, k, found); });
+    report(
+        "within ~16",
+        [&](const PointF& p) { locator.within(p, radius, found); },
+        [&] {
+            locator.within(points.data(), queries, radius, offsets, found);
+        },
+        [&](const PointF& p) { bruteWithin(*vmap, p, radius, found); });
+    std::printf("\n");
+}
+
+// keeps the polygon walk from being optimized away
+volatile double metricsSink;
+
+/**
+ * @brief area, centroid, perimeter and bounds of every polygon, walking its
+ * edges like code before CellArrays did
+ */
+double polygonMetrics(const Voronoi& vmap)
+{
+    double checksum = 0;
+    for (const auto& poly : vmap.polygons) {
+        double twiceArea = 0, sumX = 0, sumY = 0, length = 0;
+        double left = poly->focus.x, right = left;
+        double top = poly->focus.y, bottom = top;
+        for (const auto& edge : poly->edges) {
+            if (!edge->a || !edge->b)
+                continue;
+            const PointF a(*edge->a), b(*edge->b);
+            const double cross = a.x * b.y - b.x * a.y;
+            twiceArea += cross;
+            sumX += (a.x + b.x) * cross;
+            sumY += (a.y + b.y) * cross;
+            length += a.distance(b);
+            left = std::min(left, a.x);
+            right = std::max(right, a.x);
+            top = std::min(top, a.y);
+            bottom = std::max(bottom, a.y);
+        }
+        checksum += twiceArea + length + right - left + bottom - top;
+        if (twiceArea != 0)
+            checksum += (sumX + sumY) / (3 * twiceArea);
+    }
+    return checksum;
+}
+
+void runCells(int n)
+{
+    std::mt19937 rng(n);
+    auto vmap = std::make_shared<Voronoi>(mapSize, mapSize);
+    uniformSites(*vmap, n, rng);
+    SweepLine sl(vmap);
+    sl.performFortune();
+
+    const int repeats = std::max(3, (int) (1e6 / n));
+    CellArrays cells;
+    double buildMs = 1e300, metricsMs = 1e300, walkMs = 1e300;
+    for (int i = 0; i < repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        cells.build(*vmap);
+        buildMs = std::min(buildMs, secondsSince(start) * 1e3);
+        start = std::chrono::steady_clock::now();
+        cells.computeMetrics();
+        metricsMs = std::min(metricsMs, secondsSince(start) * 1e3);
+        start = std::chrono::steady_clock::now();
+        metricsSink = polygonMetrics(*vmap);
+        walkMs = std::min(walkMs, secondsSince(start) * 1e3);
+    }
+    std::printf("%-10s %10d %12.2f %12.2f %12.2f %9.1fx\n", "", n, buildMs,
+                metricsMs, walkMs, walkMs / metricsMs);
+}
+
+void runLloyd(int n, unsigned threads)
+{
+    const int iterations = 20;
+    std::mt19937 rng(n);
+    auto vmap = std::make_shared<Voronoi>(mapSize, mapSize);
+    uniformSites(*vmap, n, rng);
+    LloydRelaxation lloyd(vmap);
+    lloyd.threads = threads;
+
+    // the first step sweeps twice and sizes all storage
+    auto start = std::chrono::steady_clock::now();
+    lloyd.step();
+    const double firstMs = secondsSince(start) * 1e3;
+    const AllocationCount before = allocationCount();
+    start = std::chrono::steady_clock::now();
+    double moved = 0;
+    for (int i = 1; i < iterations; ++i)
+        moved = lloyd.step();
+    const double stepMs = secondsSince(start) * 1e3 / (iterations - 1);
+    const AllocationCount allocations = allocationCount() - before;
+    std::printf("%-10s %10d %8u %12.2f %12.2f %10.1f %10.1f %10.1f\n", "", n,
+                threads, firstMs, stepMs, 1e3 / stepMs,
+                (double) allocations.allocations / (iterations - 1), moved);
+}
+
+/**
+ * @brief peak heap of a sweep on top of its input, clipping the whole
+ * diagram into the dcel, or streaming every cell as it's finished
+ */
+void runStream(const char* name, const SiteGenerator& gen, int n)
+{
+    std::mt19937 rng(n);
+    auto vmap = std::make_shared<Voronoi>(mapSize, mapSize);
+    gen(*vmap, n, rng);
+    const Rectangle bounds(0, 0, mapSize, mapSize);
+    double ms[2], peakMb[2];
+    size_t cells = 0;
+    for (int stream = 0; stream < 2; ++stream) {
+        vmap->dcel = Dcel();
+        const size_t input = liveHeapBytes();
+        resetPeakHeap();
+        auto start = std::chrono::steady_clock::now();
+        {
+            SweepLine sl(vmap);
+            if (stream) {
+                size_t vertices = 0;
+                sl.streamFortune(bounds, [&](const auto& cell) {
+                    ++cells;
+                    vertices += cell.vertices.size();
+                });
+                metricsSink = vertices;
+            } else {
+                while (sl.nextEvent() != sl.LMAXVALUE)
+                    ;
+                sl.finishEdges(bounds);
+            }
+        }
+        ms[stream] = secondsSince(start) * 1e3;
+        peakMb[stream] = (peakHeapBytes() - input) / 1e6;
+    }
+    std::printf("%-10s %10d %12.2f %12.2f %12.2f %12.2f %10zu\n", name, n,
+                ms[0], peakMb[0], ms[1], peakMb[1], cells);
+}
+
+/**
+ * @brief time and peak heap of a full sweep building what Output asks for
+ */
+template <class Output>
+void runOutput(const char* name,
+               const SiteGenerator& gen,
+               int n,
+               const char* output)
+{
+    std::mt19937 rng(n);
+    auto vmap = std::make_shared<Voronoi>(mapSize, mapSize);
+    gen(*vmap, n, rng);
+    const size_t input = liveHeapBytes();
+    resetPeakHeap();
+    auto start = std::chrono::steady_clock::now();
+    {
+        BasicSweepLine<int, double, Output> sl(vmap);
+        sl.performFortune();
+    }
+    const double ms = secondsSince(start) * 1e3;
+    const double peakMb = (peakHeapBytes() - input) / 1e6;
+    std::printf("%-10s %10d %-12s %12.2f %12.2f\n", name, n, output, ms,
+                peakMb);
+}
+
+void runOutputs(const char* name, const SiteGenerator& gen, int n)
+{
+    runOutput<PolygonOutput>(name, gen, n, "polygons");
+    runOutput<CellOutput>(name, gen, n, "cells");
+    runOutput<EdgeOutput>(name, gen, n, "edges");
+    runOutput<AdjacencyOutput>(name, gen, n, "adjacency");
+    runOutput<DelaunayOutput>(name, gen, n, "delaunay");
+}
+
+struct Options {
+    int maxN = 1000000;
+    int repeats = 3;
+    std::vector<const Distribution*> distributions;
+    std::string json;
+    std::string baseline;
+    double tolerance = 0.1;
+    bool growth = false;
+    bool threads = false;
+    bool queries = false;
+    bool cells = false;
+    bool lloyd = false;
+    bool stream = false;
+    bool outputs = false;
+};
+
+void usage()
+{
+    std::fprintf(
+        stderr,
+        "usage: voronoi_benchmark [options] [max sites]\n"
+        "  --max N            largest suite size, sizes are powers of ten\n"
+        "                     from 1000 (default 1000000)\n"
+        "  --distributions L  comma separated subset of uniform, gaussian,\n"
+        "                     lattice, collinear and cocircular\n"
+        "  --repeat R         keep the fastest of up to R runs (default 3)\n"
+        "  --json FILE        write the suite's results as JSON\n"
+        "  --baseline FILE    compare with results written by --json on this\n"
+        "                     machine, exit with 1 if any case regressed\n"
+        "  --tolerance T      fraction a case may be slower, allocate more\n"
+        "                     or use more memory than its baseline (0.1)\n"
+        "  --growth           also time doubling sizes up to max sites\n"
+        "  --threads          also time the strip sweep of max sites on 1,\n"
+        "                     2, 4 ... threads\n"
+        "  --queries          also time locator queries\n"
+        "  --cells            also time the cell arrays export and metrics\n"
+        "                     against walking every polygon's edges\n"
+        "  --lloyd            also time Lloyd relaxation steps on 1 and all\n"
+        "                     threads\n"
+        "  --stream           also compare the peak heap of clipping a whole\n"
+        "                     diagram with streaming its cells\n"
+        "  --outputs          also time full sweeps building only the\n"
+        "                     polygons, cells, edges, adjacency or\n"
+        "                     triangulation\n");
+}
+
+bool selectDistributions(const std::string& list, Options& options)
+{
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t end = std::min(list.find(',', begin), list.size());
+        const std::string name = list.substr(begin, end - begin);
+        const Distribution* found = nullptr;
+        for (const Distribution& distribution : distributions) {
+            if (name == distribution.name)
+                found = &distribution;
+        }
+        if (!found)
+            return false;
+        options.distributions.push_back(found);
+        begin = end + 1;
+    }
+    return true;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--growth") == 0) {
+            options.growth = true;
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            options.threads = true;
+        } else if (std::strcmp(arg, "--queries") == 0) {
+            options.queries = true;
+        } else if (std::strcmp(arg, "--cells") == 0) {
+            options.cells = true;
+        } else if (std::strcmp(arg, "--lloyd") == 0) {
+            options.lloyd = true;
+        } else if (std::strcmp(arg, "--stream") == 0) {
+            options.stream = true;
+        } else if (std::strcmp(arg, "--outputs") == 0) {
+            options.outputs = true;
+        } else if (arg[0] != '-') {
+            options.maxN = (int) std::atof(arg);
+        } else if (i + 1 == argc) {
+            return false;
+        } else if (std::strcmp(arg, "--max") == 0) {
+            options.maxN = (int) std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--repeat") == 0) {
+            options.repeats = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--distributions") == 0) {
+            if (!selectDistributions(argv[++i], options))
+                return false;
+        } else if (std::strcmp(arg, "--json") == 0) {
+            options.json = argv[++i];
+        } else if (std::strcmp(arg, "--baseline") == 0) {
+            options.baseline = argv[++i];
+        } else if (std::strcmp(arg, "--tolerance") == 0) {
+            options.tolerance = std::atof(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    if (options.distributions.empty()) {
+        for (const Distribution& distribution : distributions)
+            options.distributions.push_back(&distribution);
+    }
+    return options.maxN > 0;
+}
+}  // namespace
+
+/**
+ * Times the phases of a sweep, loading, the event loop, finishing edges and
+ * syncing polygons, for every site distribution at sizes from 1000 up to max
+ * sites, with their allocations and peak heap. Results can be written as
+ * JSON and compared with an earlier run's.
+ *
+ * Optionally times full sweeps for doubling sizes, where for an n log n
+ * sweep the growth column stays slightly above 2 and a quadratic one
+ * approaches 4, the strip sweep on 1, 2, 4 ... threads, and locator queries
+ * against scanning every polygon, the cell arrays export against walking
+ * every polygon's edges, Lloyd relaxation steps, the peak heap of
+ * streaming cells against keeping the whole diagram, and sweeps that build
+ * only part of the diagram.
+ */
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    std::vector<SuiteResult> results;
+    printSuiteHeader();
+    for (const Distribution* distribution : options.distributions) {
+        for (int n = 1000; n <= options.maxN; n *= 10) {
+            results.push_back(
+                runSuiteCase(*distribution, n, options.repeats));
+            printSuiteResult(results.back());
+            std::fflush(stdout);
+        }
+    }
+    std::printf("\n");
+
+    int regressions = 0;
+    if (!options.baseline.empty()) {
+        std::vector<SuiteResult> baseline;
+        if (!readSuiteJson(options.baseline, baseline)) {
+            std::fprintf(stderr, "can't read %s\n", options.baseline.c_str());
+            return 2;
+        }
+        regressions = compareSuite(results, baseline, options.tolerance);
+        std::printf("%d regressed beyond %.0f%%\n\n", regressions,
+                    options.tolerance * 100);
+    }
+    if (!options.json.empty()) {
+        std::FILE* file = std::fopen(options.json.c_str(), "w");
+        if (!file) {
+            std::fprintf(stderr, "can't write %s\n", options.json.c_str());
+            return 2;
+        }
+        writeSuiteJson(file, results);
+        std::fclose(file);
+    }
+
+    if (options.growth) {
+        runGrowth("uniform", uniformSites, options.maxN);
+        runGrowth("gaussian", clusteredSites, options.maxN);
+    }
+    if (options.threads) {
+        runThreads("uniform", uniformSites, options.maxN);
+        runThreads("gaussian", clusteredSites, options.maxN);
+    }
+    if (options.queries) {
+        for (int n = 10000; n <= options.maxN; n *= 10)
+            runQueries(n);
+    }
+    if (options.cells) {
+        std::printf("%-10s %10s %12s %12s %12s %10s\n", "cells", "sites",
+                    "build ms", "metrics ms", "walk ms", "speedup");
+        for (int n = 10000; n <= options.maxN; n *= 10)
+            runCells(n);
+        std::printf("\n");
+    }
+    if (options.lloyd) {
+        std::printf("%-10s %10s %8s %12s %12s %10s %10s %10s\n", "lloyd",
+                    "sites", "threads", "first ms", "step ms", "steps/s",
+                    "allocs", "moved");
+        const unsigned maxThreads =
+            std::max(1u, std::thread::hardware_concurrency());
+        for (int n = 10000; n <= options.maxN; n *= 10) {
+            runLloyd(n, 1);
+            if (maxThreads > 1)
+                runLloyd(n, maxThreads);
+        }
+        std::printf("\n");
+    }
+    if (options.stream) {
+        std::printf("%-10s %10s %12s %12s %12s %12s %10s\n", "stream",
+                    "sites", "clip ms", "clip MB", "stream ms", "stream MB",
+                    "cells");
+        for (int n = 10000; n <= options.maxN; n *= 10) {
+            runStream("uniform", uniformSites, n);
+            runStream("gaussian", clusteredSites, n);
+        }
+        std::printf("\n");
+    }
+    if (options.outputs) {
+        std::printf("%-10s %10s %-12s %12s %12s\n", "outputs", "sites",
+                    "output", "ms", "MB");
+        for (int n = 10000; n <= options.maxN; n *= 10) {
+            runOutputs("uniform", uniformSites, n);
+            runOutputs("gaussian", clusteredSites, n);
+        }
+        std::printf("\n");
+    }
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+#include "sites.h"
+
+#include <algorithm>
+#include <cmath>
+
+void uniformSites(Voronoi& vmap, int n, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> dist(0, mapSize - 1);
+    for (int i = 0; i < n; ++i) {
+        int x = dist(rng);
+        int y = dist(rng);
+        vmap.addPoly(Polygon(Point(x, y)));
+    }
+}
+
+void clusteredSites(Voronoi& vmap, int n, std::mt19937& rng)
+{
+    const int clusters = 16;
+    std::uniform_real_distribution<double> center(mapSize * 0.1,
+                                                  mapSize * 0.9);
+    std::vector<std::pair<double, double>> centers(clusters);
+    for (auto& c : centers)
+        c = {center(rng), center(rng)};
+    std::normal_distribution<double> spread(0, mapSize / 64.0);
+    std::uniform_int_distribution<int> pick(0, clusters - 1);
+    for (int i = 0; i < n; ++i) {
+        const auto& c = centers[pick(rng)];
+        int x = std::clamp((int) (c.first + spread(rng)), 0, mapSize - 1);
+        int y = std::clamp((int) (c.second + spread(rng)), 0, mapSize - 1);
+        vmap.addPoly(Polygon(Point(x, y)));
+    }
+}
+
+void latticeSites(Voronoi& vmap, int n, std::mt19937&)
+{
+    const int side = (int) std::ceil(std::sqrt((double) n));
+    const int spacing = std::max(1, mapSize / side);
+    for (int i = 0; i < n; ++i)
+        vmap.addPoly(Polygon(Point(i / side * spacing, i % side * spacing)));
+}
+
+void collinearSites(Voronoi& vmap, int n, std::mt19937& rng)
+{
+    // shuffled, so the sites aren't handed over in sweep order
+    std::vector<int> xs(n);
+    for (int i = 0; i < n; ++i)
+        xs[i] = (int) ((int64_t) i * mapSize / n);
+    std::shuffle(xs.begin(), xs.end(), rng);
+    for (int x : xs)
+        vmap.addPoly(Polygon(Point(x, x / 2)));
+}
+
+void cocircularSites(Voronoi& vmap, int n, std::mt19937& rng)
+{
+    // rings about as far apart as neighbouring sites on a ring
+    const int rings = std::max(1, (int) std::sqrt(n / (2 * M_PI)));
+    const double center = mapSize / 2.0;
+    std::uniform_real_distribution<double> phase(0, 2 * M_PI);
+    int placed = 0;
+    for (int ring = 1; ring <= rings; ++ring) {
+        // sites so far in proportion to the total length of the rings
+        const int until =
+            (int) ((int64_t) n * ring * (ring + 1) / (rings * (rings + 1)));
+        const double radius = (mapSize / 2.0 - 1) * ring / rings;
+        const double start = phase(rng);
+        const int count = until - placed;
+        for (int i = 0; i < count; ++i) {
+            double angle = start + 2 * M_PI * i / count;
+            int x = (int) (center + radius * std::cos(angle));
+            int y = (int) (center + radius * std::sin(angle));
+            vmap.addPoly(Polygon(Point(x, y)));
+        }
+        placed = until;
+    }
+}
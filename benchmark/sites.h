@@ -0,0 +1,50 @@
+#ifndef SITES_H
+#define SITES_H
+
+#include <functional>
+#include <random>
+
+#include "voronoi/voronoi.h"
+
+// benchmark maps are mapSize by mapSize
+const int mapSize = 1 << 20;
+
+/**
+ * @brief adds n sites drawn with rng to a map
+ */
+using SiteGenerator = std::function<void(Voronoi&, int, std::mt19937&)>;
+
+void uniformSites(Voronoi& vmap, int n, std::mt19937& rng);
+/**
+ * @brief a few dense gaussian blobs, which makes the beach line long and deep
+ */
+void clusteredSites(Voronoi& vmap, int n, std::mt19937& rng);
+/**
+ * @brief square grid, every four neighbouring sites are cocircular
+ */
+void latticeSites(Voronoi& vmap, int n, std::mt19937& rng);
+/**
+ * @brief sites on a single line, the diagram is parallel strips without any
+ * circle event
+ */
+void collinearSites(Voronoi& vmap, int n, std::mt19937& rng);
+/**
+ * @brief concentric rings of sites rounded to integers, so that circle
+ * events nearly coincide
+ */
+void cocircularSites(Voronoi& vmap, int n, std::mt19937& rng);
+
+struct Distribution {
+    const char* name;
+    SiteGenerator generate;
+};
+
+const Distribution distributions[] = {
+    {"uniform", uniformSites},
+    {"gaussian", clusteredSites},
+    {"lattice", latticeSites},
+    {"collinear", collinearSites},
+    {"cocircular", cocircularSites},
+};
+
+#endif  // SITES_H
@@ -0,0 +1,229 @@
+#include "suite.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+
+#include "allocations.h"
+#include "voronoi/sweepline.h"
+
+const char* const phaseNames[phaseCount] = {"load", "events", "finish",
+                                            "sync"};
+
+namespace
+{
+const double megabyte = 1024.0 * 1024.0;
+
+/**
+ * @brief find "key": in a line of JSON and parse the number after it
+ */
+bool jsonNumber(const std::string& line, const std::string& key, double& value)
+{
+    size_t at = line.find('"' + key + "\":");
+    if (at == std::string::npos)
+        return false;
+    const char* begin = line.c_str() + at + key.size() + 3;
+    char* end;
+    value = std::strtod(begin, &end);
+    return end != begin;
+}
+
+bool jsonString(const std::string& line,
+                const std::string& key,
+                std::string& value)
+{
+    size_t at = line.find('"' + key + "\": \"");
+    if (at == std::string::npos)
+        return false;
+    at += key.size() + 5;
+    size_t end = line.find('"', at);
+    if (end == std::string::npos)
+        return false;
+    value = line.substr(at, end - at);
+    return true;
+}
+}  // namespace
+
+double SuiteResult::totalMs() const
+{
+    double total = 0;
+    for (double phaseMs : ms)
+        total += phaseMs;
+    return total;
+}
+
+double SuiteResult::nsPerSite() const
+{
+    return totalMs() * 1e6 / sites;
+}
+
+uint64_t SuiteResult::totalAllocations() const
+{
+    uint64_t total = 0;
+    for (uint64_t count : allocations)
+        total += count;
+    return total;
+}
+
+SuiteResult runSuiteCase(const Distribution& distribution, int n, int repeats)
+{
+    using Clock = std::chrono::steady_clock;
+    SuiteResult best;
+    const auto caseStart = Clock::now();
+    for (int run = 0; run < repeats; ++run) {
+        if (run > 0 && Clock::now() - caseStart > std::chrono::seconds(2))
+            break;
+        SuiteResult result;
+        result.distribution = distribution.name;
+        result.sites = n;
+
+        resetPeakHeap();
+        std::mt19937 rng(n);
+        auto vmap = std::make_shared<Voronoi>(mapSize, mapSize);
+        distribution.generate(*vmap, n, rng);
+        SweepLine sweepLine;
+
+        const AllocationCount start = allocationCount();
+        AllocationCount phaseAllocations = start;
+        auto phaseStart = Clock::now();
+        auto endPhase = [&](Phase phase) {
+            auto now = Clock::now();
+            AllocationCount allocations = allocationCount();
+            result.ms[phase] =
+                std::chrono::duration<double, std::milli>(now - phaseStart)
+                    .count();
+            result.allocations[phase] =
+                (allocations - phaseAllocations).allocations;
+            phaseStart = now;
+            phaseAllocations = allocations;
+        };
+        sweepLine.loadVmap(vmap);
+        endPhase(loadPhase);
+        while (sweepLine.nextEvent() != sweepLine.LMAXVALUE)
+            ;
+        endPhase(eventsPhase);
+        sweepLine.finishEdges(Rectangle(0, 0, mapSize, mapSize));
+        endPhase(finishPhase);
+        vmap->syncPolygons();
+        endPhase(syncPhase);
+
+        result.allocatedBytes = (allocationCount() - start).bytes;
+        result.peakHeapBytes = peakHeapBytes();
+        if (run == 0 || result.totalMs() < best.totalMs())
+            best = result;
+    }
+    return best;
+}
+
+void printSuiteHeader()
+{
+    std::printf("%-11s %9s", "", "sites");
+    for (const char* name : phaseNames)
+        std::printf(" %9s", name);
+    std::printf(" %9s %10s %10s %9s\n", "ns/site", "allocs", "alloc MB",
+                "peak MB");
+}
+
+void printSuiteResult(const SuiteResult& result)
+{
+    std::printf("%-11s %9d", result.distribution.c_str(), result.sites);
+    for (double ms : result.ms)
+        std::printf(" %9.2f", ms);
+    std::printf(" %9.1f %10llu %10.1f %9.1f\n", result.nsPerSite(),
+                (unsigned long long) result.totalAllocations(),
+                result.allocatedBytes / megabyte,
+                result.peakHeapBytes / megabyte);
+}
+
+void writeSuiteJson(std::FILE* file, const std::vector<SuiteResult>& results)
+{
+    std::fprintf(file, "{\n\"version\": 1,\n\"peak_rss_kb\": %ld,\n",
+                 peakResidentKb());
+    std::fprintf(file, "\"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const SuiteResult& result = results[i];
+        std::fprintf(file, "{\"distribution\": \"%s\", \"sites\": %d",
+                     result.distribution.c_str(), result.sites);
+        for (int phase = 0; phase < phaseCount; ++phase) {
+            std::fprintf(file, ", \"%s_ms\": %.4f, \"%s_allocations\": %llu",
+                         phaseNames[phase], result.ms[phase],
+                         phaseNames[phase],
+                         (unsigned long long) result.allocations[phase]);
+        }
+        std::fprintf(file,
+                     ", \"ns_per_site\": %.2f, \"allocated_bytes\": %llu, "
+                     "\"peak_heap_bytes\": %llu}%s\n",
+                     result.nsPerSite(),
+                     (unsigned long long) result.allocatedBytes,
+                     (unsigned long long) result.peakHeapBytes,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "]\n}\n");
+}
+
+bool readSuiteJson(const std::string& path, std::vector<SuiteResult>& results)
+{
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    for (std::string line; std::getline(in, line);) {
+        SuiteResult result;
+        double sites, allocatedBytes, peakHeapBytes;
+        if (!jsonString(line, "distribution", result.distribution) ||
+            !jsonNumber(line, "sites", sites) ||
+            !jsonNumber(line, "allocated_bytes", allocatedBytes) ||
+            !jsonNumber(line, "peak_heap_bytes", peakHeapBytes))
+            continue;
+        result.sites = (int) sites;
+        result.allocatedBytes = (uint64_t) allocatedBytes;
+        result.peakHeapBytes = (uint64_t) peakHeapBytes;
+        for (int phase = 0; phase < phaseCount; ++phase) {
+            const std::string name = phaseNames[phase];
+            double allocations = 0;
+            jsonNumber(line, name + "_ms", result.ms[phase]);
+            jsonNumber(line, name + "_allocations", allocations);
+            result.allocations[phase] = (uint64_t) allocations;
+        }
+        results.push_back(result);
+    }
+    return true;
+}
+
+int compareSuite(const std::vector<SuiteResult>& results,
+                 const std::vector<SuiteResult>& baseline,
+                 double tolerance)
+{
+    std::printf("%-11s %9s %12s %12s %9s %9s %9s\n", "", "sites",
+                "base ns/site", "ns/site", "time", "allocs", "peak");
+    int regressions = 0;
+    for (const SuiteResult& result : results) {
+        const SuiteResult* base = nullptr;
+        for (const SuiteResult& candidate : baseline) {
+            if (candidate.distribution == result.distribution &&
+                candidate.sites == result.sites)
+                base = &candidate;
+        }
+        if (!base) {
+            std::printf("%-11s %9d %12s\n", result.distribution.c_str(),
+                        result.sites, "-");
+            continue;
+        }
+        // ratios of current to baseline, above 1 is worse
+        const double ratios[3] = {
+            result.totalMs() / base->totalMs(),
+            (double) result.totalAllocations() /
+                std::max<uint64_t>(base->totalAllocations(), 1),
+            (double) result.peakHeapBytes /
+                std::max<uint64_t>(base->peakHeapBytes, 1)};
+        bool regressed = false;
+        for (double ratio : ratios)
+            regressed = regressed || ratio > 1 + tolerance;
+        regressions += regressed;
+        std::printf("%-11s %9d %12.1f %12.1f %8.2fx %8.2fx %8.2fx%s\n",
+                    result.distribution.c_str(), result.sites,
+                    base->nsPerSite(), result.nsPerSite(), ratios[0],
+                    ratios[1], ratios[2], regressed ? "  regressed" : "");
+    }
+    return regressions;
+}
@@ -0,0 +1,62 @@
+#ifndef SUITE_H
+#define SUITE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "sites.h"
+
+/**
+ * The suite times the phases of a full sweep one by one for every site
+ * distribution and size, and counts their heap allocations.
+ */
+enum Phase { loadPhase, eventsPhase, finishPhase, syncPhase, phaseCount };
+extern const char* const phaseNames[phaseCount];
+
+struct SuiteResult {
+    std::string distribution;
+    int sites = 0;
+    // SweepLine::loadVmap, the nextEvent loop, finishEdges and
+    // Voronoi::syncPolygons
+    double ms[phaseCount] = {};
+    uint64_t allocations[phaseCount] = {};
+    uint64_t allocatedBytes = 0;
+    // most heap in use at once, including the input polygons
+    uint64_t peakHeapBytes = 0;
+
+    double totalMs() const;
+    double nsPerSite() const;
+    uint64_t totalAllocations() const;
+};
+
+/**
+ * @brief sweep n sites of distribution, up to repeats times while it takes
+ * less than a couple of seconds, and keep the fastest run
+ */
+SuiteResult runSuiteCase(const Distribution& distribution, int n, int repeats);
+
+void printSuiteHeader();
+void printSuiteResult(const SuiteResult& result);
+
+/**
+ * @brief write results as JSON, one result object per line
+ */
+void writeSuiteJson(std::FILE* file, const std::vector<SuiteResult>& results);
+/**
+ * @brief read results written by writeSuiteJson
+ */
+bool readSuiteJson(const std::string& path, std::vector<SuiteResult>& results);
+
+/**
+ * @brief print how results compare to baseline, case by case
+ * @param tolerance fraction of time, allocations or peak heap a case may
+ * exceed its baseline by
+ * @return number of cases beyond tolerance
+ */
+int compareSuite(const std::vector<SuiteResult>& results,
+                 const std::vector<SuiteResult>& baseline,
+                 double tolerance);
+
+#endif  // SUITE_H
@@ -0,0 +1,16 @@
+CONFIG += c++17 console
+CONFIG -= qt
+CONFIG -= app_bundle
+
+TARGET = voronoi_cli
+
+include(../core/core.pri)
+
+SOURCES += \
+	diagramwriter.cpp \
+	main.cpp \
+	sitefile.cpp
+
+HEADERS += \
+	diagramwriter.h \
+	sitefile.h
@@ -0,0 +1,85 @@
+#include "diagramwriter.h"
+
+#include <charconv>
+
+namespace
+{
+template <class T>
+void append(std::string& out, T value, char separator = ' ')
+{
+    char buffer[32];
+    char* end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+    *end++ = separator;
+    out.append(buffer, end);
+}
+
+void append(std::string& out, const PointF& point, char separator = ' ')
+{
+    append(out, point.x);
+    append(out, point.y, separator);
+}
+}  // namespace
+
+void writeCells(const Voronoi& vmap, std::string& out)
+{
+    const Dcel& dcel = vmap.dcel;
+    std::vector<Dcel::index> polygonFaces(vmap.polygons.size(), Dcel::npos);
+    for (Dcel::index f = 0; f < dcel.faces.size(); ++f) {
+        if (!dcel.removed(dcel.faces[f]))
+            polygonFaces[dcel.faces[f].polygon] = f;
+    }
+
+    // vertices of the current cell, its count has to come first
+    std::string vertices;
+    for (size_t i = 0; i < vmap.polygons.size(); ++i) {
+        const Point& focus = vmap.polygons[i]->focus;
+        append(out, focus.x);
+        append(out, focus.y);
+        const Dcel::index face = polygonFaces[i];
+        const Dcel::index start =
+            face == Dcel::npos ? Dcel::npos : dcel.faces[face].halfEdge;
+        size_t count = 0;
+        vertices.clear();
+        if (start != Dcel::npos) {
+            Dcel::index h = start;
+            do {
+                append(vertices, dcel.vertices[dcel.origin(h)]);
+                ++count;
+                h = dcel.halfEdges[h].next;
+            } while (h != start);
+        }
+        append(out, count, count ? ' ' : '\n');
+        if (count) {
+            vertices.back() = '\n';
+            out += vertices;
+        }
+    }
+}
+
+void writeEdges(const Voronoi& vmap, std::string& out)
+{
+    const Dcel& dcel = vmap.dcel;
+    for (Dcel::index h = 0; h < dcel.halfEdges.size(); ++h) {
+        const Dcel::HalfEdge& halfEdge = dcel.halfEdges[h];
+        // every edge once, skipping those entirely outside the bounds
+        if (halfEdge.twin == Dcel::npos || halfEdge.twin < h ||
+            dcel.removed(halfEdge) || halfEdge.origin == Dcel::npos)
+            continue;
+        const Dcel::HalfEdge& twin = dcel.halfEdges[halfEdge.twin];
+        append(out, dcel.vertices[halfEdge.origin]);
+        append(out, dcel.vertices[twin.origin]);
+        append(out, dcel.faces[halfEdge.face].polygon);
+        append(out, dcel.faces[twin.face].polygon, '\n');
+    }
+}
+
+void writeCell(const SweepLine::FinishedCell& cell, std::string& out)
+{
+    append(out, cell.polygon);
+    append(out, cell.site.x);
+    append(out, cell.site.y);
+    const size_t count = cell.vertices.size();
+    append(out, count, count ? ' ' : '\n');
+    for (size_t i = 0; i < count; ++i)
+        append(out, cell.vertices[i], i + 1 < count ? ' ' : '\n');
+}
@@ -0,0 +1,31 @@
+#ifndef DIAGRAMWRITER_H
+#define DIAGRAMWRITER_H
+
+#include <string>
+
+#include "voronoi/sweepline.h"
+#include "voronoi/voronoi.h"
+
+/**
+ * @brief append the cells of vmap's clipped dcel to out as text
+ * one line per polygon, in the order of vmap.polygons: the focus, the number
+ * of vertices and the vertices counter-clockwise, all separated by blanks.
+ * Polygons without a cell, like those duplicating an earlier site, have no
+ * vertices
+ */
+void writeCells(const Voronoi& vmap, std::string& out);
+/**
+ * @brief append every edge of vmap's clipped dcel to out as text
+ * one line per edge between two cells, the border of the clip bounds is left
+ * out: both endpoints and the indices into vmap.polygons of the cells on its
+ * left and right
+ */
+void writeEdges(const Voronoi& vmap, std::string& out);
+/**
+ * @brief append a cell streamed by SweepLine::streamFortune to out as text
+ * one line like those of writeCells, preceded by the index of the cell's
+ * polygon in vmap.polygons, as cells are streamed in the order they finish
+ */
+void writeCell(const SweepLine::FinishedCell& cell, std::string& out);
+
+#endif  // DIAGRAMWRITER_H
@@ -0,0 +1,455 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "diagramwriter.h"
+#include "sitefile.h"
+#include "voronoi/diagramfile.h"
+#include "voronoi/stripsweep.h"
+#include "voronoi/sweepline.h"
+
+namespace
+{
+/**
+ * @brief queue between two pipeline stages, push blocks while it holds
+ * capacity items and pop blocks while it's empty but not closed
+ */
+template <class T>
+class Channel
+{
+public:
+    explicit Channel(size_t capacity)
+        : capacity(capacity)
+    {
+    }
+
+    void push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [&] { return items.size() < capacity; });
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+    }
+
+    /**
+     * @brief no more items will be pushed
+     */
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+    }
+
+    /**
+     * @return false once the channel is closed and drained
+     */
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [&] { return !items.empty() || closed; });
+        if (items.empty())
+            return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+private:
+    const size_t capacity;
+    std::deque<T> items;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable notFull, notEmpty;
+};
+
+struct Options {
+    bool edges = false;
+    bool stream = false;
+    bool binary = false;
+    bool verbose = false;
+    // empty to write everything to stdout
+    std::string outputDir;
+    // empty not to write traces
+    std::string traceDir;
+    bool fixedBounds = false;
+    Rectangle bounds;
+    unsigned threads = 1;
+    std::vector<std::string> inputs;
+};
+
+// one point file on its way through the pipeline
+struct Job {
+    std::string path;
+    std::vector<Point> sites;
+    std::shared_ptr<Voronoi> vmap;
+    std::string error;
+};
+
+void usage()
+{
+    std::fprintf(
+        stderr,
+        "usage: voronoi_cli [-b | -e] [-S] [-o dir] [-s WIDTHxHEIGHT] "
+        "[-t threads] [-T dir] [-v] [file ...]\n"
+        "  computes the voronoi diagram of every point file, files are read\n"
+        "  from stdin one per line if none are given\n"
+        "  -b  write binary diagram files dir/<file name>.vdgm, which can be\n"
+        "      mapped and used in place, see voronoi/diagramfile.h. Needs -o\n"
+        "  -e  write edges instead of cells\n"
+        "  -o  write each diagram to dir/<file name>.cells or .edges instead\n"
+        "      of stdout\n"
+        "  -S  write cells while sweeping, in the order they're finished and\n"
+        "      preceded by their site's index, on a single thread. Only\n"
+        "      about the beach line of the diagram is held in memory\n"
+        "  -s  clip to (0, 0, WIDTH, HEIGHT) instead of the box around the\n"
+        "      sites\n"
+        "  -t  sweep every file on this many threads, 0 for all cores\n"
+        "  -T  write the timeline of every single threaded sweep to\n"
+        "      dir/<file name>.trace.json, needs core built with\n"
+        "      CONFIG+=sweep_stats\n"
+        "  -v  report throughput on stderr\n");
+}
+
+bool parseOptions(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (arg[0] != '-' || arg[1] == '\0') {
+            options.inputs.push_back(arg);
+            continue;
+        }
+        if (std::strcmp(arg, "-b") == 0) {
+            options.binary = true;
+        } else if (std::strcmp(arg, "-e") == 0) {
+            options.edges = true;
+        } else if (std::strcmp(arg, "-S") == 0) {
+            options.stream = true;
+        } else if (std::strcmp(arg, "-v") == 0) {
+            options.verbose = true;
+        } else if (i + 1 == argc) {
+            return false;
+        } else if (std::strcmp(arg, "-o") == 0) {
+            options.outputDir = argv[++i];
+        } else if (std::strcmp(arg, "-T") == 0) {
+            options.traceDir = argv[++i];
+        } else if (std::strcmp(arg, "-s") == 0) {
+            int width, height;
+            char separator;
+            if (std::sscanf(argv[++i], "%d%c%d", &width, &separator,
+                            &height) != 3 ||
+                separator != 'x' || width <= 0 || height <= 0)
+                return false;
+            options.fixedBounds = true;
+            options.bounds = Rectangle(0, 0, width, height);
+        } else if (std::strcmp(arg, "-t") == 0) {
+            char* end;
+            const long threads = std::strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || threads < 0 ||
+                threads > std::numeric_limits<int>::max())
+                return false;
+            options.threads = (unsigned) threads;
+        } else {
+            return false;
+        }
+    }
+    return !(options.edges && (options.stream || options.binary)) &&
+           !(options.binary && options.outputDir.empty());
+}
+
+/**
+ * @brief the box around sites, false if its size or far corner doesn't fit in
+ * int like the diagram's size has to
+ */
+bool siteBounds(const std::vector<Point>& sites,
+                Rectangle& bounds,
+                std::string& error)
+{
+    int64_t minX = sites[0].x, maxX = sites[0].x;
+    int64_t minY = sites[0].y, maxY = sites[0].y;
+    for (const Point& site : sites) {
+        minX = std::min<int64_t>(minX, site.x);
+        maxX = std::max<int64_t>(maxX, site.x);
+        minY = std::min<int64_t>(minY, site.y);
+        maxY = std::max<int64_t>(maxY, site.y);
+    }
+    const int64_t width = std::max<int64_t>(maxX - minX, 1);
+    const int64_t height = std::max<int64_t>(maxY - minY, 1);
+    const int64_t limit = std::numeric_limits<int>::max();
+    if (width > limit || height > limit || minX + width > limit ||
+        minY + height > limit) {
+        error = "sites span more than " + std::to_string(limit) +
+                " units, more than a diagram holds";
+        return false;
+    }
+    bounds = Rectangle((int) minX, (int) minY, (int) width, (int) height);
+    return true;
+}
+
+std::string outputPath(const std::string& input,
+                       const std::string& dir,
+                       const char* extension)
+{
+    size_t nameBegin = input.find_last_of('/');
+    nameBegin = nameBegin == std::string::npos ? 0 : nameBegin + 1;
+    size_t nameEnd = input.find_last_of('.');
+    if (nameEnd == std::string::npos || nameEnd < nameBegin)
+        nameEnd = input.size();
+    return dir + '/' + input.substr(nameBegin, nameEnd - nameBegin) +
+           extension;
+}
+
+std::string outputPath(const std::string& input, const Options& options)
+{
+    return outputPath(input, options.outputDir,
+                      options.binary  ? ".vdgm"
+                      : options.edges ? ".edges"
+                                      : ".cells");
+}
+
+/**
+ * @brief write the cells of job as they're finished by sweepLine, which
+ * holds job's sites, instead of leaving the diagram to the writer
+ */
+void streamCells(Job& job,
+                 SweepLine& sweepLine,
+                 const Rectangle& bounds,
+                 const Options& options)
+{
+    const std::string path = options.outputDir.empty()
+                                 ? std::string("stdout")
+                                 : outputPath(job.path, options);
+    if (options.binary) {
+        const Voronoi empty{};
+        DiagramFileWriter writer(sweepLine.vmap ? *sweepLine.vmap : empty,
+                                 bounds);
+        if (sweepLine.vmap) {
+            sweepLine.streamFortune(
+                bounds, [&](const auto& cell) { writer.add(cell); });
+        }
+        std::string error;
+        if (!writer.finish(path, error))
+            job.error = "can't write " + path + ": " + error;
+        return;
+    }
+    std::FILE* file =
+        options.outputDir.empty() ? stdout : std::fopen(path.c_str(), "wb");
+    if (!file) {
+        job.error = "can't write " + path;
+        return;
+    }
+    std::string text;
+    if (options.outputDir.empty())
+        text += "# " + job.path + '\n';
+    bool written = true;
+    auto flush = [&] {
+        written = written &&
+                  std::fwrite(text.data(), 1, text.size(), file) == text.size();
+        text.clear();
+    };
+    if (sweepLine.vmap) {
+        sweepLine.streamFortune(bounds, [&](const auto& cell) {
+            writeCell(cell, text);
+            if (text.size() >= 1 << 20)
+                flush();
+        });
+    }
+    flush();
+    if (file != stdout)
+        written = std::fclose(file) == 0 && written;
+    if (!written)
+        job.error = "can't write " + path;
+}
+
+/**
+ * @brief write the timeline of job's sweep, if asked to
+ */
+void writeTrace(Job& job, const SweepStats& stats, const Options& options)
+{
+    if (options.traceDir.empty())
+        return;
+    const std::string path =
+        outputPath(job.path, options.traceDir, ".trace.json");
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        job.error = "can't write " + path;
+        return;
+    }
+    stats.writeChromeTrace(file);
+    std::fclose(file);
+}
+
+/**
+ * @brief sweep job's diagram on this thread, building only what Output asks
+ * for
+ */
+template <class Output>
+void sweepDcel(Job& job, const Rectangle& bounds, const Options& options)
+{
+    BasicSweepLine<int, double, Output> sweepLine(job.vmap);
+    while (sweepLine.nextEvent() != sweepLine.LMAXVALUE)
+        ;
+    sweepLine.finishEdges(bounds);
+    writeTrace(job, sweepLine.stats, options);
+}
+
+void sweep(Job& job, const Options& options)
+{
+    SweepLine sweepLine;
+    if (job.sites.empty()) {
+        if (options.stream)
+            streamCells(job, sweepLine, Rectangle(), options);
+        return;
+    }
+    Rectangle bounds = options.bounds;
+    if (!options.fixedBounds && !siteBounds(job.sites, bounds, job.error))
+        return;
+    job.vmap = std::make_shared<Voronoi>(bounds.getRight(), bounds.getBottom());
+    job.vmap->polygons.reserve(job.sites.size());
+    for (const Point& site : job.sites)
+        job.vmap->addPoly(Polygon(site));
+
+    // the writers only need the dcel, so the polygons' edges aren't synced
+    if (options.threads != 1 && !options.stream) {
+        StripSweep(job.vmap).sweep(bounds, options.threads);
+        return;
+    }
+    if (options.stream) {
+        sweepLine.loadVmap(job.vmap);
+        streamCells(job, sweepLine, bounds, options);
+        if (job.error.empty())
+            writeTrace(job, sweepLine.stats, options);
+    } else if (options.edges) {
+        // edges are written from the half-edges alone
+        sweepDcel<EdgeOutput>(job, bounds, options);
+    } else {
+        sweepDcel<CellOutput>(job, bounds, options);
+    }
+}
+
+bool write(const Job& job, const Options& options, std::string& text)
+{
+    // streamed diagrams were written while sweeping
+    if (options.stream)
+        return true;
+    if (options.binary) {
+        const Voronoi empty{};
+        std::string error;
+        return writeDiagramFile(job.vmap ? *job.vmap : empty,
+                                outputPath(job.path, options), error);
+    }
+    text.clear();
+    if (options.outputDir.empty())
+        text += "# " + job.path + '\n';
+    if (job.vmap) {
+        if (options.edges)
+            writeEdges(*job.vmap, text);
+        else
+            writeCells(*job.vmap, text);
+    }
+
+    if (options.outputDir.empty())
+        return std::fwrite(text.data(), 1, text.size(), stdout) == text.size();
+    const std::string path = outputPath(job.path, options);
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    bool written = std::fwrite(text.data(), 1, text.size(), file) ==
+                   text.size();
+    return std::fclose(file) == 0 && written;
+}
+}  // namespace
+
+/**
+ * Computes the voronoi diagrams of many point files without a display.
+ * Reading and parsing the next file, sweeping the current one and writing
+ * the previous one's result run at the same time, each on its own thread, so
+ * a batch takes about as long as its slowest stage.
+ */
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+    if (!options.traceDir.empty() && !SweepStats::enabled) {
+        std::fprintf(stderr, "-T needs core built with CONFIG+=sweep_stats\n");
+        return 2;
+    }
+    if (options.inputs.empty() ||
+        (options.inputs.size() == 1 && options.inputs[0] == "-")) {
+        options.inputs.clear();
+        for (std::string line; std::getline(std::cin, line);) {
+            if (!line.empty())
+                options.inputs.push_back(line);
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    // two jobs waiting per stage are enough to even out files of different
+    // size while bounding memory
+    Channel<Job> parsed(2), swept(2);
+    std::thread parser([&] {
+        MappedFile file;
+        for (const std::string& path : options.inputs) {
+            Job job;
+            job.path = path;
+            if (!readSites(path, file, job.sites, job.error))
+                job.sites.clear();
+            parsed.push(std::move(job));
+        }
+        parsed.close();
+    });
+    std::thread sweeper([&] {
+        for (Job job; parsed.pop(job);) {
+            if (job.error.empty())
+                sweep(job, options);
+            swept.push(std::move(job));
+        }
+        swept.close();
+    });
+
+    int failed = 0;
+    size_t sites = 0;
+    std::string text;
+    for (Job job; swept.pop(job);) {
+        if (job.error.empty() && !write(job, options, text))
+            job.error = "can't write " + (options.outputDir.empty()
+                                              ? std::string("stdout")
+                                              : outputPath(job.path, options));
+        if (!job.error.empty()) {
+            std::fprintf(stderr, "%s: %s\n", job.path.c_str(),
+                         job.error.c_str());
+            ++failed;
+        }
+        sites += job.sites.size();
+        // the diagram is freed here rather than when job is overwritten
+        job = Job();
+    }
+    parser.join();
+    sweeper.join();
+    std::fflush(stdout);
+
+    if (options.verbose) {
+        std::chrono::duration<double> seconds =
+            std::chrono::steady_clock::now() - start;
+        std::fprintf(stderr,
+                     "%zu files, %zu sites in %.3f s, %.0f sites/s, %d "
+                     "failed\n",
+                     options.inputs.size(), sites, seconds.count(),
+                     sites / seconds.count(), failed);
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+#include "sitefile.h"
+
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+const size_t binaryHeaderSize = 16;
+
+const char* skipBlanks(const char* p, const char* end)
+{
+    while (p != end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+    return p;
+}
+
+uint32_t readUint32(const char* p)
+{
+    const auto* b = reinterpret_cast<const unsigned char*>(p);
+    return (uint32_t) b[0] | (uint32_t) b[1] << 8 | (uint32_t) b[2] << 16 |
+           (uint32_t) b[3] << 24;
+}
+
+uint64_t readUint64(const char* p)
+{
+    return readUint32(p) | (uint64_t) readUint32(p + 4) << 32;
+}
+
+/**
+ * @brief check the header of the binary site set in [begin, end) against its
+ * size
+ * @param count set to the number of sites
+ */
+bool checkBinarySites(const char* begin,
+                      const char* end,
+                      uint64_t& count,
+                      std::string& error)
+{
+    const size_t size = end - begin;
+    if (size < binaryHeaderSize ||
+        std::memcmp(begin, siteFileMagic, sizeof(siteFileMagic)) != 0) {
+        error = "not a binary site file";
+        return false;
+    }
+    uint32_t version = readUint32(begin + 4);
+    if (version != siteFileVersion) {
+        error = "unsupported binary site file version " +
+                std::to_string(version);
+        return false;
+    }
+    count = readUint64(begin + 8);
+    if ((size - binaryHeaderSize) % 8 != 0 ||
+        count != (size - binaryHeaderSize) / 8) {
+        error = "binary site file holds " +
+                std::to_string((size - binaryHeaderSize) / 8) +
+                " sites, its header says " + std::to_string(count);
+        return false;
+    }
+    return true;
+}
+}  // namespace
+
+bool parseTextSites(const char* begin,
+                    const char* end,
+                    std::vector<Point>& sites,
+                    std::string& error)
+{
+    size_t line = 1;
+    for (const char* p = begin; p != end; ++line) {
+        const char* eol = (const char*) std::memchr(p, '\n', end - p);
+        if (!eol)
+            eol = end;
+        const char* q = skipBlanks(p, eol);
+        if (q != eol && *q != '#') {
+            int x, y;
+            auto parsedX = std::from_chars(q, eol, x);
+            q = skipBlanks(parsedX.ptr, eol);
+            if (q != eol && *q == ',')
+                q = skipBlanks(q + 1, eol);
+            // the two numbers need something in between
+            bool separated = q != parsedX.ptr;
+            auto parsedY = std::from_chars(q, eol, y);
+            if (parsedX.ec != std::errc() || !separated ||
+                parsedY.ec != std::errc() ||
+                skipBlanks(parsedY.ptr, eol) != eol) {
+                error = "line " + std::to_string(line) +
+                        ": expected two integers";
+                return false;
+            }
+            sites.emplace_back(x, y);
+        }
+        p = eol == end ? end : eol + 1;
+    }
+    return true;
+}
+
+bool parseBinarySites(const char* begin,
+                      const char* end,
+                      std::vector<Point>& sites,
+                      std::string& error)
+{
+    uint64_t count;
+    if (!checkBinarySites(begin, end, count, error))
+        return false;
+    const char* p = begin + binaryHeaderSize;
+    sites.reserve(sites.size() + count);
+    for (uint64_t i = 0; i < count; ++i, p += 8) {
+        sites.emplace_back((int32_t) readUint32(p),
+                           (int32_t) readUint32(p + 4));
+    }
+    return true;
+}
+
+bool readSites(const std::string& path,
+               MappedFile& file,
+               std::vector<Point>& sites,
+               std::string& error)
+{
+    if (!file.open(path, error))
+        return false;
+    const char* begin = file.data();
+    const size_t size = file.size();
+    if (size >= sizeof(siteFileMagic) &&
+        std::memcmp(begin, siteFileMagic, sizeof(siteFileMagic)) == 0)
+        return parseBinarySites(begin, begin + size, sites, error);
+    return parseTextSites(begin, begin + size, sites, error);
+}
+
+bool SiteFileView::open(const std::string& path, std::string& error)
+{
+    coordinates = nullptr;
+    count = 0;
+    // the sites are used in place, which needs the host's byte order to match
+    const uint16_t one = 1;
+    if (*reinterpret_cast<const unsigned char*>(&one) != 1) {
+        error = "big-endian hosts aren't supported";
+        return false;
+    }
+    if (!file.open(path, error))
+        return false;
+    uint64_t sites;
+    if (!checkBinarySites(file.data(), file.data() + file.size(), sites,
+                          error))
+        return false;
+    coordinates =
+        reinterpret_cast<const int32_t*>(file.data() + binaryHeaderSize);
+    count = sites;
+    return true;
+}
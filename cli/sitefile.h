@@ -0,0 +1,77 @@
+#ifndef SITEFILE_H
+#define SITEFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "geometry/point.h"
+#include "voronoi/mappedfile.h"
+
+/**
+ * Site sets are read from text or binary point files.
+ *
+ * Text files hold one site per line as two integers separated by blanks or a
+ * comma, blank lines and lines starting with '#' are skipped.
+ *
+ * Binary files start with the 4 bytes "VSIT", a uint32 version, currently 1,
+ * and a uint64 count of sites, followed by count pairs of int32 x and y. All
+ * numbers are little-endian, and aligned so that a mapped file can be used in
+ * place, see SiteFileView.
+ */
+constexpr char siteFileMagic[4] = {'V', 'S', 'I', 'T'};
+constexpr uint32_t siteFileVersion = 1;
+
+/**
+ * @brief parse the text sites in [begin, end) and append them to sites
+ * @param error set to a message naming the first malformed line
+ * @return false if the text is malformed
+ */
+bool parseTextSites(const char* begin,
+                    const char* end,
+                    std::vector<Point>& sites,
+                    std::string& error);
+/**
+ * @brief parse the binary site set in [begin, end) and append it to sites
+ */
+bool parseBinarySites(const char* begin,
+                      const char* end,
+                      std::vector<Point>& sites,
+                      std::string& error);
+
+/**
+ * @brief read the sites of a text or binary file, told apart by the magic
+ * @param file reused to map the file, or to hold its content where it can't
+ * be mapped
+ */
+bool readSites(const std::string& path,
+               MappedFile& file,
+               std::vector<Point>& sites,
+               std::string& error);
+
+/**
+ * @brief SiteFileView gives access to the sites of a mapped binary site file
+ * without copying them, until it's opened again or destroyed
+ */
+class SiteFileView
+{
+public:
+    /**
+     * @brief map path and check its header and size
+     * @param error set to the reason if it fails
+     */
+    bool open(const std::string& path, std::string& error);
+
+    size_t size() const { return count; }
+    Point operator[](size_t i) const
+    {
+        return Point(coordinates[2 * i], coordinates[2 * i + 1]);
+    }
+
+private:
+    MappedFile file;
+    const int32_t* coordinates = nullptr;
+    size_t count = 0;
+};
+
+#endif  // SITEFILE_H
@@ -0,0 +1,19 @@
+# link against voronoi_core, include this from projects built by the
+# top-level Voronoi_Diagram.pro, which builds core first
+
+INCLUDEPATH += $$PWD/..
+DEPENDPATH += $$PWD/..
+
+CORE_DIR = $$shadowed($$PWD)
+win32:CONFIG(debug, debug|release): CORE_DIR = $$CORE_DIR/debug
+else:win32: CORE_DIR = $$CORE_DIR/release
+
+# must match how core was built, SweepStats::enabled depends on it
+sweep_stats: DEFINES += VORONOI_SWEEP_STATS
+
+LIBS += -L$$CORE_DIR -lvoronoi_core
+win32-msvc*: PRE_TARGETDEPS += $$CORE_DIR/voronoi_core.lib
+else: PRE_TARGETDEPS += $$CORE_DIR/libvoronoi_core.a
+
+# the engine sorts and sweeps on std::threads
+CONFIG += thread
@@ -0,0 +1,67 @@
+# voronoi_core, the geometry and sweep engine as a static library without Qt
+# extra flags can be given as in qmake CORE_CXXFLAGS="-O3 -march=native"
+
+TEMPLATE = lib
+CONFIG += staticlib c++17
+CONFIG -= qt
+
+# gcc only vectorizes loops like clipSegments' at -O2 with a cheaper cost
+# model, clang does so by default
+gcc:!clang: QMAKE_CXXFLAGS_RELEASE += -ftree-vectorize -fvect-cost-model=cheap
+QMAKE_CXXFLAGS_RELEASE += $$CORE_CXXFLAGS
+
+# record SweepLine::stats, see voronoi/sweepstats.h
+sweep_stats: DEFINES += VORONOI_SWEEP_STATS
+
+TARGET = voronoi_core
+
+INCLUDEPATH += ..
+
+SOURCES += \
+	../geometry/convexclipper.cpp \
+	../geometry/edge.cpp \
+	../geometry/point.cpp \
+	../geometry/polygon.cpp \
+	../geometry/predicates.cpp \
+	../geometry/rectangle.cpp \
+	../geometry/segmentclipper.cpp \
+	../voronoi/cellarrays.cpp \
+	../voronoi/dcel.cpp \
+	../voronoi/delaunay.cpp \
+	../voronoi/diagramfile.cpp \
+	../voronoi/diagramlines.cpp \
+	../voronoi/lloydrelaxation.cpp \
+	../voronoi/mappedfile.cpp \
+	../voronoi/pointlocator.cpp \
+	../voronoi/stripsweep.cpp \
+	../voronoi/sweepline.cpp \
+	../voronoi/sweepstats.cpp \
+	../voronoi/sweepworker.cpp \
+	../voronoi/voronoi.cpp
+
+HEADERS += \
+	../data_structure/beachline.h \
+	../data_structure/indexedheap.h \
+	../data_structure/parallelfor.h \
+	../data_structure/radixsort.h \
+	../data_structure/uniformgrid.h \
+	../geometry/convexclipper.h \
+	../geometry/edge.h \
+	../geometry/point.h \
+	../geometry/polygon.h \
+	../geometry/predicates.h \
+	../geometry/rectangle.h \
+	../geometry/segmentclipper.h \
+	../voronoi/cellarrays.h \
+	../voronoi/dcel.h \
+	../voronoi/delaunay.h \
+	../voronoi/diagramfile.h \
+	../voronoi/diagramlines.h \
+	../voronoi/lloydrelaxation.h \
+	../voronoi/mappedfile.h \
+	../voronoi/pointlocator.h \
+	../voronoi/stripsweep.h \
+	../voronoi/sweepline.h \
+	../voronoi/sweepstats.h \
+	../voronoi/sweepworker.h \
+	../voronoi/voronoi.h
@@ -0,0 +1,291 @@
+#ifndef BEACHLINE_H
+#define BEACHLINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <utility>
+
+/**
+ * @brief BeachLine is a sequence container with std::list like iterators
+ * (stable, O(1) prev/next) whose nodes are additionally kept in a treap, so
+ * that the sequence can be binary searched in O(log n) expected time.
+ *
+ * The container does not store any key. Order is solely defined by where
+ * elements are inserted, and searching is done by partition_point with a
+ * predicate that is evaluated lazily on the visited nodes only. This suits
+ * the beach line, whose breakpoints move with the sweep line but never change
+ * their relative order.
+ *
+ * Erased nodes are kept for later insertions, also by clear(), so a sweep
+ * only allocates as many nodes as the beach line is long at its longest,
+ * and sweeping again with the same BeachLine allocates none.
+ */
+template <class T>
+class BeachLine
+{
+private:
+    struct NodeBase {
+        NodeBase* prev;
+        NodeBase* next;
+    };
+    struct Node : NodeBase {
+        template <class... Args>
+        Node(Args&&... args)
+            : value(std::forward<Args>(args)...)
+        {
+        }
+
+        T value;
+        Node* parent = nullptr;
+        Node* left = nullptr;
+        Node* right = nullptr;
+        uint32_t priority = 0;
+    };
+
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator() = default;
+
+        reference operator*() const { return static_cast<Node*>(node)->value; }
+        pointer operator->() const { return &static_cast<Node*>(node)->value; }
+        iterator& operator++()
+        {
+            node = node->next;
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator tmp = *this;
+            node = node->next;
+            return tmp;
+        }
+        iterator& operator--()
+        {
+            node = node->prev;
+            return *this;
+        }
+        iterator operator--(int)
+        {
+            iterator tmp = *this;
+            node = node->prev;
+            return tmp;
+        }
+        bool operator==(const iterator& rhs) const { return node == rhs.node; }
+        bool operator!=(const iterator& rhs) const { return node != rhs.node; }
+
+    private:
+        friend class BeachLine;
+        explicit iterator(NodeBase* node)
+            : node(node)
+        {
+        }
+        NodeBase* node = nullptr;
+    };
+
+    BeachLine() { head.prev = head.next = &head; }
+    BeachLine(const BeachLine&) = delete;
+    BeachLine& operator=(const BeachLine&) = delete;
+    ~BeachLine()
+    {
+        clear();
+        while (freeNodes) {
+            FreeNode* next = freeNodes->next;
+            ::operator delete(freeNodes);
+            freeNodes = next;
+        }
+    }
+
+    iterator begin() { return iterator(head.next); }
+    iterator end() { return iterator(&head); }
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void clear()
+    {
+        for (NodeBase* it = head.next; it != &head;) {
+            NodeBase* next = it->next;
+            release(static_cast<Node*>(it));
+            it = next;
+        }
+        head.prev = head.next = &head;
+        root = nullptr;
+        count = 0;
+    }
+
+    /**
+     * @brief insert value before pos
+     * @return iterator to the inserted value
+     */
+    template <class... Args>
+    iterator emplace(iterator pos, Args&&... args)
+    {
+        Node* node = new (allocate()) Node(std::forward<Args>(args)...);
+        node->priority = nextPriority();
+
+        // attach to tree, as in-order predecessor of pos
+        if (!root) {
+            root = node;
+        } else if (pos == end()) {
+            Node* last = static_cast<Node*>(head.prev);
+            last->right = node;
+            node->parent = last;
+        } else {
+            Node* succ = static_cast<Node*>(pos.node);
+            if (!succ->left) {
+                succ->left = node;
+                node->parent = succ;
+            } else {
+                // rightmost node of left subtree is the list predecessor
+                Node* pred = static_cast<Node*>(succ->prev);
+                pred->right = node;
+                node->parent = pred;
+            }
+        }
+        while (node->parent && node->parent->priority < node->priority)
+            rotateUp(node);
+
+        // attach to list
+        node->next = pos.node;
+        node->prev = pos.node->prev;
+        pos.node->prev->next = node;
+        pos.node->prev = node;
+        ++count;
+        return iterator(node);
+    }
+    iterator insert(iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(iterator pos, T&& value)
+    {
+        return emplace(pos, std::move(value));
+    }
+    void push_back(const T& value) { emplace(end(), value); }
+    void push_back(T&& value) { emplace(end(), std::move(value)); }
+
+    /**
+     * @brief erase element at pos
+     * @return iterator following the removed element
+     */
+    iterator erase(iterator pos)
+    {
+        Node* node = static_cast<Node*>(pos.node);
+        // rotate node down until it becomes a leaf
+        while (node->left || node->right) {
+            if (!node->right ||
+                (node->left && node->left->priority > node->right->priority))
+                rotateUp(node->left);
+            else
+                rotateUp(node->right);
+        }
+        if (!node->parent)
+            root = nullptr;
+        else if (node->parent->left == node)
+            node->parent->left = nullptr;
+        else
+            node->parent->right = nullptr;
+
+        NodeBase* next = node->next;
+        node->prev->next = next;
+        next->prev = node->prev;
+        release(node);
+        --count;
+        return iterator(next);
+    }
+
+    /**
+     * @brief binary search the sequence
+     * @param pred predicate taking an iterator, the sequence must be
+     * partitioned such that all elements for which pred returns true precede
+     * those for which it returns false
+     * @return iterator to the first element for which pred returns false, or
+     * end() if there is no such element
+     */
+    template <class Pred>
+    iterator partition_point(Pred pred)
+    {
+        NodeBase* result = &head;
+        Node* cur = root;
+        while (cur) {
+            if (pred(iterator(cur))) {
+                cur = cur->right;
+            } else {
+                result = cur;
+                cur = cur->left;
+            }
+        }
+        return iterator(result);
+    }
+
+private:
+    NodeBase head;  // sentinel of the circular list, also serves as end()
+    Node* root = nullptr;
+    size_t count = 0;
+    uint32_t seed = 2463534242u;
+    // storage of erased nodes, reused by the next insertions
+    struct FreeNode {
+        FreeNode* next;
+    };
+    FreeNode* freeNodes = nullptr;
+
+    void* allocate()
+    {
+        if (!freeNodes)
+            return ::operator new(sizeof(Node));
+        FreeNode* storage = freeNodes;
+        freeNodes = storage->next;
+        return storage;
+    }
+    void release(Node* node)
+    {
+        void* storage = node;
+        node->~Node();
+        freeNodes = new (storage) FreeNode{freeNodes};
+    }
+
+    uint32_t nextPriority()
+    {
+        // xorshift32
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    /**
+     * @brief rotate node above its parent, keeping in-order sequence intact
+     */
+    void rotateUp(Node* node)
+    {
+        Node* parent = node->parent;
+        Node* grand = parent->parent;
+        if (parent->left == node) {
+            parent->left = node->right;
+            if (node->right)
+                node->right->parent = parent;
+            node->right = parent;
+        } else {
+            parent->right = node->left;
+            if (node->left)
+                node->left->parent = parent;
+            node->left = parent;
+        }
+        parent->parent = node;
+        node->parent = grand;
+        if (!grand)
+            root = node;
+        else if (grand->left == parent)
+            grand->left = node;
+        else
+            grand->right = node;
+    }
+};
+
+#endif  // BEACHLINE_H
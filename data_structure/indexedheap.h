@@ -0,0 +1,156 @@
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief IndexedHeap is a d-ary heap stored in contiguous arrays which hands
+ * out stable handles, so that any element can be erased in O(log n).
+ *
+ * Elements live in a slot array indexed by handle, the heap itself only
+ * shuffles 32-bit handles around. Freed slots are recycled and clear() keeps
+ * all capacity, so once the arrays have grown a steady stream of push and
+ * erase does not allocate.
+ *
+ * Like std::priority_queue, top() is the greatest element according to
+ * Compare, use std::greater<> for a min heap.
+ */
+template <class T, class Compare = std::less<T>, unsigned Arity = 4>
+class IndexedHeap
+{
+    static_assert(Arity >= 2, "heap arity must be at least 2");
+
+public:
+    using handle = uint32_t;
+    static constexpr handle npos = std::numeric_limits<handle>::max();
+
+    IndexedHeap() = default;
+    explicit IndexedHeap(const Compare& comp)
+        : comp(comp)
+    {
+    }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    void clear()
+    {
+        values.clear();
+        heap.clear();
+        position.clear();
+        freeSlots.clear();
+    }
+    void reserve(size_t n)
+    {
+        values.reserve(n);
+        heap.reserve(n);
+        position.reserve(n);
+        freeSlots.reserve(n);
+    }
+
+    template <class... Args>
+    handle emplace(Args&&... args)
+    {
+        handle h;
+        if (freeSlots.empty()) {
+            h = (handle) values.size();
+            values.emplace_back(std::forward<Args>(args)...);
+            position.push_back(npos);
+        } else {
+            h = freeSlots.back();
+            freeSlots.pop_back();
+            values[h] = T(std::forward<Args>(args)...);
+        }
+        position[h] = (uint32_t) heap.size();
+        heap.push_back(h);
+        siftUp(position[h]);
+        return h;
+    }
+    handle push(const T& value) { return emplace(value); }
+    handle push(T&& value) { return emplace(std::move(value)); }
+
+    const T& top() const { return values[heap.front()]; }
+    handle topHandle() const { return heap.front(); }
+    void pop() { erase(heap.front()); }
+
+    /**
+     * @brief remove element referred by h, h becomes invalid afterwards
+     */
+    void erase(handle h)
+    {
+        uint32_t pos = position[h];
+        handle last = heap.back();
+        heap.pop_back();
+        position[h] = npos;
+        freeSlots.push_back(h);
+        if (last == h)
+            return;
+        heap[pos] = last;
+        position[last] = pos;
+        if (pos > 0 && comp(values[heap[(pos - 1) / Arity]], values[last]))
+            siftUp(pos);
+        else
+            siftDown(pos);
+    }
+
+    bool contains(handle h) const
+    {
+        return h < position.size() && position[h] != npos;
+    }
+    const T& operator[](handle h) const { return values[h]; }
+
+private:
+    std::vector<T> values;           // element slots, indexed by handle
+    std::vector<handle> heap;        // heap ordered handles
+    std::vector<uint32_t> position;  // index into heap, npos for free slots
+    std::vector<handle> freeSlots;
+    Compare comp;
+
+    void place(uint32_t pos, handle h)
+    {
+        heap[pos] = h;
+        position[h] = pos;
+    }
+
+    void siftUp(uint32_t pos)
+    {
+        handle h = heap[pos];
+        while (pos > 0) {
+            uint32_t parent = (pos - 1) / Arity;
+            if (!comp(values[heap[parent]], values[h]))
+                break;
+            place(pos, heap[parent]);
+            pos = parent;
+        }
+        place(pos, h);
+    }
+
+    void siftDown(uint32_t pos)
+    {
+        handle h = heap[pos];
+        const size_t n = heap.size();
+        while (true) {
+            size_t first = (size_t) pos * Arity + 1;
+            if (first >= n)
+                break;
+            size_t last = std::min(first + Arity, n);
+            size_t best = first;
+            for (size_t child = first + 1; child < last; ++child) {
+                if (comp(values[heap[best]], values[heap[child]]))
+                    best = child;
+            }
+            if (!comp(values[h], values[heap[best]]))
+                break;
+            place(pos, heap[best]);
+            pos = (uint32_t) best;
+        }
+        place(pos, h);
+    }
+};
+
+#endif  // INDEXEDHEAP_H
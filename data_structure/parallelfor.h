@@ -0,0 +1,42 @@
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief number of threads worth using for n items
+ * @param threads requested number of threads, 0 for hardware concurrency
+ * @param minItemsPerThread below this many items per thread, spawning threads
+ * costs more than it saves
+ */
+inline unsigned chunkThreads(unsigned threads,
+                             size_t n,
+                             size_t minItemsPerThread)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    return (unsigned) std::min<size_t>(
+        threads, std::max<size_t>(1, n / minItemsPerThread));
+}
+
+/**
+ * @brief split [0, n) into `threads` contiguous chunks and run
+ * fn(thread, begin, end) on each, the calling thread takes the first chunk
+ */
+template <class Fn>
+void forEachChunk(unsigned threads, size_t n, Fn fn)
+{
+    auto chunkBegin = [=](unsigned t) { return n * t / threads; };
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t)
+        workers.emplace_back(fn, t, chunkBegin(t), chunkBegin(t + 1));
+    fn(0u, chunkBegin(0), chunkBegin(1));
+    for (auto& worker : workers)
+        worker.join();
+}
+
+#endif  // PARALLELFOR_H
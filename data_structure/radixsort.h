@@ -0,0 +1,88 @@
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "parallelfor.h"
+
+/**
+ * @brief stable LSD radix sort by a 64-bit unsigned key, 8 bits per pass
+ *
+ * Every pass builds per-thread histograms of its chunk, then scatters the
+ * chunks in parallel into disjoint ranges of the output. Bytes that are equal
+ * across all keys are detected up front and their passes skipped, so keys
+ * built from small coordinates only pay for the bytes they use.
+ * @param items items to sort, T must be default constructible
+ * @param buffer scratch space of the same size as items, swapped with items
+ * after every pass. Passing the same one again saves allocating it
+ * @param key functor returning the uint64_t key of an item
+ * @param threads number of threads to use, 0 for hardware concurrency
+ */
+template <class T, class KeyFn>
+void parallelRadixSort(std::vector<T>& items,
+                       std::vector<T>& buffer,
+                       KeyFn key,
+                       unsigned threads = 0)
+{
+    const size_t n = items.size();
+    if (n < 2)
+        return;
+    threads = chunkThreads(threads, n, 1 << 16);
+
+    // find out which bits differ at all
+    std::vector<uint64_t> diffs(threads, 0);
+    const uint64_t firstKey = key(items[0]);
+    forEachChunk(threads, n, [&](unsigned t, size_t begin, size_t end) {
+        uint64_t diff = 0;
+        for (size_t i = begin; i < end; ++i)
+            diff |= key(items[i]) ^ firstKey;
+        diffs[t] = diff;
+    });
+    uint64_t diff = 0;
+    for (uint64_t d : diffs)
+        diff |= d;
+    if (diff == 0)
+        return;
+
+    buffer.resize(n);
+    std::vector<size_t> offsets((size_t) threads * 256);
+    for (unsigned shift = 0; shift < 64; shift += 8) {
+        if (((diff >> shift) & 0xff) == 0)
+            continue;
+
+        forEachChunk(threads, n, [&](unsigned t, size_t begin, size_t end) {
+            size_t* count = &offsets[(size_t) t * 256];
+            std::fill(count, count + 256, 0);
+            for (size_t i = begin; i < end; ++i)
+                ++count[(key(items[i]) >> shift) & 0xff];
+        });
+        // exclusive prefix sum, bucket major so that every bucket keeps the
+        // chunks in order, which is what makes the sort stable
+        size_t sum = 0;
+        for (size_t bucket = 0; bucket < 256; ++bucket) {
+            for (size_t t = 0; t < threads; ++t) {
+                size_t count = offsets[t * 256 + bucket];
+                offsets[t * 256 + bucket] = sum;
+                sum += count;
+            }
+        }
+        forEachChunk(threads, n, [&](unsigned t, size_t begin, size_t end) {
+            size_t* offset = &offsets[(size_t) t * 256];
+            for (size_t i = begin; i < end; ++i)
+                buffer[offset[(key(items[i]) >> shift) & 0xff]++] =
+                    std::move(items[i]);
+        });
+        items.swap(buffer);
+    }
+}
+
+template <class T, class KeyFn>
+void parallelRadixSort(std::vector<T>& items, KeyFn key, unsigned threads = 0)
+{
+    std::vector<T> buffer;
+    parallelRadixSort(items, buffer, key, threads);
+}
+
+#endif  // RADIXSORT_H
@@ -0,0 +1,108 @@
+#ifndef UNIFORMGRID_H
+#define UNIFORMGRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief UniformGrid buckets point ids into square cells covering a
+ * rectangle, so that the points around a position are found by looking at
+ * the few cells it overlaps. Points outside the rectangle are kept in the
+ * nearest cell along its border.
+ *
+ * The grid doesn't store positions, moving or erasing a point takes the
+ * position it was inserted at.
+ */
+class UniformGrid
+{
+public:
+    using id = uint32_t;
+
+    /**
+     * @brief cover the rectangle at (x, y) with cells of cellSize, without
+     * any points
+     */
+    void reset(double x, double y, double width, double height, double cellSize)
+    {
+        originX = x;
+        originY = y;
+        this->cellSize = cellSize;
+        columns = std::max(1, (int) std::ceil(width / cellSize));
+        rows = std::max(1, (int) std::ceil(height / cellSize));
+        cells.assign((size_t) columns * rows, {});
+    }
+
+    void insert(id point, double x, double y)
+    {
+        cells[cellOf(x, y)].push_back(point);
+    }
+    void erase(id point, double x, double y)
+    {
+        std::vector<id>& cell = cells[cellOf(x, y)];
+        auto it = std::find(cell.begin(), cell.end(), point);
+        if (it == cell.end())
+            return;
+        *it = cell.back();
+        cell.pop_back();
+    }
+    void move(id point, double fromX, double fromY, double toX, double toY)
+    {
+        const size_t to = cellOf(toX, toY);
+        if (cellOf(fromX, fromY) == to)
+            return;
+        erase(point, fromX, fromY);
+        cells[to].push_back(point);
+    }
+    /**
+     * @brief give the point at (x, y) with id from the id to instead
+     */
+    void rename(id from, id to, double x, double y)
+    {
+        std::vector<id>& cell = cells[cellOf(x, y)];
+        std::replace(cell.begin(), cell.end(), from, to);
+    }
+
+    /**
+     * @brief call f with every point in the cells overlapping the rectangle
+     * from (x0, y0) to (x1, y1), which includes points just outside of it
+     */
+    template <class F>
+    void forEach(double x0, double y0, double x1, double y1, F f) const
+    {
+        const int c0 = column(x0), c1 = column(x1);
+        const int r0 = row(y0), r1 = row(y1);
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                for (id point : cells[(size_t) r * columns + c])
+                    f(point);
+            }
+        }
+    }
+
+private:
+    double originX = 0, originY = 0;
+    double cellSize = 1;
+    int columns = 0, rows = 0;
+    std::vector<std::vector<id>> cells;
+
+    // clamped as double first, far away positions don't fit in an int
+    int column(double x) const
+    {
+        return (int) std::clamp(std::floor((x - originX) / cellSize), 0.0,
+                                (double) (columns - 1));
+    }
+    int row(double y) const
+    {
+        return (int) std::clamp(std::floor((y - originY) / cellSize), 0.0,
+                                (double) (rows - 1));
+    }
+    size_t cellOf(double x, double y) const
+    {
+        return (size_t) row(y) * columns + column(x);
+    }
+};
+
+#endif  // UNIFORMGRID_H
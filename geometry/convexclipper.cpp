@@ -0,0 +1,135 @@
+#include "convexclipper.h"
+
+#include "predicates.h"
+
+template <class Real>
+void BasicConvexClipper<Real>::clear()
+{
+    vertices.clear();
+    labels.clear();
+}
+
+template <class Real>
+void BasicConvexClipper<Real>::add(const Vertex& vertex, uint32_t label)
+{
+    vertices.push_back(vertex);
+    labels.push_back(label);
+}
+
+template <class Real>
+template <class T>
+void BasicConvexClipper<Real>::assign(const BasicRectangle<T>& rect,
+                                      uint32_t label)
+{
+    clear();
+    if (rect.width <= 0 || rect.height <= 0)
+        return;
+    const Real x0 = (Real) rect.x, x1 = (Real) rect.getRight();
+    const Real y0 = (Real) rect.y, y1 = (Real) rect.getBottom();
+    add(Vertex(x0, y0), label);
+    add(Vertex(x1, y0), label);
+    add(Vertex(x1, y1), label);
+    add(Vertex(x0, y1), label);
+}
+
+template <class Real>
+template <class T>
+void BasicConvexClipper<Real>::clip(const BasicRectangle<T>& rect,
+                                    uint32_t label)
+{
+    if (rect.width <= 0 || rect.height <= 0) {
+        clear();
+        return;
+    }
+    const double x0 = rect.x, x1 = rect.getRight();
+    const double y0 = rect.y, y1 = rect.getBottom();
+    // most cells of a diagram lie inside its bounds
+    bool inside = true;
+    for (const Vertex& vertex : vertices) {
+        inside = inside && vertex.x >= x0 && vertex.x <= x1 &&
+                 vertex.y >= y0 && vertex.y <= y1;
+    }
+    if (inside)
+        return;
+    cut([x0](const Vertex& p) { return p.x - x0; },
+        [x0](PointF& p) { p.x = x0; }, label);
+    cut([x1](const Vertex& p) { return x1 - p.x; },
+        [x1](PointF& p) { p.x = x1; }, label);
+    cut([y0](const Vertex& p) { return p.y - y0; },
+        [y0](PointF& p) { p.y = y0; }, label);
+    cut([y1](const Vertex& p) { return y1 - p.y; },
+        [y1](PointF& p) { p.y = y1; }, label);
+}
+
+template <class Real>
+void BasicConvexClipper<Real>::clip(const PointF& a,
+                                    const PointF& b,
+                                    uint32_t label)
+{
+    if (a.x == b.x && a.y == b.y)
+        return;
+    cut([&](const Vertex& p) { return orientation(a, b, p); },
+        [](PointF&) {}, label);
+}
+
+template <class Real>
+template <class Side, class Snap>
+void BasicConvexClipper<Real>::cut(Side side, Snap snap, uint32_t label)
+{
+    const size_t n = vertices.size();
+    if (n == 0)
+        return;
+    clippedVertices.clear();
+    clippedLabels.clear();
+    auto keep = [this](const Vertex& vertex, uint32_t label) {
+        clippedVertices.push_back(vertex);
+        clippedLabels.push_back(label);
+    };
+    auto cutPoint = [&](const PointF& p, const PointF& q, double dp,
+                        double dq) {
+        const double t = dp / (dp - dq);
+        PointF point(p.x + t * (q.x - p.x), p.y + t * (q.y - p.y));
+        snap(point);
+        return Vertex(point);
+    };
+
+    // a vertex exactly on the cut is kept once, as the cut point it is
+    const double first = side(vertices[0]);
+    double dp = first;
+    for (size_t i = 0; i < n; ++i) {
+        const Vertex& p = vertices[i];
+        const Vertex& q = vertices[i + 1 < n ? i + 1 : 0];
+        const double dq = i + 1 < n ? side(q) : first;
+        if (dp >= 0 && dq >= 0) {
+            keep(p, labels[i]);
+        } else if (dp >= 0) {
+            // leaving, the rest of the polygon up to where it enters again
+            // is replaced by an edge along the cut
+            if (dp > 0)
+                keep(p, labels[i]);
+            keep(dp > 0 ? cutPoint(p, q, dp, dq) : p, label);
+        } else if (dq > 0) {
+            keep(cutPoint(p, q, dp, dq), labels[i]);
+        }
+        dp = dq;
+    }
+    if (clippedVertices.size() < 3) {
+        clippedVertices.clear();
+        clippedLabels.clear();
+    }
+    vertices.swap(clippedVertices);
+    labels.swap(clippedLabels);
+}
+
+#define INSTANTIATE_CONVEX_CLIPPER(Real, T)                                  \
+    template void BasicConvexClipper<Real>::assign(const BasicRectangle<T>&, \
+                                                   uint32_t);                \
+    template void BasicConvexClipper<Real>::clip(const BasicRectangle<T>&,   \
+                                                 uint32_t);
+
+template class BasicConvexClipper<float>;
+template class BasicConvexClipper<double>;
+INSTANTIATE_CONVEX_CLIPPER(float, int)
+INSTANTIATE_CONVEX_CLIPPER(double, int)
+INSTANTIATE_CONVEX_CLIPPER(double, int64_t)
+INSTANTIATE_CONVEX_CLIPPER(double, double)
@@ -0,0 +1,68 @@
+#ifndef CONVEXCLIPPER_H
+#define CONVEXCLIPPER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "point.h"
+#include "rectangle.h"
+
+/**
+ * @brief BasicConvexClipper cuts a convex polygon with Real coordinates by
+ * half-planes, Sutherland-Hodgman style. Every edge carries a label, like the
+ * cell on its other side, which the part of it that's kept keeps, while the
+ * edge along a cut gets the cut's label. Cut points are computed in double.
+ *
+ * Clipping again reuses the arrays' memory.
+ */
+template <class Real>
+class BasicConvexClipper
+{
+public:
+    using Vertex = BasicPoint<Real>;
+
+    /**
+     * @brief vertices counter-clockwise (in y-up coordinates), edge i goes
+     * from vertices[i] to the next one and is labelled labels[i]
+     */
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> labels;
+
+    void clear();
+    void add(const Vertex& vertex, uint32_t label);
+    /**
+     * @brief start over from rect, all of its edges labelled label
+     */
+    template <class T>
+    void assign(const BasicRectangle<T>& rect, uint32_t label);
+
+    /**
+     * @brief keep the part inside rect, new edges along its border are
+     * labelled label
+     */
+    template <class T>
+    void clip(const BasicRectangle<T>& rect, uint32_t label);
+    /**
+     * @brief keep the part left of the line from a to b, i.e. the side a
+     * counter-clockwise polygon with an edge from a to b lies on
+     */
+    void clip(const PointF& a, const PointF& b, uint32_t label);
+
+private:
+    std::vector<Vertex> clippedVertices;
+    std::vector<uint32_t> clippedLabels;
+
+    /**
+     * @brief keep the vertices whose side(vertex) >= 0, cut points are moved
+     * exactly onto the cut by snap
+     */
+    template <class Side, class Snap>
+    void cut(Side side, Snap snap, uint32_t label);
+};
+
+using ConvexClipper = BasicConvexClipper<double>;
+
+extern template class BasicConvexClipper<float>;
+extern template class BasicConvexClipper<double>;
+
+#endif  // CONVEXCLIPPER_H
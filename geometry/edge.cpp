@@ -1,17 +1,25 @@
 #include "edge.h"
 
-Edge::Edge(const Point& a, const Point& b)
-    : a(std::make_shared<Point>(a)),
-      b(std::make_shared<Point>(b))
+template <class T>
+BasicEdge<T>::BasicEdge(const Vertex& a, const Vertex& b)
+    : a(std::make_shared<Vertex>(a)),
+      b(std::make_shared<Vertex>(b))
 {
 }
 
-double Edge::distance(const Point& other) const
+template <class T>
+double BasicEdge<T>::distance(const Vertex& other) const
 {
     if (!a || !b)
         throw std::invalid_argument("Edge::Distance: either a or b is null");
-    double bar = abs((b->y - a->y) * other.x - (b->x - a->x) * other.y +
-                     b->x * a->y - b->y * a->x);
-    double bar2 = sqrt(pow(b->y - a->y, 2) + pow(b->x - a->x, 2));
+    const double ax = a->x, ay = a->y, bx = b->x, by = b->y;
+    double bar = std::abs((by - ay) * other.x - (bx - ax) * other.y +
+                          bx * ay - by * ax);
+    double bar2 = sqrt(pow(by - ay, 2) + pow(bx - ax, 2));
     return bar / bar2;
 }
+
+template class BasicEdge<int>;
+template class BasicEdge<int64_t>;
+template class BasicEdge<float>;
+template class BasicEdge<double>;
@@ -7,21 +7,36 @@
 
 #include "point.h"
 
-class Edge
+/**
+ * @brief BasicEdge is a segment between two shared points with coordinates
+ * of type T, like the vertices of neighbouring cells
+ */
+template <class T>
+class BasicEdge
 {
 public:
-    Edge() = default;
-    Edge(const Point& a, const Point& b);
-    Edge(const Edge& other) = default;
-    Edge& operator=(const Edge& other) = default;
-    Edge& operator=(Edge&& other) = default;
-    ~Edge() = default;
+    using Vertex = BasicPoint<T>;
+
+    BasicEdge() = default;
+    BasicEdge(const Vertex& a, const Vertex& b);
+    BasicEdge(const BasicEdge& other) = default;
+    BasicEdge& operator=(const BasicEdge& other) = default;
+    BasicEdge& operator=(BasicEdge&& other) = default;
+    ~BasicEdge() = default;
 
     // edge defined as from point a to point b
-    std::shared_ptr<Point> a;
-    std::shared_ptr<Point> b;
+    std::shared_ptr<Vertex> a;
+    std::shared_ptr<Vertex> b;
 
-    double distance(const Point& other) const;
+    double distance(const Vertex& other) const;
 };
 
+// edges between the vertices of the default diagram
+using Edge = BasicEdge<double>;
+
+extern template class BasicEdge<int>;
+extern template class BasicEdge<int64_t>;
+extern template class BasicEdge<float>;
+extern template class BasicEdge<double>;
+
 #endif  // EDGE_H
@@ -1,78 +1,52 @@
 #include "point.h"
 
-Point::Point(int x, int y)
+template <class T>
+BasicPoint<T>::BasicPoint(T x, T y)
     : x(x),
       y(y)
 {
 }
 
-Point::Point(const PointF& old)
-    : x((int) old.x),
-      y((int) old.y)
+template <class T>
+double BasicPoint<T>::distance(const BasicPoint& other) const
 {
+    double dx = (double) this->x - other.x;
+    double dy = (double) this->y - other.y;
+    return sqrt(dx * dx + dy * dy);
 }
 
-double Point::distance(const Point& other) const
-{
-    return sqrt(pow(this->x - other.x, 2) + pow(this->y - other.y, 2));
-}
-
-bool Point::operator()(const Point& lhs, const Point& rhs)
+template <class T>
+bool BasicPoint<T>::operator()(const BasicPoint& lhs, const BasicPoint& rhs)
 {
     return (lhs.x < rhs.x) || (lhs.x == rhs.x && lhs.y < rhs.y);
 }
 
-Point& Point::operator=(const Point& rhs)
+template <class T>
+BasicPoint<T>& BasicPoint<T>::operator=(const BasicPoint& rhs)
 {
     this->x = rhs.x;
     this->y = rhs.y;
     return *this;
 }
 
-bool Point::operator==(const Point& rhs) const
-{
-    return (this->x == rhs.x && this->y == rhs.y);
-}
-
-PointF::PointF(double x, double y)
-    : x(x),
-      y(y)
-{
-}
-
-PointF::PointF(const Point& old)
-    : x(old.x),
-      y(old.y)
-{
-}
-
-double PointF::distance(const PointF& other) const
-{
-    return sqrt(pow(this->x - other.x, 2) + pow(this->y - other.y, 2));
-}
-PointF::operator Point() const
-{
-    return Point((int) x, (int) y);
-}
-
-bool PointF::operator==(const Point& rhs) const
-{
-    return (this->x == rhs.x && this->y == rhs.y);
-}
-
-Point getVector(const Point& a, const Point& b)
+template <class T>
+BasicPoint<T> getVector(const BasicPoint<T>& a, const BasicPoint<T>& b)
 {
-    return Point(b.x - a.x, b.y - a.y);
+    return BasicPoint<T>(b.x - a.x, b.y - a.y);
 }
 
-double cross(const Point& a, const Point& b, const Point& o)
+template <class T>
+double cross(const BasicPoint<T>& a,
+             const BasicPoint<T>& b,
+             const BasicPoint<T>& o)
 {
-    Point v1 = getVector(o, a);
-    Point v2 = getVector(o, b);
-    return v1.x * v2.y - v1.y * v2.x;
+    BasicPoint<T> v1 = getVector(o, a);
+    BasicPoint<T> v2 = getVector(o, b);
+    return (double) v1.x * v2.y - (double) v1.y * v2.x;
 }
 
-PointF midPoint(const std::vector<Point>& points)
+template <class T>
+PointF midPoint(const std::vector<BasicPoint<T>>& points)
 {
     double x = 0, y = 0;
     for (const auto& point : points) {
@@ -81,3 +55,16 @@ PointF midPoint(const std::vector<Point>& points)
     }
     return PointF(x / points.size(), y / points.size());
 }
+
+#define INSTANTIATE_POINT(T)                                          \
+    template class BasicPoint<T>;                                     \
+    template BasicPoint<T> getVector(const BasicPoint<T>&,            \
+                                     const BasicPoint<T>&);           \
+    template double cross(const BasicPoint<T>&, const BasicPoint<T>&, \
+                          const BasicPoint<T>&);                      \
+    template PointF midPoint(const std::vector<BasicPoint<T>>&);
+
+INSTANTIATE_POINT(int)
+INSTANTIATE_POINT(int64_t)
+INSTANTIATE_POINT(float)
+INSTANTIATE_POINT(double)
@@ -2,55 +2,84 @@
 #define POINT_H
 
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 #include <vector>
 
-class PointF;
+/**
+ * @brief whether every From value is exactly a To value, like int in double
+ */
+template <class From, class To>
+constexpr bool widens =
+    std::is_floating_point_v<To>
+        ? std::numeric_limits<To>::digits >= std::numeric_limits<From>::digits
+        : std::is_integral_v<From> && sizeof(To) >= sizeof(From);
 
-class Point
+/**
+ * @brief BasicPoint is a point with coordinates of type T
+ * points convert implicitly to types that hold them exactly, and otherwise
+ * only explicitly, rounding to the nearest integer for integer coordinates
+ */
+template <class T>
+class BasicPoint
 {
 public:
-    Point() = default;
-    Point(int x, int y);
-    Point(const Point& old) = default;
-    Point(const PointF& old);
-    ~Point() = default;
+    using value_type = T;
 
-    int x;
-    int y;
+    BasicPoint() = default;
+    BasicPoint(T x, T y);
+    BasicPoint(const BasicPoint& old) = default;
+    template <class U, std::enable_if_t<widens<U, T>, int> = 0>
+    BasicPoint(const BasicPoint<U>& old)
+        : x(old.x),
+          y(old.y)
+    {
+    }
+    template <class U, std::enable_if_t<!widens<U, T>, int> = 0>
+    explicit BasicPoint(const BasicPoint<U>& old)
+        : x(convert(old.x)),
+          y(convert(old.y))
+    {
+    }
+    ~BasicPoint() = default;
 
-    double distance(const Point& other) const;
+    T x;
+    T y;
 
-    explicit operator PointF() const;
-    bool operator()(const Point& lhs, const Point& rhs);
-    Point& operator=(const Point& rhs);
-    bool operator==(const Point& rhs) const;
-};
+    double distance(const BasicPoint& other) const;
 
-class PointF
-{
-public:
-    PointF() = default;
-    PointF(double x, double y);
-    PointF(const PointF& old) = default;
-    PointF(const Point& old);
-    ~PointF() = default;
-
-    double x;
-    double y;
-
-    double distance(const PointF& other) const;
+    bool operator()(const BasicPoint& lhs, const BasicPoint& rhs);
+    BasicPoint& operator=(const BasicPoint& rhs);
+    template <class U>
+    bool operator==(const BasicPoint<U>& rhs) const
+    {
+        return x == rhs.x && y == rhs.y;
+    }
 
-    explicit operator Point() const;
-    bool operator==(const Point& rhs) const;
+private:
+    template <class U>
+    static T convert(U value)
+    {
+        if constexpr (std::is_integral_v<T> && std::is_floating_point_v<U>)
+            return (T) std::llround(value);
+        else
+            return (T) value;
+    }
 };
 
+// sites of the default diagram and vertices computed from them
+using Point = BasicPoint<int>;
+using PointF = BasicPoint<double>;
+
 /**
  * @brief getVector calculates vector form a to b
  * @param a start point
  * @param b end point
  * @return a vector from a to b
  */
-Point getVector(const Point& a, const Point& b);
+template <class T>
+BasicPoint<T> getVector(const BasicPoint<T>& a, const BasicPoint<T>& b);
 
 /**
  * @brief cross calculates cross value of points a, b, o
@@ -59,7 +88,16 @@ Point getVector(const Point& a, const Point& b);
  * @param o
  * @return cross value of vector oa x ob
  */
-double cross(const Point& a, const Point& b, const Point& o);
-PointF midPoint(const std::vector<Point>& points);
+template <class T>
+double cross(const BasicPoint<T>& a,
+             const BasicPoint<T>& b,
+             const BasicPoint<T>& o);
+template <class T>
+PointF midPoint(const std::vector<BasicPoint<T>>& points);
+
+extern template class BasicPoint<int>;
+extern template class BasicPoint<int64_t>;
+extern template class BasicPoint<float>;
+extern template class BasicPoint<double>;
 
 #endif  // POINT_H
@@ -2,50 +2,58 @@
 
 #define PI (3.1415926535)
 
-Polygon::Polygon()
-	: organized(false)
+template <class Coord, class Real>
+BasicPolygon<Coord, Real>::BasicPolygon()
 {
 }
 
-Polygon::Polygon(const Polygon& old)
+template <class Coord, class Real>
+BasicPolygon<Coord, Real>::BasicPolygon(const BasicPolygon& old)
 {
 	this->edges = old.edges;
-	this->focus = Point(old.focus);
+	this->focus = old.focus;
 	// if old one is organized, since we are copying edges in order,
 	// new one must also been organized, vice versa.
 	this->organized = old.organized;
+	this->completeKnown = old.completeKnown;
+	this->complete = old.complete;
 }
 
-Polygon::Polygon(Point f)
+template <class Coord, class Real>
+BasicPolygon<Coord, Real>::BasicPolygon(Site f)
 {
 	this->focus = std::move(f);
 }
 
-Polygon::Polygon(double focusx, double focusy)
-	: focus(Point((int) focusx, (int) focusy))
+template <class Coord, class Real>
+BasicPolygon<Coord, Real>::BasicPolygon(double focusx, double focusy)
+	: focus(Site(PointF(focusx, focusy)))
 {
 }
 
-bool Polygon::contains(const Point& other)
+template <class Coord, class Real>
+bool BasicPolygon<Coord, Real>::contains(const Site& other)
 {
 	if (!organized)
 		organize();
 	if (!this->isComplete())
 		return false;
 	for (const auto& edge_ptr : edges) {
-		if (cross(*edge_ptr->a, *edge_ptr->b, other) < 0)
+		if (cross(*edge_ptr->a, *edge_ptr->b, Vertex(other)) < 0)
 			return false;
 	}
 	return true;
 }
 
-bool Polygon::contains(const int x, const int y)
+template <class Coord, class Real>
+bool BasicPolygon<Coord, Real>::contains(const Coord x, const Coord y)
 {
-	Point bar(x, y);
+	Site bar(x, y);
 	return contains(bar);
 }
 
-void Polygon::organize()
+template <class Coord, class Real>
+void BasicPolygon<Coord, Real>::organize()
 {
 	std::vector<double> edgeDegrees(edges.size());
 	for (size_t i = 0; i < edges.size(); i++) {
@@ -78,19 +86,40 @@ void Polygon::organize()
 	organized = true;
 }
 
-void Polygon::unOrganize()
+template <class Coord, class Real>
+void BasicPolygon<Coord, Real>::unOrganize()
 {
 	organized = false;
+	completeKnown = false;
 }
 
-bool Polygon::isComplete()
+template <class Coord, class Real>
+void BasicPolygon<Coord, Real>::markOrganized(bool complete)
 {
-	auto cmp = [](const Point& a, const Point& b) {
+	this->organized = true;
+	this->completeKnown = true;
+	this->complete = complete;
+}
+
+template <class Coord, class Real>
+bool BasicPolygon<Coord, Real>::isComplete()
+{
+	if (!completeKnown) {
+		complete = checkComplete();
+		completeKnown = true;
+	}
+	return complete;
+}
+
+template <class Coord, class Real>
+bool BasicPolygon<Coord, Real>::checkComplete() const
+{
+	auto cmp = [](const Vertex& a, const Vertex& b) {
 		if (a.x == b.x)
 			return a.y < b.y;
 		return a.x < b.x;
 	};
-	std::set<Point, decltype(cmp)> s(cmp);
+	std::set<Vertex, decltype(cmp)> s(cmp);
 	for (const auto& edge_ptr : edges) {
 		const Edge& cur = *edge_ptr;
 		// incomplete edge
@@ -110,7 +139,8 @@ bool Polygon::isComplete()
 	return s.size() == 0;
 }
 
-bool Polygon::operator==(const Polygon& other) const
+template <class Coord, class Real>
+bool BasicPolygon<Coord, Real>::operator==(const BasicPolygon& other) const
 {
 	if (!(this->focus == other.focus))
 		return false;
@@ -180,3 +210,8 @@ void pairsort(It1 first, It1 last, It2 pFirst, Comp comp)
 		*(pFirst++) = std::move(val.second);
 	}
 }
+
+template class BasicPolygon<int, double>;
+template class BasicPolygon<int, float>;
+template class BasicPolygon<double, double>;
+template class BasicPolygon<int64_t, double>;
@@ -1,39 +1,74 @@
 #ifndef POLYGON_H
 #define POLYGON_H
 
+#include <cstdint>
 #include <set>
 #include <vector>
 
 #include "edge.h"
 #include "point.h"
 
-class Edge;
-class Point;
-
-class Polygon
+/**
+ * @brief BasicPolygon is the cell of a site with Coord coordinates, bounded
+ * by edges between vertices with Real coordinates
+ */
+template <class Coord, class Real>
+class BasicPolygon
 {
 public:
-    Polygon();
-    Polygon(const Polygon& other);
-    Polygon(Point f);
-    Polygon(double focusx, double focusy);
-    ~Polygon() = default;
+    using Site = BasicPoint<Coord>;
+    using Vertex = BasicPoint<Real>;
+    using Edge = BasicEdge<Real>;
+
+    BasicPolygon();
+    BasicPolygon(const BasicPolygon& other);
+    BasicPolygon(Site f);
+    /**
+     * @brief focus at the site nearest to (focusx, focusy)
+     */
+    BasicPolygon(double focusx, double focusy);
+    ~BasicPolygon() = default;
 
     std::vector<std::shared_ptr<Edge>> edges;
-    Point focus;
+    Site focus;
 
-    bool contains(const Point& other);
-    bool contains(const int x, const int y);
+    bool contains(const Site& other);
+    bool contains(const Coord x, const Coord y);
+    /**
+     * @brief sort edges counter-clockwise around focus
+     */
     void organize();
     void unOrganize();
+    /**
+     * @brief mark edges as already being in counter-clockwise order, so that
+     * neither organize() nor the completeness check have to run
+     * @param complete whether edges form a closed boundary
+     */
+    void markOrganized(bool complete);
+    /**
+     * @brief whether edges form a closed boundary, the result is cached
+     * until unOrganize() is called
+     */
     bool isComplete();
 
-    bool operator==(const Polygon& other) const;
+    bool operator==(const BasicPolygon& other) const;
 
 private:
-    bool organized;
+    bool checkComplete() const;
+
+    bool organized = false;
+    // cached result of isComplete, only valid while completeKnown is set
+    bool completeKnown = false;
+    bool complete = false;
 };
 
+using Polygon = BasicPolygon<int, double>;
+
+extern template class BasicPolygon<int, double>;
+extern template class BasicPolygon<int, float>;
+extern template class BasicPolygon<double, double>;
+extern template class BasicPolygon<int64_t, double>;
+
 template <typename It1, typename It2>
 void pairsort(It1 first, It1 last, It2 pFirst);
 template <typename It1, typename It2, class Comp>
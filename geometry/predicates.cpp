@@ -0,0 +1,101 @@
+#include "predicates.h"
+
+#include <cmath>
+
+namespace
+{
+// bound on the relative rounding error of orientation's double evaluation,
+// see Shewchuk, Adaptive Precision Floating-Point Arithmetic and Fast Robust
+// Geometric Predicates
+const double epsilon = 0x1p-53;
+const double orientationErrorBound = (3 + 16 * epsilon) * epsilon;
+
+/**
+ * @brief sum + error == a + b exactly
+ */
+void twoSum(double a, double b, double& sum, double& error)
+{
+    sum = a + b;
+    double bVirtual = sum - a;
+    double aVirtual = sum - bVirtual;
+    error = (a - aVirtual) + (b - bVirtual);
+}
+
+/**
+ * @brief add b to the expansion e of n components, nonoverlapping and by
+ * increasing magnitude, whose exact sum stays the same
+ * @return number of components afterwards, zeros are dropped
+ */
+int growExpansion(double* e, int n, double b)
+{
+    int m = 0;
+    double q = b;
+    for (int i = 0; i < n; ++i) {
+        double error;
+        twoSum(q, e[i], q, error);
+        if (error != 0)
+            e[m++] = error;
+    }
+    if (q != 0)
+        e[m++] = q;
+    return m;
+}
+
+/**
+ * @brief add a * b to the expansion e exactly
+ */
+int addProduct(double* e, int n, double a, double b)
+{
+    const double product = a * b;
+    n = growExpansion(e, n, std::fma(a, b, -product));
+    return growExpansion(e, n, product);
+}
+
+/**
+ * @brief orientation summed exactly from the six products of coordinates it
+ * expands to, the sum of the components from the smallest on has the sign
+ * of the largest
+ */
+double exactOrientation(const PointF& a, const PointF& b, const PointF& c)
+{
+    double e[12];
+    int n = 0;
+    n = addProduct(e, n, b.x, c.y);
+    n = addProduct(e, n, -b.x, a.y);
+    n = addProduct(e, n, -a.x, c.y);
+    n = addProduct(e, n, -b.y, c.x);
+    n = addProduct(e, n, b.y, a.x);
+    n = addProduct(e, n, a.y, c.x);
+    double sum = 0;
+    for (int i = 0; i < n; ++i)
+        sum += e[i];
+    return sum;
+}
+}  // namespace
+
+double orientation(const PointF& a, const PointF& b, const PointF& c)
+{
+    const double left = (b.x - a.x) * (c.y - a.y);
+    const double right = (b.y - a.y) * (c.x - a.x);
+    const double det = left - right;
+    const double bound =
+        orientationErrorBound * (std::abs(left) + std::abs(right));
+    if (det > bound || -det > bound)
+        return det;
+    return exactOrientation(a, b, c);
+}
+
+PointF circumcenter(const PointF& a,
+                    const PointF& b,
+                    const PointF& c,
+                    double orientation)
+{
+    // relative to a, so that the squares stay small
+    const double bx = b.x - a.x, by = b.y - a.y;
+    const double cx = c.x - a.x, cy = c.y - a.y;
+    const double b2 = bx * bx + by * by;
+    const double c2 = cx * cx + cy * cy;
+    const double scale = 0.5 / orientation;
+    return PointF(a.x + (cy * b2 - by * c2) * scale,
+                  a.y + (bx * c2 - cx * b2) * scale);
+}
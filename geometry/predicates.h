@@ -0,0 +1,25 @@
+#ifndef PREDICATES_H
+#define PREDICATES_H
+
+#include "point.h"
+
+/**
+ * @brief twice the signed area of triangle a, b, c, positive if it turns
+ * counter-clockwise in y-up coordinates and 0 if the points are collinear
+ * the sign is exact for any coordinates, as long as no product of two of
+ * them overflows or underflows. Like Shewchuk's orient2d, the value is
+ * computed in double first, and only if it's within its rounding error of
+ * 0 it's computed again exactly
+ */
+double orientation(const PointF& a, const PointF& b, const PointF& c);
+
+/**
+ * @brief center of the circle through a, b and c
+ * @param orientation orientation(a, b, c), which must not be 0
+ */
+PointF circumcenter(const PointF& a,
+                    const PointF& b,
+                    const PointF& c,
+                    double orientation);
+
+#endif  // PREDICATES_H
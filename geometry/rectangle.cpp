@@ -1,6 +1,7 @@
 #include "rectangle.h"
 
-Rectangle::Rectangle()
+template <class T>
+BasicRectangle<T>::BasicRectangle()
     : x(0),
       y(0),
       width(0),
@@ -8,7 +9,8 @@ Rectangle::Rectangle()
 {
 }
 
-Rectangle::Rectangle(int x, int y, int width, int height)
+template <class T>
+BasicRectangle<T>::BasicRectangle(T x, T y, T width, T height)
     : x(x),
       y(y),
       width(width),
@@ -16,7 +18,8 @@ Rectangle::Rectangle(int x, int y, int width, int height)
 {
 }
 
-bool Rectangle::contains(int x, int y) const
+template <class T>
+bool BasicRectangle<T>::contains(T x, T y) const
 {
     if (x > this->x && x < this->getRight()) {
         if (y > this->y && y < this->getBottom()) {
@@ -26,12 +29,19 @@ bool Rectangle::contains(int x, int y) const
     return false;
 }
 
-int Rectangle::getRight() const
+template <class T>
+T BasicRectangle<T>::getRight() const
 {
     return x + width;
 }
 
-int Rectangle::getBottom() const
+template <class T>
+T BasicRectangle<T>::getBottom() const
 {
     return y + height;
 }
+
+template class BasicRectangle<int>;
+template class BasicRectangle<int64_t>;
+template class BasicRectangle<float>;
+template class BasicRectangle<double>;
@@ -1,20 +1,29 @@
 #ifndef RECTANGLE_H
 #define RECTANGLE_H
 
+#include <cstdint>
 
-class Rectangle
+template <class T>
+class BasicRectangle
 {
 public:
-    Rectangle();
-    Rectangle(int x, int y, int width, int height);
-    ~Rectangle() = default;
+    BasicRectangle();
+    BasicRectangle(T x, T y, T width, T height);
+    ~BasicRectangle() = default;
 
-    int x, y;
-    int width, height;
+    T x, y;
+    T width, height;
 
-    bool contains(int x, int y) const;
-    int getRight() const;
-    int getBottom() const;
+    bool contains(T x, T y) const;
+    T getRight() const;
+    T getBottom() const;
 };
 
+using Rectangle = BasicRectangle<int>;
+
+extern template class BasicRectangle<int>;
+extern template class BasicRectangle<int64_t>;
+extern template class BasicRectangle<float>;
+extern template class BasicRectangle<double>;
+
 #endif  // RECTANGLE_H
@@ -0,0 +1,41 @@
+#include "segmentclipper.h"
+
+#include <algorithm>
+#include <limits>
+
+template <class T>
+void clipSegments(const BasicRectangle<T>& rect,
+                  size_t count,
+                  const double* __restrict x0,
+                  const double* __restrict y0,
+                  const double* __restrict x1,
+                  const double* __restrict y1,
+                  double* __restrict t0,
+                  double* __restrict t1)
+{
+    const double left = rect.x, right = rect.getRight();
+    const double top = rect.y, bottom = rect.getBottom();
+    // a segment parallel to an axis divides by the smallest double instead,
+    // which puts its slab crossings at +-infinity if it's inside the slab and
+    // on one side of 0 otherwise, so it needs no branch of its own
+    const double tiny = std::numeric_limits<double>::denorm_min();
+    for (size_t i = 0; i < count; ++i) {
+        double dx = x1[i] - x0[i];
+        double dy = y1[i] - y0[i];
+        dx = dx != 0 ? dx : tiny;
+        dy = dy != 0 ? dy : tiny;
+        const double ax = (left - x0[i]) / dx, bx = (right - x0[i]) / dx;
+        const double ay = (top - y0[i]) / dy, by = (bottom - y0[i]) / dy;
+        t0[i] = std::max(std::max(std::min(ax, bx), std::min(ay, by)), 0.0);
+        t1[i] = std::min(std::min(std::max(ax, bx), std::max(ay, by)), 1.0);
+    }
+}
+
+#define INSTANTIATE_CLIP_SEGMENTS(T)                                        \
+    template void clipSegments(const BasicRectangle<T>&, size_t,            \
+                               const double*, const double*, const double*, \
+                               const double*, double*, double*);
+
+INSTANTIATE_CLIP_SEGMENTS(int)
+INSTANTIATE_CLIP_SEGMENTS(int64_t)
+INSTANTIATE_CLIP_SEGMENTS(double)
@@ -0,0 +1,27 @@
+#ifndef SEGMENTCLIPPER_H
+#define SEGMENTCLIPPER_H
+
+#include <cstddef>
+
+#include "rectangle.h"
+
+/**
+ * @brief clip line segments to a rectangle by Liang-Barsky, in batch
+ * segments are given as arrays of coordinates, segment i goes from
+ * (x0[i], y0[i]) to (x1[i], y1[i]). The loop is branch free so that the
+ * compiler can vectorize it.
+ * @param t0 out, parameter where segment i enters rect
+ * @param t1 out, parameter where segment i leaves rect, the part inside rect
+ * is empty if t0[i] > t1[i]
+ */
+template <class T>
+void clipSegments(const BasicRectangle<T>& rect,
+                  size_t count,
+                  const double* x0,
+                  const double* y0,
+                  const double* x1,
+                  const double* y1,
+                  double* t0,
+                  double* t1);
+
+#endif  // SEGMENTCLIPPER_H
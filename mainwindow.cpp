@@ -8,10 +8,19 @@ MainWindow::MainWindow(QWidget* parent)
     ui->setupUi(this);
 
     ui->graphicsView->setBackgroundBrush(QBrush(QColor(135, 206, 235)));
+
+    // ready is called on the worker's thread, the diagram is published on
+    // this one
+    worker = std::make_unique<SweepWorker>([this] {
+        QMetaObject::invokeMethod(
+            this, [this] { publishSweep(); }, Qt::QueuedConnection);
+    });
 }
 
 MainWindow::~MainWindow()
 {
+    // stop the worker before anything it calls back into is gone
+    worker.reset();
     delete ui;
 }
 
@@ -24,51 +33,82 @@ void MainWindow::on_actionNew_Map_triggered()
     vmap = std::make_shared<Voronoi>(nmd.size.width(), nmd.size.height());
     vmapContext = std::make_unique<QObject>();
     sl.reset();
+    worker->cancel();
+    sweepPending = false;
+    diagramCurrent = false;
+    lines.clear();
+    changedCells.clear();
     ui->graphicsView->setScene(scene.get());
     ui->graphicsView->fitInView(scene->sceneRect(), Qt::KeepAspectRatio);
 
     std::weak_ptr<Voronoi> weak_vmap = vmap;
+    // sites of the scene and polygons of vmap share their indices, while the
+    // diagram is shown and up to date, edits only sweep the cells around
+    // them again, otherwise they wait for the next full sweep, which the
+    // worker starts over after every edit. An edit whose cells can't be
+    // swept alone leaves that to the worker too. A step-by-step sweep refers
+    // to polygons by their index, every edit starts it over
+    scene->lineLayer->setLines(&lines);
     connect(scene.get(), &ClickGraphicsScene::pointAdded, vmapContext.get(),
-            [weak_vmap](MyQGraphicsEllipseItem* e) {
+            [this, weak_vmap](uint32_t site) {
                 std::shared_ptr<Voronoi> vmap = weak_vmap.lock();
                 if (!vmap)
                     return;
-                auto newPoly = vmap->addPoly(Polygon(e->x(), e->y()));
-                std::weak_ptr<Polygon> tmp = *newPoly;
-                e->relatedObjects.push_back(tmp);
+                sl.reset();
+                const QPointF& pos = scene->siteLayer->site(site);
+                Point focus(PointF(pos.x(), pos.y()));
+                if (autoFortune && diagramCurrent) {
+                    cellsChanged(vmap->tryInsertSite(focus));
+                } else {
+                    vmap->addPoly(Polygon(focus));
+                    diagramCurrent = false;
+                    sweepPending = false;
+                }
             });
     connect(scene.get(), &ClickGraphicsScene::pointMoved, vmapContext.get(),
-            [](MyQGraphicsEllipseItem* e) {
-                for (const std::any& obj : e->relatedObjects) {
-                    if (obj.type() != typeid(std::weak_ptr<Polygon>))
-                        continue;
-                    auto weak_poly = std::any_cast<std::weak_ptr<Polygon>>(obj);
-                    std::shared_ptr<Polygon> poly = weak_poly.lock();
-                    if (!poly)
-                        continue;
-                    Point focus(e->x(), e->y());
-                    poly->focus = focus;
+            [this, weak_vmap](uint32_t site) {
+                std::shared_ptr<Voronoi> vmap = weak_vmap.lock();
+                if (!vmap || site >= vmap->polygons.size())
+                    return;
+                sl.reset();
+                const QPointF& pos = scene->siteLayer->site(site);
+                Point focus(PointF(pos.x(), pos.y()));
+                if (vmap->polygons[site]->focus == focus)
+                    return;
+                if (autoFortune && diagramCurrent) {
+                    cellsChanged(vmap->tryMoveSite(site, focus));
+                } else {
+                    vmap->polygons[site]->focus = focus;
+                    diagramCurrent = false;
+                    sweepPending = false;
                 }
             });
     connect(scene.get(), &ClickGraphicsScene::pointRemoved, vmapContext.get(),
-            [weak_vmap](MyQGraphicsEllipseItem* e) {
+            [this, weak_vmap](uint32_t site) {
                 std::shared_ptr<Voronoi> vmap = weak_vmap.lock();
-                if (!vmap)
+                if (!vmap || site >= vmap->polygons.size())
                     return;
-                for (const std::any& obj : e->relatedObjects) {
-                    if (obj.type() != typeid(std::weak_ptr<Polygon>))
-                        continue;
-                    auto weak_poly = std::any_cast<std::weak_ptr<Polygon>>(obj);
-                    std::shared_ptr<Polygon> poly = weak_poly.lock();
-                    if (!poly)
-                        continue;
-                    vmap->erasePoly(poly);
+                sl.reset();
+                // the polygon is freed below, its address may be reused
+                lines.erase(vmap->polygons[site].get());
+                if (autoFortune && diagramCurrent) {
+                    cellsChanged(vmap->tryEraseSite(site));
+                } else {
+                    // like eraseSite, the last polygon takes its place
+                    vmap->polygons[site] = std::move(vmap->polygons.back());
+                    vmap->polygons.pop_back();
+                    diagramCurrent = false;
+                    sweepPending = false;
                 }
             });
 
     auto autoPerform = [this]() {
-        if (autoFortune)
-            performAndSyncScene();
+        if (!autoFortune)
+            return;
+        if (diagramCurrent)
+            syncLines(false);
+        else
+            requestSweep();
     };
     connect(scene.get(), &ClickGraphicsScene::pointAdded, this, autoPerform);
     connect(scene.get(), &ClickGraphicsScene::pointMoved, this, autoPerform);
@@ -88,63 +128,88 @@ void MainWindow::on_actionToggle_T_toggled(bool arg1)
 {
     autoFortune = arg1;
     if (arg1) {
-        performAndSyncScene();
+        requestSweep();
+    } else {
+        worker->cancel();
+        sweepPending = false;
     }
 }
 
-void MainWindow::performAndSyncScene()
+void MainWindow::requestSweep()
 {
-    if (!vmap)
+    if (!vmap || diagramCurrent || sweepPending)
         return;
-    if (!sl)
-        sl = std::make_shared<SweepLine>();
-
-    sl->loadVmap(vmap);
-    sl->performFortune();
+    // the worker sweeps a copy, so edits don't wait for it to finish
+    std::vector<Point> sites;
+    sites.reserve(vmap->polygons.size());
+    for (const auto& poly : vmap->polygons)
+        sites.push_back(poly->focus);
+    worker->request(std::move(sites), vmap->width, vmap->height);
+    sweepPending = true;
+}
 
-    for (const auto& line : scene->lineItems) {
-        scene->removeItem(line.get());
-    }
-    scene->lineItems.clear();
-    for (const auto& poly_sptr : sl->vmap->polygons) {
-        for (const auto& edge_sptr : poly_sptr->edges) {
-            const Edge& edge = *edge_sptr;
-            if (*edge.a == *edge.b)
-                continue;
-            auto line = std::make_shared<QGraphicsLineItem>(
-                edge.a->x, edge.a->y, edge.b->x, edge.b->y);
-            scene->addItem(line.get());
-            scene->lineItems.push_back(line);
-        }
+void MainWindow::publishSweep()
+{
+    std::unique_ptr<SweepWorker::Result> swept = worker->take();
+    // null if an edit superseded it after ready was called
+    if (!swept)
+        return;
+    if (!vmap || !sweepPending) {
+        worker->dispose(std::move(swept));
+        return;
     }
+    // the diagram and its segments are swapped in at once, its polygons are
+    // in the order of the sites, and the old ones are freed by the worker
+    std::swap(*vmap, *swept->vmap);
+    std::swap(lines, swept->lines);
+    worker->dispose(std::move(swept));
+    changedCells.clear();
+    // the step-by-step sweep can't go on with a diagram it didn't build
+    sl.reset();
+    sweepPending = false;
+    diagramCurrent = true;
+    scene->lineLayer->setLines(&lines);
 }
 
 void MainWindow::stepAndSyncScene()
 {
     if (!vmap)
         return;
+    worker->cancel();
+    sweepPending = false;
     if (!sl)
         sl = std::make_shared<SweepLine>(vmap);
 
+    if (sl->edgesFinished)
+        return;
     double L = sl->nextEvent();
     if (L == sl->LMAXVALUE)
         sl->finishEdges();
+    vmap->syncPolygons();
+    diagramCurrent = false;
+    syncLines(true);
+}
 
-    for (const auto& line : scene->lineItems) {
-        scene->removeItem(line.get());
-    }
-    scene->lineItems.clear();
-    for (const auto& poly_sptr : sl->vmap->polygons) {
-        for (const auto& edge_sptr : poly_sptr->edges) {
-            const Edge& edge = *edge_sptr;
-            if (!(edge.a && edge.b))
-                continue;
-            auto line = std::make_shared<QGraphicsLineItem>(
-                edge.a->x, edge.a->y, edge.b->x, edge.b->y);
-            scene->addItem(line.get());
-            scene->lineItems.push_back(line);
-        }
+void MainWindow::cellsChanged(
+    const std::optional<std::vector<size_t>>& polygons)
+{
+    if (!polygons) {
+        diagramCurrent = false;
+        return;
     }
+    for (size_t polygon : *polygons)
+        changedCells.push_back(vmap->polygons[polygon].get());
+}
+
+void MainWindow::syncLines(bool swept)
+{
+    if (swept)
+        lines.update(*vmap);
+    else
+        lines.update(changedCells);
+    changedCells.clear();
+
+    scene->lineLayer->linesUpdated(swept);
 }
 
 void MainWindow::on_actionStep_N_triggered()
@@ -7,7 +7,9 @@
 #include "dialog/newmap/newmapdialog.h"
 #include "geometry/point.h"
 #include "mywidget/clickgraphicsscene.h"
+#include "voronoi/diagramlines.h"
 #include "voronoi/sweepline.h"
+#include "voronoi/sweepworker.h"
 #include "voronoi/voronoi.h"
 
 QT_BEGIN_NAMESPACE
@@ -39,9 +41,38 @@ private:
     std::unique_ptr<QObject> vmapContext;
     std::shared_ptr<SweepLine> sl;
     bool autoFortune = false;
+    // whether vmap's diagram is the finished sweep of its current polygons
+    bool diagramCurrent = false;
+    // full sweeps run on worker, sweepPending while it's sweeping vmap's
+    // current sites
+    std::unique_ptr<SweepWorker> worker;
+    bool sweepPending = false;
+    // segments drawn by scene->lineLayer, and the cells the incremental
+    // updates changed since they were last drawn
+    DiagramLines lines;
+    std::vector<const Polygon*> changedCells;
 
-    void performAndSyncScene();
+    /**
+     * @brief hand vmap's sites to the worker, unless its diagram is current
+     * or being swept already
+     */
+    void requestSweep();
+    /**
+     * @brief replace vmap with the worker's diagram, if it's still the one
+     * of vmap's sites
+     */
+    void publishSweep();
     void stepAndSyncScene();
+    /**
+     * @brief queue the cells of polygons an incremental update changed, or
+     * leave the diagram to the worker if the update gave up
+     */
+    void cellsChanged(const std::optional<std::vector<size_t>>& polygons);
+    /**
+     * @brief redraw the edges of the changed cells, or of every polygon
+     * after a sweep
+     */
+    void syncLines(bool swept);
 
     // QWidget interface
 protected:
@@ -13,59 +13,62 @@ ClickGraphicsScene::ClickGraphicsScene(const QSize& size)
     this->setSceneRect(0, 0, size.width(), size.height());
     mapCanvasItem.reset(this->addPixmap(*mapCanvas));
     mapCanvasItem->setZValue(-10000);
+
+    // the layers cull to the exposed rectangle themselves, an index of a
+    // few items isn't worth keeping up to date
+    this->setItemIndexMethod(QGraphicsScene::NoIndex);
+    const QRectF rect = this->sceneRect();
+    lineLayer = std::make_unique<LineLayer>(rect);
+    this->addItem(lineLayer.get());
+    siteLayer = std::make_unique<SiteLayer>(rect);
+    siteLayer->setZValue(1);
+    this->addItem(siteLayer.get());
 }
 
 void ClickGraphicsScene::addPoint(const QPointF& pos)
 {
-    if (!this->sceneRect().contains(pos))
+    if (!siteLayer || !this->sceneRect().contains(pos))
         return;
-    auto item =
-        std::make_shared<MyQGraphicsEllipseItem>(pos.x(), pos.y(), 5, 5);
-    item->setPos(item->pos());
-    this->addItem(item.get());
-    ellipseItems.push_back(item);
-    emit pointAdded(item.get());
+    emit pointAdded(siteLayer->add(pos));
 }
 
 void ClickGraphicsScene::mousePressEvent(QGraphicsSceneMouseEvent* event)
 {
-    auto tmp = this->itemAt(event->scenePos(), QTransform());
-    auto item = dynamic_cast<MyQGraphicsEllipseItem*>(tmp);
+    if (!siteLayer)
+        return;
+    const SiteLayer::index site = siteLayer->siteAt(event->scenePos());
     if (event->button() == Qt::LeftButton) {
-        if (item != nullptr) {
+        if (site != SiteLayer::npos) {
             MousePrevPoint = event->scenePos();
-            draggedObj = item;
+            draggedSite = site;
         } else {
             this->addPoint(event->scenePos());
         }
     } else if (event->button() == Qt::RightButton) {
-        if (item == nullptr || draggedObj)
+        if (site == SiteLayer::npos || draggedSite != SiteLayer::npos)
             return;
-        this->removeItem(item);
-        emit pointRemoved(item);
-        ellipseItems.erase(
-            std::find_if(ellipseItems.cbegin(), ellipseItems.cend(),
-                         [&item](const auto& a) { return a.get() == item; }));
+        // the last site takes the erased one's index after the signal
+        emit pointRemoved(site);
+        siteLayer->erase(site);
     }
-    //    qDebug("point cnt:%lld", ellipseItems.size());
 }
 
 void ClickGraphicsScene::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
 {
-    if (draggedObj != nullptr) {
-        QPointF newPos =
-            draggedObj->pos() + (event->scenePos() - MousePrevPoint);
+    if (draggedSite != SiteLayer::npos) {
+        QPointF newPos = siteLayer->site(draggedSite) +
+                         (event->scenePos() - MousePrevPoint);
         if (this->sceneRect().contains(newPos)) {
-            draggedObj->setPos(newPos.x(), newPos.y());
+            siteLayer->move(draggedSite, newPos);
         }
         MousePrevPoint = event->scenePos();
-        emit pointMoved(draggedObj);
+        emit pointMoved(draggedSite);
     }
 }
 
 void ClickGraphicsScene::mouseReleaseEvent(QGraphicsSceneMouseEvent*)
 {
-    draggedObj = nullptr;
+    draggedSite = SiteLayer::npos;
     MousePrevPoint.setX(0);
     MousePrevPoint.setY(0);
 }
@@ -7,7 +7,8 @@
 
 #include <QDebug>
 
-#include "myqgraphicsellipseitem.h"
+#include "linelayer.h"
+#include "sitelayer.h"
 
 class ClickGraphicsScene : public QGraphicsScene
 {
@@ -17,16 +18,18 @@ public:
     ClickGraphicsScene(const QSize& size);
 
     std::unique_ptr<QPixmap> mapCanvas;
-    std::vector<std::shared_ptr<MyQGraphicsEllipseItem>> ellipseItems;
-    std::vector<std::shared_ptr<QGraphicsLineItem>> lineItems;
+    // every site and every edge of the diagram, each drawn by one item
+    std::unique_ptr<SiteLayer> siteLayer;
+    std::unique_ptr<LineLayer> lineLayer;
     std::vector<std::shared_ptr<QGraphicsItem>> assistantItems;
 
     void addPoint(const QPointF& pos);
 
 signals:
-    void pointAdded(MyQGraphicsEllipseItem*);
-    void pointMoved(MyQGraphicsEllipseItem*);
-    void pointRemoved(MyQGraphicsEllipseItem*);
+    // sites are identified by their index in siteLayer
+    void pointAdded(uint32_t site);
+    void pointMoved(uint32_t site);
+    void pointRemoved(uint32_t site);
 
 protected:
     void mousePressEvent(QGraphicsSceneMouseEvent* event);
@@ -36,7 +39,7 @@ protected:
 private:
     std::unique_ptr<QGraphicsPixmapItem> mapCanvasItem;
     QPointF MousePrevPoint;
-    MyQGraphicsEllipseItem* draggedObj = nullptr;
+    SiteLayer::index draggedSite = SiteLayer::npos;
 };
 
 #endif  // CLICKGRAPHICSSCENE_H
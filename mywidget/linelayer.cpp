@@ -0,0 +1,169 @@
+#include "linelayer.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+#include <algorithm>
+#include <cmath>
+
+#include "geometry/segmentclipper.h"
+
+LineLayer::LineLayer(const QRectF& rect, QGraphicsItem* parent)
+    : QGraphicsItem(parent),
+      rect(rect),
+      cellSize(std::max(10.0, std::sqrt(rect.width() * rect.height() /
+                                        (1 << 18))))
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    grid.reset(rect.x(), rect.y(), rect.width(), rect.height(), cellSize);
+}
+
+QRectF LineLayer::boundingRect() const
+{
+    return rect;
+}
+
+void LineLayer::paint(QPainter* painter,
+                      const QStyleOptionGraphicsItem* option,
+                      QWidget*)
+{
+    if (!lines)
+        return;
+    // a little wider, so that lines along the exposed border are drawn
+    const QRectF exposed =
+        (option->exposedRect & rect).adjusted(-1, -1, 1, 1);
+    x0.clear();
+    y0.clear();
+    x1.clear();
+    y1.clear();
+    auto cull = [&](DiagramLines::index slot) {
+        // segments go from left to right
+        const DiagramLines::Segment& segment = lines->segments[slot];
+        if (segment.b.x < exposed.left() || segment.a.x > exposed.right() ||
+            std::max(segment.a.y, segment.b.y) < exposed.top() ||
+            std::min(segment.a.y, segment.b.y) > exposed.bottom())
+            return;
+        x0.push_back(segment.a.x);
+        y0.push_back(segment.a.y);
+        x1.push_back(segment.b.x);
+        y1.push_back(segment.b.y);
+    };
+    if (exposed.width() * exposed.height() >
+        rect.width() * rect.height() / 4) {
+        // most segments are exposed, going through them in order is faster
+        for (DiagramLines::index slot = 0; slot < inserted.size(); ++slot) {
+            if (inserted[slot])
+                cull(slot);
+        }
+    } else {
+        // a segment in the grid reaches at most cellSize beyond its midpoint
+        grid.forEach(exposed.left() - cellSize, exposed.top() - cellSize,
+                     exposed.right() + cellSize, exposed.bottom() + cellSize,
+                     cull);
+        for (DiagramLines::index slot : longSlots)
+            cull(slot);
+    }
+
+    // vertices of an unfinished sweep can be far off, clipping keeps the
+    // painter from rasterizing huge lines
+    const size_t count = x0.size();
+    t0.resize(count);
+    t1.resize(count);
+    clipSegments(BasicRectangle<double>(exposed.x(), exposed.y(),
+                                        exposed.width(), exposed.height()),
+                 count, x0.data(), y0.data(), x1.data(), y1.data(), t0.data(),
+                 t1.data());
+    visible.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (!(t0[i] <= t1[i]))
+            continue;
+        const double dx = x1[i] - x0[i], dy = y1[i] - y0[i];
+        visible.emplace_back(x0[i] + t0[i] * dx, y0[i] + t0[i] * dy,
+                             x0[i] + t1[i] * dx, y0[i] + t1[i] * dy);
+    }
+    painter->setPen(QPen());
+    painter->drawLines(visible.data(), (int) visible.size());
+}
+
+void LineLayer::setLines(const DiagramLines* lines)
+{
+    this->lines = lines;
+    grid.reset(rect.x(), rect.y(), rect.width(), rect.height(), cellSize);
+    longSlots.clear();
+    inserted.clear();
+    if (lines) {
+        for (DiagramLines::index slot = 0; slot < lines->slotCount(); ++slot) {
+            if (lines->inUse(slot))
+                insert(slot);
+        }
+    }
+    update();
+}
+
+void LineLayer::linesUpdated(bool everything)
+{
+    if (!lines)
+        return;
+    // removed slots still hold the segment they had
+    for (DiagramLines::index slot : lines->removed)
+        erase(slot);
+    for (DiagramLines::index slot : lines->added)
+        insert(slot);
+    if (everything) {
+        update();
+        return;
+    }
+    // an edit changes the cells around it, one rectangle covers them
+    QRectF dirty;
+    for (const auto* changed : {&lines->added, &lines->removed}) {
+        for (DiagramLines::index slot : *changed) {
+            const DiagramLines::Segment& segment = lines->segments[slot];
+            dirty |= QRectF(QPointF(segment.a.x, segment.a.y),
+                            QPointF(segment.b.x, segment.b.y))
+                         .normalized();
+        }
+    }
+    if (!dirty.isNull())
+        update(dirty.adjusted(-1, -1, 1, 1));
+}
+
+void LineLayer::insert(DiagramLines::index slot)
+{
+    if (inserted.size() <= slot)
+        inserted.resize(lines->slotCount());
+    if (inserted[slot])
+        return;
+    inserted[slot] = true;
+    const DiagramLines::Segment& segment = lines->segments[slot];
+    if (isLong(segment)) {
+        longSlots.push_back(slot);
+        return;
+    }
+    grid.insert(slot, (segment.a.x + segment.b.x) / 2,
+                (segment.a.y + segment.b.y) / 2);
+}
+
+void LineLayer::erase(DiagramLines::index slot)
+{
+    if (slot >= inserted.size() || !inserted[slot])
+        return;
+    inserted[slot] = false;
+    const DiagramLines::Segment& segment = lines->segments[slot];
+    if (isLong(segment)) {
+        auto it = std::find(longSlots.begin(), longSlots.end(), slot);
+        if (it != longSlots.end()) {
+            *it = longSlots.back();
+            longSlots.pop_back();
+        }
+        return;
+    }
+    grid.erase(slot, (segment.a.x + segment.b.x) / 2,
+               (segment.a.y + segment.b.y) / 2);
+}
+
+bool LineLayer::isLong(const DiagramLines::Segment& segment) const
+{
+    // !(a <= b) also catches NaN of vertices at infinity
+    return !(std::abs(segment.b.x - segment.a.x) <= 2 * cellSize &&
+             std::abs(segment.b.y - segment.a.y) <= 2 * cellSize);
+}
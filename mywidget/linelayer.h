@@ -0,0 +1,62 @@
+#ifndef LINELAYER_H
+#define LINELAYER_H
+
+#include <QGraphicsItem>
+#include <QLineF>
+#include <QRectF>
+
+#include <vector>
+
+#include "data_structure/uniformgrid.h"
+#include "voronoi/diagramlines.h"
+
+/**
+ * @brief LineLayer draws the segments of a DiagramLines, culled and clipped
+ * to the exposed rectangle and handed to the painter in one call, instead of
+ * an item per segment. Segments are found through a uniform grid holding
+ * them at their midpoint, those longer than its cells are checked one by
+ * one.
+ */
+class LineLayer : public QGraphicsItem
+{
+public:
+    LineLayer(const QRectF& rect, QGraphicsItem* parent = nullptr);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter,
+               const QStyleOptionGraphicsItem* option,
+               QWidget* widget = nullptr) override;
+
+    /**
+     * @brief draw the segments of lines, which has to stay alive while the
+     * layer is shown, nullptr for none
+     */
+    void setLines(const DiagramLines* lines);
+    /**
+     * @brief take what the last update of lines added and removed, has to be
+     * called after every update, and repaint there or everything after a
+     * sweep
+     */
+    void linesUpdated(bool everything);
+
+private:
+    QRectF rect;
+    const DiagramLines* lines = nullptr;
+    double cellSize;
+    UniformGrid grid;
+    std::vector<DiagramLines::index> longSlots;
+    // whether every slot is in grid or longSlots
+    std::vector<bool> inserted;
+    // segments of the last paint, kept to reuse their memory
+    std::vector<double> x0, y0, x1, y1, t0, t1;
+    std::vector<QLineF> visible;
+
+    void insert(DiagramLines::index slot);
+    void erase(DiagramLines::index slot);
+    /**
+     * @brief whether segment is in longSlots instead of the grid
+     */
+    bool isLong(const DiagramLines::Segment& segment) const;
+};
+
+#endif  // LINELAYER_H
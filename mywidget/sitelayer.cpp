@@ -0,0 +1,104 @@
+#include "sitelayer.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+#include <cmath>
+
+SiteLayer::SiteLayer(const QRectF& rect, double dotSize, QGraphicsItem* parent)
+    : QGraphicsItem(parent),
+      rect(rect),
+      dotSize(dotSize)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    // about 2^18 cells at most, and a dot overlaps at most four of them
+    const double cellSize = std::max(
+        2 * dotSize, std::sqrt(rect.width() * rect.height() / (1 << 18)));
+    grid.reset(rect.x(), rect.y(), rect.width(), rect.height(), cellSize);
+}
+
+QRectF SiteLayer::boundingRect() const
+{
+    const double r = dotSize / 2;
+    return rect.adjusted(-r, -r, r, r);
+}
+
+void SiteLayer::paint(QPainter* painter,
+                      const QStyleOptionGraphicsItem* option,
+                      QWidget*)
+{
+    const double r = dotSize / 2;
+    const QRectF exposed = option->exposedRect.adjusted(-r, -r, r, r);
+    dots.clear();
+    grid.forEach(exposed.left(), exposed.top(), exposed.right(),
+                 exposed.bottom(), [&](index i) {
+                     if (exposed.contains(sites[i]))
+                         dots.push_back(dotRect(sites[i]));
+                 });
+    painter->setPen(QPen());
+    painter->setBrush(Qt::black);
+    // dots a few pixels wide look the same as squares, which are drawn in
+    // one call
+    const double lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(
+        painter->worldTransform());
+    if (dotSize * lod < 3) {
+        painter->drawRects(dots.data(), (int) dots.size());
+        return;
+    }
+    for (const QRectF& dot : dots)
+        painter->drawEllipse(dot);
+}
+
+SiteLayer::index SiteLayer::add(const QPointF& pos)
+{
+    const index i = (index) sites.size();
+    sites.push_back(pos);
+    grid.insert(i, pos.x(), pos.y());
+    update(dotRect(pos));
+    return i;
+}
+
+void SiteLayer::move(index i, const QPointF& pos)
+{
+    QPointF& site = sites[i];
+    update(dotRect(site));
+    grid.move(i, site.x(), site.y(), pos.x(), pos.y());
+    site = pos;
+    update(dotRect(pos));
+}
+
+void SiteLayer::erase(index i)
+{
+    update(dotRect(sites[i]));
+    grid.erase(i, sites[i].x(), sites[i].y());
+    const index last = (index) sites.size() - 1;
+    if (i != last) {
+        grid.rename(last, i, sites[last].x(), sites[last].y());
+        sites[i] = sites[last];
+    }
+    sites.pop_back();
+}
+
+SiteLayer::index SiteLayer::siteAt(const QPointF& pos) const
+{
+    const double r = dotSize / 2;
+    index nearest = npos;
+    double nearestDistance = r * r;
+    grid.forEach(pos.x() - r, pos.y() - r, pos.x() + r, pos.y() + r,
+                 [&](index i) {
+                     const double dx = sites[i].x() - pos.x();
+                     const double dy = sites[i].y() - pos.y();
+                     const double distance = dx * dx + dy * dy;
+                     if (distance <= nearestDistance) {
+                         nearest = i;
+                         nearestDistance = distance;
+                     }
+                 });
+    return nearest;
+}
+
+QRectF SiteLayer::dotRect(const QPointF& pos) const
+{
+    const double r = dotSize / 2;
+    return QRectF(pos.x() - r, pos.y() - r, dotSize, dotSize);
+}
@@ -0,0 +1,60 @@
+#ifndef SITELAYER_H
+#define SITELAYER_H
+
+#include <QGraphicsItem>
+#include <QPointF>
+#include <QRectF>
+
+#include <limits>
+#include <vector>
+
+#include "data_structure/uniformgrid.h"
+
+/**
+ * @brief SiteLayer draws every site of the map as a dot from one array of
+ * positions, instead of an item per site, and only the sites in the exposed
+ * rectangle. Sites are found through a uniform grid.
+ *
+ * A site is identified by its index. Erasing a site moves the last one into
+ * its place like Voronoi::eraseSite does with polygons, so that ids stay
+ * equal to polygon indices.
+ */
+class SiteLayer : public QGraphicsItem
+{
+public:
+    using index = UniformGrid::id;
+    static constexpr index npos = std::numeric_limits<index>::max();
+
+    SiteLayer(const QRectF& rect,
+              double dotSize = 5,
+              QGraphicsItem* parent = nullptr);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter,
+               const QStyleOptionGraphicsItem* option,
+               QWidget* widget = nullptr) override;
+
+    std::size_t size() const { return sites.size(); }
+    const QPointF& site(index i) const { return sites[i]; }
+
+    index add(const QPointF& pos);
+    void move(index i, const QPointF& pos);
+    void erase(index i);
+    /**
+     * @brief site whose dot contains pos, the nearest one where dots
+     * overlap, npos if there's none
+     */
+    index siteAt(const QPointF& pos) const;
+
+private:
+    QRectF rect;
+    double dotSize;
+    std::vector<QPointF> sites;
+    UniformGrid grid;
+    // dots of the last paint, kept to reuse their memory
+    std::vector<QRectF> dots;
+
+    QRectF dotRect(const QPointF& pos) const;
+};
+
+#endif  // SITELAYER_H
@@ -0,0 +1,32 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <functional>
+
+/**
+ * @brief a test is a function registered by TEST, which reports what it
+ * finds with CHECK. A failed check is printed with its location and the
+ * test goes on, the runner exits with 1 if any check failed.
+ */
+#define TEST(name)                                   \
+    static void name();                              \
+    static const TestRegistration name##Registration( \
+        #name, name);                                \
+    static void name()
+
+#define CHECK(condition) \
+    checkCondition((condition), #condition, __FILE__, __LINE__)
+
+struct TestRegistration {
+    TestRegistration(const char* name, std::function<void()> run);
+};
+
+/**
+ * @return passed
+ */
+bool checkCondition(bool passed,
+                    const char* condition,
+                    const char* file,
+                    int line);
+
+#endif  // CHECK_H
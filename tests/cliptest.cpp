@@ -0,0 +1,154 @@
+#include <cmath>
+#include <random>
+
+#include "check.h"
+#include "geometry/predicates.h"
+#include "sites.h"
+#include "voronoi/sweepline.h"
+
+namespace
+{
+using index = Dcel::index;
+
+double squaredDistance(const Point& site, const PointF& point)
+{
+    const double dx = site.x - point.x;
+    const double dy = site.y - point.y;
+    return dx * dx + dy * dy;
+}
+
+/**
+ * @brief check that every face of vmap is a closed convex counter-clockwise
+ * cycle inside bounds, or empty, that the cells cover bounds and that every
+ * vertex is nearest to the site of its face
+ */
+void checkClipped(const Voronoi& vmap, const Rectangle& bounds)
+{
+    const Dcel& dcel = vmap.dcel;
+    CHECK(dcel.clipped);
+    const double extent = std::max(bounds.width, bounds.height);
+    const double tolerance = 1e-9 * extent;
+    double area = 0;
+    for (index f = 0; f < dcel.faces.size(); ++f) {
+        const Dcel::Face& face = dcel.faces[f];
+        if (dcel.removed(face) || face.halfEdge == Dcel::npos)
+            continue;
+        std::vector<PointF> cycle;
+        index h = face.halfEdge;
+        do {
+            const Dcel::HalfEdge& half = dcel.halfEdges[h];
+            if (!CHECK(half.face == f && half.origin != Dcel::npos &&
+                       half.next != Dcel::npos &&
+                       dcel.halfEdges[half.next].prev == h &&
+                       dcel.destination(h) == dcel.halfEdges[half.next].origin))
+                return;
+            cycle.push_back(dcel.vertices[half.origin]);
+            h = half.next;
+        } while (h != face.halfEdge && cycle.size() <= dcel.halfEdges.size());
+        if (!CHECK(h == face.halfEdge && cycle.size() >= 3))
+            return;
+
+        const size_t n = cycle.size();
+        for (size_t i = 0; i < n; ++i) {
+            const PointF& a = cycle[i];
+            const PointF& b = cycle[(i + 1) % n];
+            const PointF& c = cycle[(i + 2) % n];
+            CHECK(a.x >= bounds.x - tolerance &&
+                  a.x <= bounds.getRight() + tolerance &&
+                  a.y >= bounds.y - tolerance &&
+                  a.y <= bounds.getBottom() + tolerance);
+            // collinear corners are allowed, within the rounding of vertices
+            const double turn = orientation(a, b, c);
+            CHECK(turn >= -1e-9 * (b.distance(a) + b.distance(c)) * extent);
+            area += a.x * b.y - b.x * a.y;
+
+            double own = squaredDistance(face.site, a);
+            for (const auto& poly : vmap.polygons) {
+                if (!CHECK(squaredDistance(poly->focus, a) >=
+                           own - 1e-7 * (own + extent)))
+                    return;
+            }
+        }
+    }
+    const double expected = 2.0 * bounds.width * bounds.height;
+    CHECK(std::abs(area - expected) <= 1e-9 * expected);
+}
+
+std::shared_ptr<Voronoi> sweep(const std::vector<Point>& sites,
+                               const Rectangle& bounds)
+{
+    auto vmap = std::make_shared<Voronoi>(mapSize, mapSize);
+    for (const Point& site : sites)
+        vmap->addPoly(Polygon(site));
+    SweepLine(vmap).performFortune(bounds);
+    return vmap;
+}
+
+const Rectangle rectangles[] = {
+    Rectangle(0, 0, mapSize, mapSize),
+    // leaves sites outside on every side
+    Rectangle(mapSize / 4, mapSize / 3, mapSize / 2, mapSize / 5),
+    // far larger than the sites' box
+    Rectangle(-mapSize, -mapSize, 3 * mapSize, 3 * mapSize),
+};
+}  // namespace
+
+TEST(clippedFacesOfDistributions)
+{
+    for (const Distribution& distribution : distributions) {
+        for (const Rectangle& bounds : rectangles) {
+            std::mt19937 rng(1);
+            auto vmap = std::make_shared<Voronoi>(mapSize, mapSize);
+            distribution.generate(*vmap, 1000, rng);
+            SweepLine(vmap).performFortune(bounds);
+            checkClipped(*vmap, bounds);
+        }
+    }
+}
+
+TEST(clippedFacesOfSameX)
+{
+    std::vector<Point> column, columns;
+    for (int i = 0; i < 50; ++i) {
+        column.emplace_back(mapSize / 2, i * 1000 + 7);
+        columns.emplace_back(1000 + (i % 2) * 2000, i * 997);
+    }
+    for (const Rectangle& bounds : rectangles) {
+        checkClipped(*sweep(column, bounds), bounds);
+        checkClipped(*sweep(columns, bounds), bounds);
+    }
+}
+
+TEST(clippedFacesOfFewSites)
+{
+    const std::vector<Point> inputs[] = {
+        {Point(100, 100)},
+        {Point(100, 100), Point(900, 300)},
+        {Point(100, 100), Point(100, 100), Point(300, 700)},
+        {Point(-50, -50), Point(mapSize + 50, mapSize + 50)},
+    };
+    for (const auto& sites : inputs) {
+        for (const Rectangle& bounds : rectangles)
+            checkClipped(*sweep(sites, bounds), bounds);
+    }
+}
+
+TEST(clippedFacesOfExtremeCoordinates)
+{
+    // the sites span more than INT_MAX, the bounds don't
+    const int far = 1200000000;
+    std::vector<Point> sites = {Point(-far, -far), Point(far, far),
+                                Point(far, -far), Point(-far, far),
+                                Point(far, 0), Point(0, 10)};
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> coordinate(-far, far);
+    for (int i = 0; i < 200; ++i)
+        sites.emplace_back(coordinate(rng), coordinate(rng));
+    const Rectangle extreme[] = {
+        Rectangle(-1000000000, -1000000000, 2000000000, 2000000000),
+        Rectangle(-far, -far, 2000000000, 100),
+        Rectangle(0, 0, 1000, 1000),
+    };
+    for (const Rectangle& bounds : extreme)
+        checkClipped(*sweep(sites, bounds), bounds);
+}
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <random>
+
+#include "check.h"
+#include "voronoi/sweepline.h"
+
+namespace
+{
+using index = Delaunay::index;
+
+/**
+ * @brief orientation of integer points, computed exactly
+ */
+int orientation(const Point& a, const Point& b, const Point& c)
+{
+    const __int128 det = (__int128) ((int64_t) b.x - a.x) * (c.y - a.y) -
+                         (__int128) ((int64_t) b.y - a.y) * (c.x - a.x);
+    return (det > 0) - (det < 0);
+}
+
+/**
+ * @brief whether d lies strictly inside the circumcircle of the
+ * counter-clockwise triangle a, b, c, computed exactly
+ */
+bool inCircle(const Point& a, const Point& b, const Point& c, const Point& d)
+{
+    const __int128 ax = (int64_t) a.x - d.x, ay = (int64_t) a.y - d.y;
+    const __int128 bx = (int64_t) b.x - d.x, by = (int64_t) b.y - d.y;
+    const __int128 cx = (int64_t) c.x - d.x, cy = (int64_t) c.y - d.y;
+    const __int128 det = (ax * ax + ay * ay) * (bx * cy - cx * by) -
+                         (bx * bx + by * by) * (ax * cy - cx * ay) +
+                         (cx * cx + cy * cy) * (ax * by - bx * ay);
+    return det > 0;
+}
+
+/**
+ * @brief sites without duplicates, sorted by x and then y
+ */
+std::vector<Point> distinctSites(std::vector<Point> sites)
+{
+    std::sort(sites.begin(), sites.end(), [](const Point& a, const Point& b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    sites.erase(std::unique(sites.begin(), sites.end()), sites.end());
+    return sites;
+}
+
+/**
+ * @brief number of distinct sites on the boundary of their convex hull,
+ * including those in the middle of a hull edge. Collinear sites are
+ * counted twice, once for either side of the line, which has no area
+ * @param sites distinct and sorted, see distinctSites
+ */
+size_t hullSites(std::vector<Point> sites)
+{
+    if (sites.size() < 3)
+        return sites.size();
+    // monotone chain keeping collinear sites, both chains share the ends
+    std::vector<Point> hull;
+    for (int pass = 0; pass < 2; ++pass) {
+        const size_t start = hull.size();
+        for (const Point& site : sites) {
+            while (hull.size() >= start + 2 &&
+                   orientation(hull[hull.size() - 2], hull.back(), site) < 0)
+                hull.pop_back();
+            hull.push_back(site);
+        }
+        hull.pop_back();
+        std::reverse(sites.begin(), sites.end());
+    }
+    return hull.size();
+}
+
+/**
+ * @brief sweep sites with DelaunayOutput and check that the triangulation
+ * is a Delaunay triangulation of them
+ */
+void checkDelaunay(const std::vector<Point>& sites)
+{
+    auto vmap = std::make_shared<Voronoi>(1000, 1000);
+    for (const Point& site : sites)
+        vmap->addPoly(Polygon(site));
+    BasicSweepLine<int, double, DelaunayOutput>(vmap).performFortune();
+    const Delaunay& delaunay = vmap->delaunay;
+    if (!CHECK(delaunay.neighbours.size() == delaunay.triangles.size()))
+        return;
+
+    const std::vector<Point> distinct = distinctSites(sites);
+    const size_t n = distinct.size();
+    const size_t hull = hullSites(distinct);
+    // Euler's formula for a triangulation of n sites, hull of them on the
+    // boundary
+    const size_t expected = n < 3 ? 0 : 2 * n - 2 - hull;
+    CHECK(delaunay.size() == expected);
+
+    // sides are shared by two triangles or lie on the hull
+    size_t hullSides = 0;
+    for (index t = 0; t < delaunay.size(); ++t) {
+        const index* corners = &delaunay.triangles[3 * t];
+        const Point& a = sites[corners[0]];
+        const Point& b = sites[corners[1]];
+        const Point& c = sites[corners[2]];
+        if (!CHECK(orientation(a, b, c) > 0))
+            return;
+        for (int i = 0; i < 3; ++i) {
+            const index other = delaunay.neighbours[3 * t + i];
+            if (other == Delaunay::npos) {
+                ++hullSides;
+                continue;
+            }
+            // the other triangle has the side's ends and links back
+            const index* otherCorners = &delaunay.triangles[3 * other];
+            int shared = 0, back = 0;
+            for (int j = 0; j < 3; ++j) {
+                shared += otherCorners[j] == corners[(i + 1) % 3] ||
+                          otherCorners[j] == corners[(i + 2) % 3];
+                back += delaunay.neighbours[3 * other + j] == t;
+            }
+            CHECK(shared == 2 && back == 1);
+        }
+        // no site lies within the circumcircle, cocircular ones may lie on it
+        size_t inside = 0;
+        for (const Point& site : distinct)
+            inside += inCircle(a, b, c, site);
+        CHECK(inside == 0);
+    }
+    CHECK(expected == 0 || hullSides == hull);
+}
+}  // namespace
+
+TEST(delaunayOfRandomSites)
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> coordinate(0, 1000);
+    for (int n : {3, 4, 10, 100, 1000}) {
+        std::vector<Point> sites;
+        for (int i = 0; i < n; ++i)
+            sites.emplace_back(coordinate(rng), coordinate(rng));
+        // and a few duplicates, which get no triangles
+        for (int i = 0; i < n / 10; ++i)
+            sites.push_back(sites[i]);
+        checkDelaunay(sites);
+    }
+}
+
+TEST(delaunayOfCocircularSites)
+{
+    // a grid, every four neighbouring sites are cocircular
+    std::vector<Point> grid;
+    for (int x = 0; x < 20; ++x) {
+        for (int y = 0; y < 15; ++y)
+            grid.emplace_back(100 + 40 * x, 100 + 40 * y);
+    }
+    checkDelaunay(grid);
+
+    // rings of sites on exactly the same circle, 5^2 = 3^2 + 4^2 and so on
+    std::vector<Point> ring;
+    for (int r : {5, 25, 65}) {
+        for (int x = -r; x <= r; ++x) {
+            for (int y = -r; y <= r; ++y) {
+                if (x * x + y * y == r * r)
+                    ring.emplace_back(500 + 4 * x, 500 + 4 * y);
+            }
+        }
+    }
+    checkDelaunay(ring);
+}
+
+TEST(delaunayOfCollinearSites)
+{
+    std::vector<Point> sites;
+    for (int i = 0; i < 50; ++i)
+        sites.emplace_back(10 + 13 * (i * 7 % 50), 20 + 9 * (i * 7 % 50));
+    checkDelaunay(sites);
+    // a single site off the line makes a fan of triangles
+    sites.emplace_back(400, 900);
+    checkDelaunay(sites);
+    // and so do sites on two parallel lines
+    for (int i = 0; i < 20; ++i)
+        sites.emplace_back(10 + 13 * i, 120 + 9 * i);
+    checkDelaunay(sites);
+}
@@ -0,0 +1,246 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+#include "check.h"
+#include "voronoi/diagramfile.h"
+
+namespace
+{
+using index = Dcel::index;
+
+/**
+ * @brief path of a scratch file in the temporary directory, removed when
+ * it goes out of scope
+ */
+struct ScratchFile {
+    const std::string path;
+
+    explicit ScratchFile(const char* name)
+        : path((std::filesystem::temp_directory_path() /
+                ("voronoi_tests_" + std::string(name)))
+                   .string())
+    {
+    }
+    ~ScratchFile() { std::remove(path.c_str()); }
+
+    std::string read() const
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), {});
+    }
+    void write(const std::string& bytes) const
+    {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+    }
+};
+
+std::shared_ptr<Voronoi> randomMap(int count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> coordinate(0, 1000);
+    auto vmap = std::make_shared<Voronoi>(1000, 1000);
+    for (int i = 0; i < count; ++i)
+        vmap->addPoly(Polygon(Point(coordinate(rng), coordinate(rng))));
+    // duplicates and sites outside the bounds have no cell in the file
+    for (int i = 0; i < count / 20; ++i)
+        vmap->addPoly(Polygon(vmap->polygons[i * 3]->focus));
+    vmap->addPoly(Polygon(Point(-500, 400)));
+    return vmap;
+}
+
+/**
+ * @brief check that the mapped file holds vmap's sites and the cells and
+ * edges of its clipped dcel
+ */
+void checkMatchesDcel(const DiagramFileView& view, const Voronoi& vmap)
+{
+    const Dcel& dcel = vmap.dcel;
+    const Rectangle bounds = view.bounds();
+    CHECK(bounds.x == dcel.bounds.x && bounds.y == dcel.bounds.y &&
+          bounds.width == dcel.bounds.width &&
+          bounds.height == dcel.bounds.height);
+    if (!CHECK(view.siteCount() == vmap.polygons.size()))
+        return;
+    size_t different = 0;
+    for (size_t i = 0; i < vmap.polygons.size(); ++i) {
+        different += !(view.site(i) == vmap.polygons[i]->focus);
+        const index face = vmap.polygonFaces[i];
+        if (face == Voronoi::npos ||
+            dcel.faces[face].halfEdge == Dcel::npos) {
+            different += view.cellSize(i) != 0;
+            continue;
+        }
+        // written from the cycle, so in the same order and bit for bit
+        size_t k = 0;
+        index h = dcel.faces[face].halfEdge;
+        do {
+            const index twin = dcel.twin(h);
+            const index across =
+                twin == Dcel::npos
+                    ? Dcel::npos
+                    : dcel.faces[dcel.halfEdges[twin].face].polygon;
+            different += k >= view.cellSize(i) ||
+                         !(view.cellVertex(i, k) ==
+                           dcel.vertices[dcel.origin(h)]) ||
+                         view.cellNeighbour(i, k) != across;
+            ++k;
+            h = dcel.halfEdges[h].next;
+        } while (h != dcel.faces[face].halfEdge);
+        different += k != view.cellSize(i);
+    }
+    CHECK(different == 0);
+
+    // every edge lies between the two cells it names, once
+    size_t edges = 0;
+    for (const auto& half : dcel.halfEdges) {
+        edges += !dcel.removed(half) && half.twin != Dcel::npos &&
+                 half.origin != Dcel::npos;
+    }
+    if (!CHECK(view.edgeCount() == edges / 2))
+        return;
+    for (size_t e = 0; e < view.edgeCount(); ++e) {
+        const DiagramFileEdge& edge = view.edge(e);
+        if (!CHECK(edge.from < view.vertexCount() &&
+                   edge.to < view.vertexCount() &&
+                   edge.left < view.siteCount() &&
+                   edge.right < view.siteCount()))
+            return;
+        bool found = false;
+        const uint32_t c = edge.left;
+        for (size_t k = 0; k < view.cellSize(c); ++k) {
+            const PointF next = view.cellVertex(c, (k + 1) % view.cellSize(c));
+            found = found || (view.cellNeighbour(c, k) == edge.right &&
+                              view.cellVertex(c, k) == view.vertex(edge.from) &&
+                              next == view.vertex(edge.to));
+        }
+        different += !found;
+    }
+    CHECK(different == 0);
+}
+}  // namespace
+
+TEST(diagramFileRoundTrip)
+{
+    const ScratchFile file("roundtrip.vdgm");
+    for (const Rectangle& bounds :
+         {Rectangle(0, 0, 1000, 1000), Rectangle(200, 300, 400, 100)}) {
+        auto vmap = randomMap(500, 1);
+        SweepLine(vmap).performFortune(bounds);
+        std::string error;
+        if (!CHECK(writeDiagramFile(*vmap, file.path, error)))
+            return;
+        DiagramFileView view;
+        if (!CHECK(view.open(file.path, error)))
+            return;
+        checkMatchesDcel(view, *vmap);
+    }
+
+    // an empty diagram still has a header
+    Voronoi empty(1000, 1000);
+    std::string error;
+    DiagramFileView view;
+    CHECK(writeDiagramFile(empty, file.path, error) &&
+          view.open(file.path, error) && view.siteCount() == 0 &&
+          view.edgeCount() == 0);
+}
+
+TEST(diagramFileOfStreamedCells)
+{
+    const ScratchFile file("streamed.vdgm");
+    auto vmap = randomMap(500, 2);
+    const Rectangle bounds(0, 0, 1000, 1000);
+    std::vector<std::vector<PointF>> cells(vmap->polygons.size());
+    std::vector<std::vector<Dcel::index>> neighbours(vmap->polygons.size());
+    {
+        DiagramFileWriter writer(*vmap, bounds);
+        SweepLine(vmap).streamFortune(
+            bounds, [&](const SweepLine::FinishedCell& cell) {
+                cells[cell.polygon].assign(cell.vertices.begin(),
+                                           cell.vertices.end());
+                neighbours[cell.polygon].assign(cell.neighbours.begin(),
+                                                cell.neighbours.end());
+                writer.add(cell);
+            });
+        std::string error;
+        if (!CHECK(writer.finish(file.path, error)))
+            return;
+    }
+
+    std::string error;
+    DiagramFileView view;
+    if (!CHECK(view.open(file.path, error)) ||
+        !CHECK(view.siteCount() == vmap->polygons.size()))
+        return;
+    size_t different = 0, edges = 0;
+    for (size_t i = 0; i < cells.size(); ++i) {
+        different += !(view.site(i) == vmap->polygons[i]->focus) ||
+                     view.cellSize(i) != cells[i].size();
+        for (size_t k = 0; k < cells[i].size() && k < view.cellSize(i); ++k) {
+            different += !(view.cellVertex(i, k) == cells[i][k]) ||
+                         view.cellNeighbour(i, k) != neighbours[i][k];
+            edges += neighbours[i][k] != Dcel::npos;
+        }
+    }
+    CHECK(different == 0);
+    // streamed cells don't share vertices, every edge is written once
+    CHECK(view.edgeCount() == edges / 2);
+    size_t ring = 0;
+    for (const auto& cell : cells)
+        ring += cell.size();
+    CHECK(view.vertexCount() == ring);
+}
+
+TEST(diagramFileRejectsDamagedFiles)
+{
+    const ScratchFile file("damaged.vdgm");
+    auto vmap = randomMap(100, 3);
+    SweepLine(vmap).performFortune();
+    std::string error;
+    if (!CHECK(writeDiagramFile(*vmap, file.path, error)))
+        return;
+    const std::string bytes = file.read();
+    DiagramFileView view;
+    auto rejects = [&](const std::string& damaged) {
+        file.write(damaged);
+        error.clear();
+        return !view.open(file.path, error) && !error.empty();
+    };
+
+    CHECK(rejects(bytes.substr(0, bytes.size() - 1)));
+    CHECK(rejects(bytes.substr(0, sizeof(DiagramFileHeader) + 8)));
+    CHECK(rejects(bytes.substr(0, 10)));
+    CHECK(rejects(std::string()));
+    CHECK(rejects(bytes + '\0'));
+    std::string damaged = bytes;
+    damaged[0] = 'X';
+    CHECK(rejects(damaged));
+    damaged = bytes;
+    damaged[offsetof(DiagramFileHeader, version)] = 7;
+    CHECK(rejects(damaged));
+    // counts whose sizes would overflow the expected file size
+    DiagramFileHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    for (uint64_t DiagramFileHeader::*count :
+         {&DiagramFileHeader::sites, &DiagramFileHeader::vertices,
+          &DiagramFileHeader::edges, &DiagramFileHeader::ring}) {
+        for (uint64_t value : {header.*count + 1, uint64_t(1) << 60,
+                               ~uint64_t(0) / 8 + 1}) {
+            DiagramFileHeader wrong = header;
+            wrong.*count = value;
+            damaged = bytes;
+            std::memcpy(&damaged[0], &wrong, sizeof(wrong));
+            CHECK(rejects(damaged));
+        }
+    }
+    CHECK(!view.open(file.path + ".missing", error) && !error.empty());
+
+    // and it still opens the file intact
+    file.write(bytes);
+    CHECK(view.open(file.path, error));
+    checkMatchesDcel(view, *vmap);
+}
@@ -0,0 +1,189 @@
+#include <map>
+#include <random>
+#include <set>
+#include <tuple>
+
+#include "check.h"
+#include "voronoi/diagramlines.h"
+#include "voronoi/sweepline.h"
+
+namespace
+{
+using Key = std::tuple<double, double, double, double>;
+
+Key keyOf(const DiagramLines::Segment& segment)
+{
+    return {segment.a.x, segment.a.y, segment.b.x, segment.b.y};
+}
+
+/**
+ * @brief segments of the slots in use
+ */
+std::multiset<Key> segmentsOf(const DiagramLines& lines)
+{
+    std::multiset<Key> segments;
+    for (DiagramLines::index slot = 0; slot < lines.slotCount(); ++slot) {
+        if (lines.inUse(slot))
+            segments.insert(keyOf(lines.segments[slot]));
+    }
+    return segments;
+}
+
+/**
+ * @brief a view like LineLayer, which only learns about segments through
+ * added and removed
+ */
+struct View {
+    std::map<DiagramLines::index, Key> drawn;
+
+    void apply(const DiagramLines& lines)
+    {
+        std::set<DiagramLines::index> added(lines.added.begin(),
+                                            lines.added.end());
+        for (DiagramLines::index slot : lines.removed) {
+            CHECK(!added.count(slot));
+            // a removed slot still holds what was drawn
+            auto it = drawn.find(slot);
+            if (CHECK(it != drawn.end()))
+                CHECK(it->second == keyOf(lines.segments[slot]));
+            drawn.erase(slot);
+        }
+        for (DiagramLines::index slot : lines.added) {
+            CHECK(lines.inUse(slot));
+            CHECK(drawn.emplace(slot, keyOf(lines.segments[slot])).second);
+        }
+    }
+
+    std::multiset<Key> segments() const
+    {
+        std::multiset<Key> segments;
+        for (const auto& [slot, key] : drawn)
+            segments.insert(key);
+        return segments;
+    }
+};
+
+std::vector<const Polygon*> cellsOf(const Voronoi& vmap,
+                                    const std::vector<size_t>& changed)
+{
+    std::vector<const Polygon*> cells;
+    for (size_t polygon : changed)
+        cells.push_back(vmap.polygons[polygon].get());
+    return cells;
+}
+}  // namespace
+
+TEST(diagramLinesKeepSharedSegmentsOnce)
+{
+    auto vmap = std::make_shared<Voronoi>(1000, 1000);
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> coordinate(0, 1000);
+    for (int i = 0; i < 300; ++i)
+        vmap->addPoly(Polygon(Point(coordinate(rng), coordinate(rng))));
+    SweepLine(vmap).performFortune();
+
+    DiagramLines lines;
+    lines.update(*vmap);
+    const std::multiset<Key> segments = segmentsOf(lines);
+    // every segment is there once, whichever cell it was taken from
+    CHECK(std::set<Key>(segments.begin(), segments.end()).size() ==
+          segments.size());
+    CHECK(lines.added.size() == segments.size() && lines.removed.empty());
+    for (const auto& poly : vmap->polygons) {
+        for (const auto& edge : poly->edges) {
+            if (!(edge->a && edge->b) || *edge->a == *edge->b)
+                continue;
+            DiagramLines::Segment segment{*edge->a, *edge->b};
+            if (segment.b.x < segment.a.x ||
+                (segment.b.x == segment.a.x && segment.b.y < segment.a.y))
+                std::swap(segment.a, segment.b);
+            CHECK(segments.count(keyOf(segment)) == 1);
+        }
+    }
+
+    // nothing changed, nothing to redraw
+    lines.update(*vmap);
+    CHECK(lines.added.empty() && lines.removed.empty());
+}
+
+TEST(diagramLinesFollowIncrementalUpdates)
+{
+    auto vmap = std::make_shared<Voronoi>(1000, 1000);
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> coordinate(0, 1000);
+    auto draw = [&] { return Point(coordinate(rng), coordinate(rng)); };
+    for (int i = 0; i < 200; ++i)
+        vmap->addPoly(Polygon(draw()));
+    SweepLine(vmap).performFortune();
+
+    DiagramLines lines;
+    View view;
+    lines.update(*vmap);
+    view.apply(lines);
+    for (int step = 0; step < 300; ++step) {
+        std::uniform_int_distribution<size_t> pick(0,
+                                                   vmap->polygons.size() - 1);
+        std::vector<size_t> changed;
+        switch (step % 4) {
+        case 0:
+            changed = vmap->insertSite(draw());
+            break;
+        case 1: {
+            const size_t polygon = pick(rng);
+            lines.erase(vmap->polygons[polygon].get());
+            changed = vmap->eraseSite(polygon);
+            break;
+        }
+        case 2: {
+            // the polygon inserted after an erase gets the erased one's
+            // address, as the allocator may hand it out again
+            const size_t polygon = pick(rng);
+            std::shared_ptr<Polygon> erased = vmap->polygons[polygon];
+            lines.erase(erased.get());
+            changed = vmap->eraseSite(polygon);
+            lines.update(cellsOf(*vmap, changed));
+            view.apply(lines);
+            changed = vmap->insertSite(draw());
+            erased->focus = vmap->polygons.back()->focus;
+            erased->edges = vmap->polygons.back()->edges;
+            vmap->polygons.back() = erased;
+            break;
+        }
+        default:
+            changed = vmap->moveSite(pick(rng), draw());
+        }
+        lines.update(cellsOf(*vmap, changed));
+        view.apply(lines);
+
+        DiagramLines fresh;
+        fresh.update(*vmap);
+        if (!CHECK(view.segments() == segmentsOf(fresh) &&
+                   segmentsOf(lines) == segmentsOf(fresh)))
+            return;
+    }
+}
+
+TEST(diagramLinesDropErasedCellsOnFullUpdate)
+{
+    auto vmap = std::make_shared<Voronoi>(1000, 1000);
+    for (int i = 0; i < 10; ++i)
+        vmap->addPoly(Polygon(Point(50 + i * 97, 30 + i * i * 9)));
+    SweepLine(vmap).performFortune();
+    DiagramLines lines;
+    View view;
+    lines.update(*vmap);
+    view.apply(lines);
+
+    // erased while the diagram isn't shown, then swept again
+    lines.erase(vmap->polygons[3].get());
+    vmap->polygons.erase(vmap->polygons.begin() + 3);
+    vmap->addPoly(Polygon(Point(500, 500)));
+    SweepLine(vmap).performFortune();
+    lines.update(*vmap);
+    view.apply(lines);
+
+    DiagramLines fresh;
+    fresh.update(*vmap);
+    CHECK(view.segments() == segmentsOf(fresh));
+    CHECK(segmentsOf(lines) == segmentsOf(fresh));
+}
@@ -0,0 +1,228 @@
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <utility>
+
+#include "check.h"
+#include "voronoi/pointlocator.h"
+#include "voronoi/sweepline.h"
+
+namespace
+{
+using index = Dcel::index;
+using Site = std::pair<int, int>;
+using Cells = std::map<Site, std::vector<PointF>>;
+using Neighbours = std::set<std::pair<Site, Site>>;
+
+/**
+ * @brief vertices of the cell of every site with one, by site
+ */
+Cells cellsOf(const Voronoi& vmap)
+{
+    Cells cells;
+    const Dcel& dcel = vmap.dcel;
+    for (const Dcel::Face& face : dcel.faces) {
+        if (dcel.removed(face) || face.halfEdge == Dcel::npos)
+            continue;
+        std::vector<PointF>& cell = cells[{face.site.x, face.site.y}];
+        CHECK(cell.empty());
+        index h = face.halfEdge;
+        do {
+            cell.push_back(dcel.vertices[dcel.origin(h)]);
+            h = dcel.halfEdges[h].next;
+        } while (h != face.halfEdge);
+    }
+    return cells;
+}
+
+/**
+ * @brief sites of every pair of neighbouring faces, including those whose
+ * edge lies outside the clip bounds
+ */
+Neighbours neighboursOf(const Voronoi& vmap)
+{
+    const Dcel& dcel = vmap.dcel;
+    std::vector<index> offsets, neighbours;
+    dcel.faceNeighbours(offsets, neighbours);
+    Neighbours pairs;
+    for (index f = 0; f < dcel.faces.size(); ++f) {
+        const Point& site = dcel.faces[f].site;
+        for (index i = offsets[f]; i < offsets[f + 1]; ++i) {
+            const Point& other = dcel.faces[neighbours[i]].site;
+            CHECK(pairs.emplace(std::make_pair(site.x, site.y),
+                                std::make_pair(other.x, other.y))
+                      .second);
+        }
+    }
+    return pairs;
+}
+
+bool sameCell(const std::vector<PointF>& a, const std::vector<PointF>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (const PointF& v : a) {
+        bool found = false;
+        for (const PointF& w : b)
+            found = found || (std::abs(v.x - w.x) <= 1e-6 &&
+                              std::abs(v.y - w.y) <= 1e-6);
+        if (!found)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief check that the incrementally updated vmap has the cells a full
+ * sweep of its sites has, and that polygonFaces agrees with dcel
+ */
+void checkMatchesSweep(const Voronoi& vmap)
+{
+    auto swept = std::make_shared<Voronoi>(vmap.width, vmap.height);
+    for (const auto& poly : vmap.polygons)
+        swept->addPoly(Polygon(poly->focus));
+    SweepLine(swept).performFortune();
+
+    CHECK(vmap.polygonFaces.size() == vmap.polygons.size());
+    for (size_t i = 0; i < vmap.polygons.size(); ++i) {
+        const index face = vmap.polygonFaces[i];
+        if (face == Voronoi::npos)
+            continue;
+        CHECK(vmap.dcel.faces[face].polygon == i &&
+              vmap.dcel.faces[face].site == vmap.polygons[i]->focus);
+    }
+    const Cells expected = cellsOf(*swept);
+    const Cells cells = cellsOf(vmap);
+    if (!CHECK(cells.size() == expected.size()))
+        return;
+    for (const auto& [site, cell] : expected) {
+        auto it = cells.find(site);
+        if (!CHECK(it != cells.end() && sameCell(it->second, cell)))
+            return;
+    }
+    CHECK(neighboursOf(vmap) == neighboursOf(*swept));
+}
+
+/**
+ * @brief insert, erase and move random sites from draw, checking the
+ * diagram after every step
+ */
+template <class Draw>
+void runMix(int start, int steps, Draw draw)
+{
+    std::mt19937 rng(start);
+    auto vmap = std::make_shared<Voronoi>(1000, 1000);
+    for (int i = 0; i < start; ++i)
+        vmap->addPoly(Polygon(draw(rng)));
+    SweepLine(vmap).performFortune();
+    for (int step = 0; step < steps; ++step) {
+        const size_t count = vmap->polygons.size();
+        std::uniform_int_distribution<size_t> pick(0, count - 1);
+        switch (rng() % 3) {
+        case 0:
+            vmap->insertSite(draw(rng));
+            break;
+        case 1:
+            if (count > 1)
+                vmap->eraseSite(pick(rng));
+            break;
+        default:
+            vmap->moveSite(pick(rng), draw(rng));
+        }
+        checkMatchesSweep(*vmap);
+    }
+}
+}  // namespace
+
+TEST(incrementalUniform)
+{
+    std::uniform_int_distribution<int> coordinate(0, 1000);
+    runMix(200, 300, [&](std::mt19937& rng) {
+        return Point(coordinate(rng), coordinate(rng));
+    });
+}
+
+TEST(incrementalDuplicates)
+{
+    // a coarse grid, most sites have duplicates and cells are cocircular
+    std::uniform_int_distribution<int> coordinate(0, 9);
+    runMix(150, 300, [&](std::mt19937& rng) {
+        return Point(coordinate(rng) * 100 + 50, coordinate(rng) * 100 + 50);
+    });
+}
+
+TEST(incrementalCluster)
+{
+    std::normal_distribution<double> coordinate(500, 20);
+    runMix(300, 300, [&](std::mt19937& rng) {
+        return Point(PointF(coordinate(rng), coordinate(rng)));
+    });
+}
+
+TEST(incrementalKeepsEdgesOutsideBounds)
+{
+    // few sites on a small map, most cells reach the border and share edges
+    // lying outside it
+    std::uniform_int_distribution<int> coordinate(0, 100);
+    for (unsigned seed = 0; seed < 50; ++seed) {
+        std::mt19937 rng(seed);
+        auto vmap = std::make_shared<Voronoi>(100, 100);
+        for (int i = 0; i < 10; ++i)
+            vmap->addPoly(Polygon(Point(coordinate(rng), coordinate(rng))));
+        SweepLine(vmap).performFortune();
+        vmap->insertSite(Point(46, 14));
+        checkMatchesSweep(*vmap);
+        vmap->moveSite(seed % 10, Point(coordinate(rng), coordinate(rng)));
+        checkMatchesSweep(*vmap);
+        vmap->eraseSite(seed % 11);
+        checkMatchesSweep(*vmap);
+
+        // the locator walks those edges for points outside the map
+        const PointLocator locator(*vmap);
+        for (int i = 0; i < 20; ++i) {
+            const PointF point(coordinate(rng) * 4 - 200,
+                               coordinate(rng) * 4 - 200);
+            double best = std::numeric_limits<double>::max();
+            for (const auto& poly : vmap->polygons)
+                best = std::min(best, point.distance(PointF(poly->focus)));
+            const uint32_t cell = locator.locate(point);
+            CHECK(cell < vmap->polygons.size() &&
+                  point.distance(PointF(vmap->polygons[cell]->focus)) ==
+                      best);
+        }
+    }
+}
+
+TEST(incrementalTryCallsDontSweep)
+{
+    auto vmap = std::make_shared<Voronoi>(1000, 1000);
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> coordinate(0, 1000);
+    for (int i = 0; i < 100; ++i)
+        vmap->addPoly(Polygon(Point(coordinate(rng), coordinate(rng))));
+    SweepLine(vmap).performFortune();
+
+    auto changed = vmap->tryInsertSite(Point(500, 500));
+    CHECK(changed && !changed->empty());
+    checkMatchesSweep(*vmap);
+
+    // outside the bounds, the polygons follow but dcel is left alone
+    const size_t faces = vmap->dcel.faces.size();
+    CHECK(!vmap->tryMoveSite(3, Point(1500, 500)));
+    CHECK(vmap->polygons[3]->focus == Point(1500, 500));
+    CHECK(vmap->dcel.faces.size() == faces);
+    // and stays stale, even for edits it could do otherwise
+    CHECK(!vmap->tryInsertSite(Point(250, 250)));
+    CHECK(!vmap->tryEraseSite(7));
+    CHECK(!vmap->tryMoveSite(8, Point(750, 750)));
+    CHECK(vmap->polygons.size() == 101 && vmap->polygonFaces.size() == 101);
+    CHECK(vmap->polygons[8]->focus == Point(750, 750));
+
+    vmap->polygons[3]->focus = Point(999, 500);
+    SweepLine(vmap).performFortune();
+    changed = vmap->tryEraseSite(7);
+    CHECK(changed && !changed->empty());
+    checkMatchesSweep(*vmap);
+    CHECK(vmap->tryMoveSite(8, Point(750, 750)) == std::vector<size_t>());
+}
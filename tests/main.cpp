@@ -0,0 +1,64 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "check.h"
+
+namespace
+{
+struct Test {
+    const char* name;
+    std::function<void()> run;
+};
+
+// a function's static, the registrations of other files may come first
+std::vector<Test>& tests()
+{
+    static std::vector<Test> all;
+    return all;
+}
+
+int failures = 0;
+}  // namespace
+
+TestRegistration::TestRegistration(const char* name, std::function<void()> run)
+{
+    tests().push_back({name, std::move(run)});
+}
+
+bool checkCondition(bool passed,
+                    const char* condition,
+                    const char* file,
+                    int line)
+{
+    if (!passed) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line,
+                     condition);
+        ++failures;
+    }
+    return passed;
+}
+
+/**
+ * runs every test, or those whose name contains one of the arguments
+ */
+int main(int argc, char* argv[])
+{
+    int run = 0;
+    for (const Test& test : tests()) {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; ++i)
+            selected = selected || std::strstr(test.name, argv[i]);
+        if (!selected)
+            continue;
+        const int before = failures;
+        test.run();
+        std::printf("%-40s %s\n", test.name,
+                    failures == before ? "ok" : "FAILED");
+        ++run;
+    }
+    std::printf("%d tests, %d failed checks\n", run, failures);
+    return failures == 0 ? 0 : 1;
+}
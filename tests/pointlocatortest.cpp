@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+
+#include "check.h"
+#include "sites.h"
+#include "voronoi/pointlocator.h"
+#include "voronoi/sweepline.h"
+
+namespace
+{
+double squaredDistance(const PointF& point, const Point& site)
+{
+    const double dx = site.x - point.x;
+    const double dy = site.y - point.y;
+    return dx * dx + dy * dy;
+}
+
+/**
+ * @brief squared distance and polygon of every site with a cell, by a scan
+ * over all of them, nearest first
+ */
+std::vector<std::pair<double, uint32_t>> byDistance(const Voronoi& vmap,
+                                                    const PointF& point)
+{
+    std::vector<std::pair<double, uint32_t>> cells;
+    for (size_t i = 0; i < vmap.polygons.size(); ++i) {
+        if (vmap.polygonFaces[i] != Voronoi::npos)
+            cells.emplace_back(squaredDistance(point, vmap.polygons[i]->focus),
+                               (uint32_t) i);
+    }
+    std::sort(cells.begin(), cells.end());
+    return cells;
+}
+
+std::shared_ptr<Voronoi> sweptMap(SiteGenerator generate, int n)
+{
+    std::mt19937 rng(n);
+    auto vmap = std::make_shared<Voronoi>(mapSize, mapSize);
+    generate(*vmap, n, rng);
+    // duplicates have no cell of their own
+    for (int i = 0; i < n / 50; ++i)
+        vmap->addPoly(Polygon(vmap->polygons[i * 7 % n]->focus));
+    SweepLine(vmap).performFortune();
+    return vmap;
+}
+
+/**
+ * @brief points in and around the map, at sites, and halfway between sites
+ * and in the middle of four of them, which on a lattice ties
+ */
+std::vector<PointF> queriesAround(const Voronoi& vmap, size_t count)
+{
+    std::mt19937 rng((unsigned) count);
+    std::uniform_real_distribution<double> coordinate(-mapSize, 2.0 * mapSize);
+    const size_t n = vmap.polygons.size();
+    // row length of latticeSites, which the duplicates don't count towards
+    const size_t side =
+        (size_t) std::ceil(std::sqrt((double) vmap.dcel.faces.size()));
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+    auto halfway = [&](size_t a, size_t b) {
+        const Point& p = vmap.polygons[a % n]->focus;
+        const Point& q = vmap.polygons[b % n]->focus;
+        return PointF((p.x + (double) q.x) / 2, (p.y + (double) q.y) / 2);
+    };
+    std::vector<PointF> points;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t site = pick(rng);
+        switch (i % 4) {
+        case 0:
+            points.emplace_back(coordinate(rng), coordinate(rng));
+            break;
+        case 1:
+            points.push_back(PointF(vmap.polygons[site]->focus));
+            break;
+        case 2:
+            points.push_back(halfway(site, site + 1));
+            break;
+        default:
+            points.push_back(halfway(site, site + side + 1));
+        }
+    }
+    return points;
+}
+
+/**
+ * @brief check single queries of locator against a scan over vmap's sites
+ */
+void checkAgainstScan(const Voronoi& vmap,
+                      const PointLocator& locator,
+                      const std::vector<PointF>& points)
+{
+    const size_t k = 6;
+    const double radius = 3.0 * mapSize / std::sqrt(vmap.polygons.size());
+    std::vector<uint32_t> cells;
+    for (const PointF& point : points) {
+        const auto expected = byDistance(vmap, point);
+
+        // any of the nearest sites if several tie
+        const uint32_t cell = locator.locate(point);
+        if (!CHECK(cell < vmap.polygons.size()))
+            return;
+        CHECK(squaredDistance(point, vmap.polygons[cell]->focus) ==
+              expected.front().first);
+
+        locator.nearest(point, k, cells);
+        if (!CHECK(cells.size() == std::min(k, expected.size())))
+            return;
+        for (size_t i = 0; i < cells.size(); ++i) {
+            CHECK(squaredDistance(point, vmap.polygons[cells[i]]->focus) ==
+                  expected[i].first);
+        }
+        std::sort(cells.begin(), cells.end());
+        CHECK(std::adjacent_find(cells.begin(), cells.end()) == cells.end());
+
+        locator.within(point, radius, cells);
+        for (size_t i = 1; i < cells.size(); ++i) {
+            CHECK(squaredDistance(point, vmap.polygons[cells[i - 1]]->focus) <=
+                  squaredDistance(point, vmap.polygons[cells[i]]->focus));
+        }
+        std::vector<uint32_t> inside;
+        for (const auto& [d, i] : expected) {
+            if (d <= radius * radius)
+                inside.push_back(i);
+        }
+        std::sort(cells.begin(), cells.end());
+        std::sort(inside.begin(), inside.end());
+        CHECK(cells == inside);
+    }
+}
+
+/**
+ * @brief check that the batched queries answer like the single ones
+ */
+void checkBatches(const PointLocator& locator,
+                  const std::vector<PointF>& points,
+                  unsigned threads)
+{
+    const size_t count = points.size();
+    std::vector<uint32_t> cells(count);
+    locator.locate(points.data(), count, cells.data(), threads);
+    size_t different = 0;
+    for (size_t i = 0; i < count; ++i)
+        different += cells[i] != locator.locate(points[i]);
+    CHECK(different == 0);
+
+    const size_t k = 4;
+    cells.assign(count * k, 0);
+    locator.nearest(points.data(), count, k, cells.data(), threads);
+    std::vector<uint32_t> single;
+    different = 0;
+    for (size_t i = 0; i < count; ++i) {
+        locator.nearest(points[i], k, single);
+        single.resize(k, PointLocator::npos);
+        different += !std::equal(single.begin(), single.end(),
+                                 cells.begin() + i * k);
+    }
+    CHECK(different == 0);
+
+    std::vector<uint32_t> offsets;
+    locator.within(points.data(), count, mapSize / 200.0, offsets, cells,
+                   threads);
+    if (!CHECK(offsets.size() == count + 1 && offsets.back() == cells.size()))
+        return;
+    different = 0;
+    for (size_t i = 0; i < count; ++i) {
+        locator.within(points[i], mapSize / 200.0, single);
+        different += !std::equal(single.begin(), single.end(),
+                                 cells.begin() + offsets[i],
+                                 cells.begin() + offsets[i + 1]);
+    }
+    CHECK(different == 0);
+}
+}  // namespace
+
+TEST(pointLocatorMatchesScan)
+{
+    for (const Distribution& distribution : distributions) {
+        auto vmap = sweptMap(distribution.generate, 2000);
+        const PointLocator locator(*vmap);
+        checkAgainstScan(*vmap, locator, queriesAround(*vmap, 2000));
+    }
+}
+
+TEST(pointLocatorBatchesMatchSingleQueries)
+{
+    // enough points for several threads, and to be sorted by bucket
+    for (const Distribution& distribution : distributions) {
+        auto vmap = sweptMap(distribution.generate, 3000);
+        const PointLocator locator(*vmap);
+        const std::vector<PointF> points = queriesAround(*vmap, 40000);
+        for (unsigned threads : {1u, 3u})
+            checkBatches(locator, points, threads);
+        // few points are answered in the order given
+        checkBatches(locator, std::vector<PointF>(points.begin(),
+                                                  points.begin() + 100),
+                     3);
+    }
+}
+
+TEST(pointLocatorOfFewSites)
+{
+    for (int n : {1, 2, 3}) {
+        auto vmap = sweptMap(uniformSites, n);
+        const PointLocator locator(*vmap);
+        checkAgainstScan(*vmap, locator, queriesAround(*vmap, 200));
+    }
+
+    const PointLocator empty{Voronoi(mapSize, mapSize)};
+    std::vector<uint32_t> cells{1, 2};
+    CHECK(empty.locate(PointF(1, 1)) == PointLocator::npos);
+    empty.nearest(PointF(1, 1), 3, cells);
+    CHECK(cells.empty());
+    cells = {1, 2};
+    empty.within(PointF(1, 1), mapSize, cells);
+    CHECK(cells.empty());
+}
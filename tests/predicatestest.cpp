@@ -0,0 +1,160 @@
+#include <cmath>
+#include <random>
+
+#include "check.h"
+#include "geometry/predicates.h"
+#include "voronoi/sweepline.h"
+
+namespace
+{
+int sign(double value)
+{
+    return (value > 0) - (value < 0);
+}
+
+/**
+ * @brief orientation of integer points, computed exactly
+ */
+int exactSign(int64_t ax, int64_t ay, int64_t bx, int64_t by, int64_t cx,
+              int64_t cy)
+{
+    const __int128 det = (__int128) (bx - ax) * (cy - ay) -
+                         (__int128) (by - ay) * (cx - ax);
+    return (det > 0) - (det < 0);
+}
+
+/**
+ * @brief sweep sites with a Coord, Real diagram clipped to bounds
+ * @return sum of the cells' areas, computed from their dcel cycles
+ */
+template <class Coord, class Real>
+double sweptArea(const std::vector<BasicPoint<Coord>>& sites,
+                 const BasicRectangle<Coord>& bounds,
+                 size_t& cells)
+{
+    using Diagram = BasicVoronoi<Coord, Real>;
+    auto vmap = std::make_shared<Diagram>(bounds.width, bounds.height);
+    for (const auto& site : sites)
+        vmap->addPoly(typename Diagram::Polygon(site));
+    BasicSweepLine<Coord, Real>(vmap).performFortune(bounds);
+    const auto& dcel = vmap->dcel;
+    double area = 0;
+    cells = 0;
+    for (const auto& face : dcel.faces) {
+        if (dcel.removed(face) || face.halfEdge == DcelBase::npos)
+            continue;
+        ++cells;
+        auto h = face.halfEdge;
+        do {
+            // relative to the corner, large offsets would cancel otherwise
+            const double ax = (double) dcel.vertices[dcel.origin(h)].x -
+                              (double) bounds.x;
+            const double ay = (double) dcel.vertices[dcel.origin(h)].y -
+                              (double) bounds.y;
+            const auto& b = dcel.vertices[dcel.destination(h)];
+            const double bx = (double) b.x - (double) bounds.x;
+            const double by = (double) b.y - (double) bounds.y;
+            area += ax * by - bx * ay;
+            h = dcel.halfEdges[h].next;
+        } while (h != face.halfEdge);
+    }
+    return area / 2;
+}
+}  // namespace
+
+TEST(orientationOfNearlyCollinearPoints)
+{
+    // the double evaluation alone gets these wrong, see Shewchuk
+    const PointF b(12, 12), c(24, 24);
+    for (int i = 0; i < 64; ++i) {
+        for (int j = 0; j < 64; ++j) {
+            const PointF a(0.5 + i * 0x1p-53, 0.5 + j * 0x1p-53);
+            // exact as long as a's coordinates are multiples of 2^-53
+            const int expected = sign((double) (j - i));
+            CHECK(sign(orientation(a, b, c)) == expected);
+            CHECK(sign(orientation(b, c, a)) == expected);
+            CHECK(sign(orientation(b, a, c)) == -expected);
+        }
+    }
+}
+
+TEST(orientationAtLargeOffsets)
+{
+    std::mt19937_64 rng(7);
+    const int64_t offset = (int64_t) 1 << 40;
+    std::uniform_int_distribution<int64_t> small(-1000, 1000);
+    for (int i = 0; i < 10000; ++i) {
+        const int64_t ax = offset + small(rng), ay = offset + small(rng);
+        const int64_t dx = small(rng), dy = small(rng);
+        // c on the line through a and b, or next to it
+        const int64_t k = small(rng);
+        const int64_t nudge = i % 3 - 1;
+        const int64_t bx = ax + dx, by = ay + dy;
+        const int64_t cx = ax + k * dx + nudge, cy = ay + k * dy;
+        const PointF a(ax, ay), b(bx, by), c(cx, cy);
+        CHECK(sign(orientation(a, b, c)) == exactSign(ax, ay, bx, by, cx, cy));
+    }
+}
+
+TEST(circumcenterAtLargeOffsets)
+{
+    const double offset = 0x1p40;
+    const PointF a(offset, offset), b(offset + 1000, offset + 10),
+        c(offset + 300, offset + 900);
+    const PointF center = circumcenter(a, b, c, orientation(a, b, c));
+    const double ra = center.distance(a);
+    CHECK(std::abs(center.distance(b) - ra) <= 1e-6 * ra);
+    CHECK(std::abs(center.distance(c) - ra) <= 1e-6 * ra);
+}
+
+TEST(pointConversionsRound)
+{
+    static_assert(widens<int, double> && widens<int, int64_t>);
+    static_assert(widens<float, double>);
+    static_assert(!widens<int64_t, double> && !widens<double, int>);
+    static_assert(!widens<double, float>);
+    CHECK(Point(PointF(10.9, -10.9)) == Point(11, -11));
+    CHECK(Point(PointF(10.4, -10.4)) == Point(10, -10));
+    CHECK(Point(PointF(2.5, -2.5)) == Point(3, -3));
+    const int64_t big = ((int64_t) 1 << 40) + 1;
+    CHECK(BasicPoint<int64_t>(PointF((double) big, 0.6)) ==
+          BasicPoint<int64_t>(big, 1));
+}
+
+TEST(instantiationsCoverTheirBounds)
+{
+    // a lattice of cocircular sites plus a collinear row
+    std::vector<Point> sites;
+    for (int i = 0; i < 20; ++i) {
+        for (int j = 0; j < 20; ++j)
+            sites.emplace_back(25 + i * 50, 25 + j * 50);
+        sites.emplace_back(13 + i * 49, 1000);
+    }
+    const Rectangle bounds(0, 0, 1000, 1000);
+    size_t cells = 0, expectedCells = 0;
+    const double area = sweptArea<int, double>(sites, bounds, expectedCells);
+    CHECK(std::abs(area - 1e6) <= 1e-9 * 1e6);
+
+    CHECK(std::abs(sweptArea<int, float>(sites, bounds, cells) - 1e6) <=
+          1e-4 * 1e6);
+    CHECK(cells == expectedCells);
+
+    std::vector<BasicPoint<double>> real;
+    for (const Point& site : sites)
+        real.emplace_back(site.x + 0.25, site.y + 0.25);
+    CHECK(std::abs(sweptArea<double, double>(
+                       real, BasicRectangle<double>(0, 0, 1000, 1000),
+                       cells) -
+                   1e6) <= 1e-9 * 1e6);
+    CHECK(cells == expectedCells);
+
+    const int64_t offset = (int64_t) 1 << 40;
+    std::vector<BasicPoint<int64_t>> far;
+    for (const Point& site : sites)
+        far.emplace_back(offset + site.x, offset + site.y);
+    CHECK(std::abs(sweptArea<int64_t, double>(
+                       far, BasicRectangle<int64_t>(offset, offset, 1000, 1000),
+                       cells) -
+                   1e6) <= 1e-6 * 1e6);
+    CHECK(cells == expectedCells);
+}
@@ -0,0 +1,101 @@
+#include <random>
+
+#include "check.h"
+#include "voronoi/sweepline.h"
+
+namespace
+{
+std::shared_ptr<Voronoi> randomMap(int count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> coordinate(0, 1000);
+    auto vmap = std::make_shared<Voronoi>(1000, 1000);
+    for (int i = 0; i < count; ++i)
+        vmap->addPoly(Polygon(Point(coordinate(rng), coordinate(rng))));
+    return vmap;
+}
+
+/**
+ * @brief check that the polygons of vmap have the edges a fresh sweep of
+ * their sites gives them
+ */
+void checkMatchesSweep(const Voronoi& vmap)
+{
+    auto swept = std::make_shared<Voronoi>(vmap.width, vmap.height);
+    for (const auto& poly : vmap.polygons)
+        swept->addPoly(Polygon(poly->focus));
+    SweepLine(swept).performFortune();
+    if (!CHECK(vmap.polygons.size() == swept->polygons.size()))
+        return;
+    for (size_t i = 0; i < vmap.polygons.size(); ++i) {
+        const auto& edges = vmap.polygons[i]->edges;
+        const auto& expected = swept->polygons[i]->edges;
+        if (!CHECK(edges.size() == expected.size()))
+            return;
+        for (size_t j = 0; j < edges.size(); ++j)
+            CHECK(*edges[j]->a == *expected[j]->a &&
+                  *edges[j]->b == *expected[j]->b);
+    }
+}
+
+/**
+ * @brief one press of the editor's step key, see
+ * MainWindow::stepAndSyncScene
+ */
+void step(SweepLine& sl, Voronoi& vmap)
+{
+    if (sl.edgesFinished)
+        return;
+    if (sl.nextEvent() == sl.LMAXVALUE)
+        sl.finishEdges();
+    vmap.syncPolygons();
+}
+}  // namespace
+
+TEST(stepsFinishEdgesOnce)
+{
+    auto vmap = randomMap(200, 1);
+    SweepLine sl(vmap);
+    while (sl.nextEvent() != sl.LMAXVALUE)
+        ;
+    sl.finishEdges();
+    CHECK(sl.edgesFinished && vmap->dcel.clipped);
+    const auto vertices = vmap->dcel.vertices;
+    const size_t halfEdges = vmap->dcel.halfEdges.size();
+    // a clipped dcel can't be clipped again
+    sl.finishEdges();
+    CHECK(vmap->dcel.halfEdges.size() == halfEdges &&
+          vmap->dcel.vertices.size() == vertices.size());
+    vmap->syncPolygons();
+    checkMatchesSweep(*vmap);
+
+    // loading starts over
+    sl.loadVmap(vmap);
+    CHECK(!sl.edgesFinished);
+}
+
+TEST(stepsStartOverAfterEdits)
+{
+    auto vmap = randomMap(50, 2);
+    auto sl = std::make_shared<SweepLine>(vmap);
+    for (int i = 0; i < 3; ++i)
+        step(*sl, *vmap);
+
+    // removed like the editor does, the last polygon takes its place, which
+    // the faces of the running sweep don't know about
+    vmap->polygons[0] = std::move(vmap->polygons.back());
+    vmap->polygons.pop_back();
+    sl = std::make_shared<SweepLine>(vmap);
+    for (int i = 0; i < 5; ++i)
+        step(*sl, *vmap);
+
+    vmap->polygons[7]->focus = Point(500, 500);
+    vmap->addPoly(Polygon(Point(20, 980)));
+    sl = std::make_shared<SweepLine>(vmap);
+    while (!sl->edgesFinished)
+        step(*sl, *vmap);
+    checkMatchesSweep(*vmap);
+    // pressing on does nothing
+    step(*sl, *vmap);
+    checkMatchesSweep(*vmap);
+}
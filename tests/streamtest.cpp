@@ -0,0 +1,175 @@
+#include <cmath>
+#include <random>
+
+#include "check.h"
+#include "sites.h"
+#include "voronoi/sweepline.h"
+
+namespace
+{
+using index = Dcel::index;
+
+/**
+ * @brief a cell as vertices counter-clockwise and the polygon across the
+ * edge from each of them to the next, npos along the border
+ */
+struct Cell {
+    bool seen = false;
+    std::vector<PointF> vertices;
+    std::vector<index> neighbours;
+};
+
+/**
+ * @brief cells of every polygon of vmap's clipped dcel
+ */
+std::vector<Cell> cellsOf(const Voronoi& vmap)
+{
+    const Dcel& dcel = vmap.dcel;
+    std::vector<Cell> cells(vmap.polygons.size());
+    for (const Dcel::Face& face : dcel.faces) {
+        if (dcel.removed(face) || face.halfEdge == Dcel::npos)
+            continue;
+        Cell& cell = cells[face.polygon];
+        index h = face.halfEdge;
+        do {
+            const index twin = dcel.twin(h);
+            cell.vertices.push_back(dcel.vertices[dcel.origin(h)]);
+            cell.neighbours.push_back(
+                twin == Dcel::npos
+                    ? Dcel::npos
+                    : dcel.faces[dcel.halfEdges[twin].face].polygon);
+            h = dcel.halfEdges[h].next;
+        } while (h != face.halfEdge);
+    }
+    return cells;
+}
+
+bool near(const PointF& a, const PointF& b, double tolerance)
+{
+    return std::abs(a.x - b.x) <= tolerance && std::abs(a.y - b.y) <= tolerance;
+}
+
+/**
+ * @brief merge vertices within tolerance of the one before, where more than
+ * three cells meet the dcel has edges of zero length, streamed cells don't.
+ * The merged vertex is followed by the edge of the last one
+ */
+Cell merged(const Cell& cell, double tolerance)
+{
+    Cell result;
+    for (size_t i = 0; i < cell.vertices.size(); ++i) {
+        if (!result.vertices.empty() &&
+            near(result.vertices.back(), cell.vertices[i], tolerance)) {
+            result.neighbours.back() = cell.neighbours[i];
+            continue;
+        }
+        result.vertices.push_back(cell.vertices[i]);
+        result.neighbours.push_back(cell.neighbours[i]);
+    }
+    if (result.vertices.size() > 1 &&
+        near(result.vertices.back(), result.vertices.front(), tolerance)) {
+        result.vertices.pop_back();
+        result.neighbours.pop_back();
+    }
+    return result;
+}
+
+/**
+ * @brief whether the cells have the same vertices, give or take tolerance,
+ * and neighbours in the same order, starting anywhere
+ */
+bool sameCell(const Cell& streamed, const Cell& finished, double tolerance)
+{
+    const Cell cell = merged(streamed, tolerance);
+    const Cell expected = merged(finished, tolerance);
+    const size_t n = cell.vertices.size();
+    if (expected.vertices.size() != n)
+        return false;
+    for (size_t shift = 0; shift < n; ++shift) {
+        bool all = true;
+        for (size_t i = 0; all && i < n; ++i) {
+            const size_t j = (i + shift) % n;
+            all = near(cell.vertices[i], expected.vertices[j], tolerance) &&
+                  cell.neighbours[i] == expected.neighbours[j];
+        }
+        if (all)
+            return true;
+    }
+    return n == 0;
+}
+
+/**
+ * @brief check that streaming the sites of vmap hands out the cells of the
+ * finished diagram clipped to bounds, each once
+ */
+void checkStreamMatchesDiagram(const Voronoi& vmap, const Rectangle& bounds)
+{
+    auto copy = [&] {
+        auto sites = std::make_shared<Voronoi>(vmap.width, vmap.height);
+        for (const auto& poly : vmap.polygons)
+            sites->addPoly(Polygon(poly->focus));
+        return sites;
+    };
+    auto finished = copy();
+    SweepLine(finished).performFortune(bounds);
+    const std::vector<Cell> expected = cellsOf(*finished);
+
+    auto streamed = copy();
+    std::vector<Cell> cells(vmap.polygons.size());
+    size_t twice = 0;
+    SweepLine sweepLine(streamed);
+    sweepLine.streamFortune(bounds, [&](const SweepLine::FinishedCell& cell) {
+        Cell& own = cells[cell.polygon];
+        twice += own.seen;
+        own.seen = true;
+        own.vertices.assign(cell.vertices.begin(), cell.vertices.end());
+        own.neighbours.assign(cell.neighbours.begin(), cell.neighbours.end());
+    });
+    CHECK(twice == 0);
+
+    const double tolerance = 1e-9 * ((double) bounds.width + bounds.height);
+    size_t different = 0;
+    for (size_t i = 0; i < cells.size(); ++i) {
+        // duplicates of an earlier site aren't handed out
+        const bool duplicate = finished->polygonFaces[i] == Voronoi::npos;
+        if (cells[i].seen == duplicate ||
+            !sameCell(cells[i], expected[i], tolerance))
+            ++different;
+    }
+    CHECK(different == 0);
+    // the dcel is cleared afterwards
+    CHECK(streamed->dcel.faces.empty() && streamed->dcel.halfEdges.empty());
+}
+}  // namespace
+
+TEST(streamedCellsMatchFinishedDiagram)
+{
+    const Rectangle rectangles[] = {
+        Rectangle(0, 0, mapSize, mapSize),
+        // cutting through the cells, and around all of them
+        Rectangle(mapSize / 3, mapSize / 4, mapSize / 2, mapSize / 3),
+        Rectangle(-mapSize, -mapSize, 3 * mapSize, 3 * mapSize),
+    };
+    for (const Distribution& distribution : distributions) {
+        std::mt19937 rng(1);
+        Voronoi vmap(mapSize, mapSize);
+        distribution.generate(vmap, 3000, rng);
+        // with a few duplicates
+        for (int i = 0; i < 30; ++i)
+            vmap.addPoly(Polygon(vmap.polygons[i * 17]->focus));
+        for (const Rectangle& bounds : rectangles)
+            checkStreamMatchesDiagram(vmap, bounds);
+    }
+}
+
+TEST(streamedCellsOfFewSites)
+{
+    for (int n : {1, 2, 3, 10}) {
+        std::mt19937 rng(n);
+        Voronoi vmap(1000, 1000);
+        std::uniform_int_distribution<int> coordinate(0, 1000);
+        for (int i = 0; i < n; ++i)
+            vmap.addPoly(Polygon(Point(coordinate(rng), coordinate(rng))));
+        checkStreamMatchesDiagram(vmap, Rectangle(0, 0, 1000, 1000));
+    }
+}
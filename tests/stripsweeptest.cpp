@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <random>
+
+#include "check.h"
+#include "sites.h"
+#include "voronoi/stripsweep.h"
+#include "voronoi/sweepline.h"
+
+namespace
+{
+std::shared_ptr<Voronoi> copySites(const Voronoi& vmap)
+{
+    auto copy = std::make_shared<Voronoi>(vmap.width, vmap.height);
+    for (const auto& poly : vmap.polygons)
+        copy->addPoly(Polygon(poly->focus));
+    return copy;
+}
+
+/**
+ * @brief whether the cells have the same vertices in the same order, the
+ * walk around them may start elsewhere
+ */
+bool sameCell(const Polygon& cell, const Polygon& expected)
+{
+    const auto& edges = cell.edges;
+    const auto& want = expected.edges;
+    if (edges.size() != want.size())
+        return false;
+    if (edges.empty())
+        return true;
+    auto same = [](const auto& a, const auto& b) {
+        return (!a && !b) || (a && b && *a == *b);
+    };
+    for (size_t shift = 0; shift < want.size(); ++shift) {
+        bool all = true;
+        for (size_t i = 0; all && i < edges.size(); ++i) {
+            const auto& other = want[(i + shift) % want.size()];
+            all = same(edges[i]->a, other->a) && same(edges[i]->b, other->b);
+        }
+        if (all)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief check that the strips give vmap's sites the diagram the serial
+ * sweep gives them, clipped to bounds
+ */
+void checkMatchesSerial(const Voronoi& vmap,
+                        const Rectangle& bounds,
+                        unsigned threads)
+{
+    auto strips = copySites(vmap);
+    StripSweep(strips).performFortune(bounds, threads);
+    auto serial = copySites(vmap);
+    SweepLine(serial).performFortune(bounds);
+
+    const Dcel& dcel = strips->dcel;
+    const Dcel& expected = serial->dcel;
+    CHECK(dcel.clipped && dcel.bounds.x == bounds.x &&
+          dcel.bounds.y == bounds.y && dcel.bounds.width == bounds.width &&
+          dcel.bounds.height == bounds.height);
+    CHECK(dcel.faces.size() == expected.faces.size());
+    CHECK(strips->polygonFaces == serial->polygonFaces);
+    size_t different = 0;
+    for (size_t i = 0; i < vmap.polygons.size(); ++i) {
+        if (!sameCell(*strips->polygons[i], *serial->polygons[i]))
+            ++different;
+    }
+    CHECK(different == 0);
+
+    // half-edges are numbered differently, so neighbours come in another
+    // order
+    auto neighboursOf = [](const Dcel& dcel) {
+        std::vector<Dcel::index> offsets, neighbours;
+        dcel.faceNeighbours(offsets, neighbours);
+        for (size_t f = 0; f + 1 < offsets.size(); ++f)
+            std::sort(neighbours.begin() + offsets[f],
+                      neighbours.begin() + offsets[f + 1]);
+        return std::make_pair(offsets, neighbours);
+    };
+    CHECK(neighboursOf(dcel) == neighboursOf(expected));
+}
+}  // namespace
+
+TEST(stripSweepMatchesSerial)
+{
+    // large enough for three strips of at least chunkThreads' minimum
+    const int n = 50000;
+    const Rectangle bounds(0, 0, mapSize, mapSize);
+    for (const Distribution& distribution : distributions) {
+        std::mt19937 rng(1);
+        Voronoi vmap(mapSize, mapSize);
+        distribution.generate(vmap, n, rng);
+        for (unsigned threads : {2u, 3u})
+            checkMatchesSerial(vmap, bounds, threads);
+    }
+}
+
+TEST(stripSweepMatchesSerialInOtherBounds)
+{
+    std::mt19937 rng(2);
+    Voronoi vmap(mapSize, mapSize);
+    uniformSites(vmap, 33000, rng);
+    const Rectangle rectangles[] = {
+        // inside the sites, beyond them and off to one side
+        Rectangle(mapSize / 4, mapSize / 3, mapSize / 2, mapSize / 5),
+        Rectangle(-mapSize, -mapSize / 2, 3 * mapSize, 2 * mapSize),
+        Rectangle(2 * mapSize, 0, mapSize, mapSize),
+        Rectangle(100, 100, 1, 1),
+    };
+    for (const Rectangle& bounds : rectangles)
+        checkMatchesSerial(vmap, bounds, 2);
+}
+
+TEST(stripSweepMatchesSerialWithFewSites)
+{
+    // more threads than sites, or than strips worth sweeping on their own
+    for (int n : {1, 2, 5, 100}) {
+        std::mt19937 rng(n);
+        Voronoi vmap(mapSize, mapSize);
+        uniformSites(vmap, n, rng);
+        checkMatchesSerial(vmap, Rectangle(0, 0, mapSize, mapSize), 16);
+    }
+    Voronoi empty(mapSize, mapSize);
+    checkMatchesSerial(empty, Rectangle(0, 0, mapSize, mapSize), 16);
+}
+
+TEST(stripSweepMatchesSerialAtExtremeCoordinates)
+{
+    // the box around the sites is wider than int
+    const int far = 1200000000;
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> coordinate(-far, far);
+    Voronoi vmap(mapSize, mapSize);
+    for (int i = 0; i < 33000; ++i)
+        vmap.addPoly(Polygon(Point(coordinate(rng), coordinate(rng))));
+    checkMatchesSerial(vmap, Rectangle(-1000000000, -1000000000, 2000000000,
+                                       2000000000), 2);
+    checkMatchesSerial(vmap, Rectangle(0, 0, mapSize, mapSize), 2);
+}
@@ -0,0 +1,232 @@
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <set>
+#include <tuple>
+
+#include "check.h"
+#include "voronoi/sweepline.h"
+#include "voronoi/sweepworker.h"
+
+namespace
+{
+using namespace std::chrono_literals;
+
+/**
+ * @brief counts the worker's ready calls, which come from its thread
+ */
+struct Ready {
+    std::mutex mutex;
+    std::condition_variable called;
+    int count = 0;
+
+    std::function<void()> callback()
+    {
+        return [this] {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++count;
+            called.notify_all();
+        };
+    }
+    int calls()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return count;
+    }
+    /**
+     * @return false if ready wasn't called more than `calls` times in time
+     */
+    bool waitFor(int calls)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return called.wait_for(lock, 60s, [&] { return count > calls; });
+    }
+};
+
+std::vector<Point> randomSites(int count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> coordinate(0, 1000);
+    std::vector<Point> sites;
+    for (int i = 0; i < count; ++i)
+        sites.emplace_back(coordinate(rng), coordinate(rng));
+    return sites;
+}
+
+bool sameSites(const Voronoi& vmap, const std::vector<Point>& sites)
+{
+    if (vmap.polygons.size() != sites.size())
+        return false;
+    for (size_t i = 0; i < sites.size(); ++i) {
+        if (!(vmap.polygons[i]->focus == sites[i]))
+            return false;
+    }
+    return true;
+}
+
+std::multiset<std::tuple<double, double, double, double>> segmentsOf(
+    const DiagramLines& lines)
+{
+    std::multiset<std::tuple<double, double, double, double>> segments;
+    for (DiagramLines::index slot = 0; slot < lines.slotCount(); ++slot) {
+        if (!lines.inUse(slot))
+            continue;
+        const DiagramLines::Segment& segment = lines.segments[slot];
+        segments.emplace(segment.a.x, segment.a.y, segment.b.x, segment.b.y);
+    }
+    return segments;
+}
+}  // namespace
+
+TEST(sweepWorkerMatchesSweep)
+{
+    const std::vector<Point> sites = randomSites(2000, 1);
+    Ready ready;
+    SweepWorker worker(ready.callback());
+    worker.request(sites, 1000, 1000);
+    if (!CHECK(ready.waitFor(0)))
+        return;
+    std::unique_ptr<SweepWorker::Result> swept = worker.take();
+    if (!CHECK(swept && sameSites(*swept->vmap, sites)))
+        return;
+    // taken already
+    CHECK(!worker.take());
+
+    auto vmap = std::make_shared<Voronoi>(1000, 1000);
+    for (const Point& site : sites)
+        vmap->addPoly(Polygon(site));
+    SweepLine(vmap).performFortune();
+    for (size_t i = 0; i < sites.size(); ++i) {
+        const auto& edges = swept->vmap->polygons[i]->edges;
+        const auto& expected = vmap->polygons[i]->edges;
+        if (!CHECK(edges.size() == expected.size()))
+            return;
+        for (size_t j = 0; j < edges.size(); ++j)
+            CHECK(*edges[j]->a == *expected[j]->a &&
+                  *edges[j]->b == *expected[j]->b);
+    }
+    DiagramLines lines;
+    lines.update(*vmap);
+    CHECK(segmentsOf(swept->lines) == segmentsOf(lines));
+    worker.dispose(std::move(swept));
+}
+
+TEST(sweepWorkerOnlyHandsOutTheNewest)
+{
+    Ready ready;
+    SweepWorker worker(ready.callback());
+    // the first ones are superseded while they're swept or still waiting
+    for (unsigned seed = 0; seed < 5; ++seed)
+        worker.request(randomSites(20000, seed), 1000, 1000);
+    const std::vector<Point> newest = randomSites(300, 5);
+    worker.request(newest, 1000, 1000);
+    std::unique_ptr<SweepWorker::Result> swept;
+    for (int calls = 0; !swept && CHECK(ready.waitFor(calls)); ++calls)
+        swept = worker.take();
+    if (!CHECK(swept != nullptr))
+        return;
+    CHECK(sameSites(*swept->vmap, newest));
+    worker.dispose(std::move(swept));
+
+    // a done result is superseded by the next request before it's taken
+    const int calls = ready.calls();
+    worker.request(randomSites(300, 6), 1000, 1000);
+    if (!CHECK(ready.waitFor(calls)))
+        return;
+    const std::vector<Point> next = randomSites(300, 7);
+    worker.request(next, 1000, 1000);
+    swept = worker.take();
+    CHECK(!swept || sameSites(*swept->vmap, next));
+}
+
+TEST(sweepWorkerCancels)
+{
+    Ready ready;
+    SweepWorker worker(ready.callback());
+    worker.request(randomSites(300, 1), 1000, 1000);
+    if (!CHECK(ready.waitFor(0)))
+        return;
+    worker.cancel();
+    CHECK(!worker.take());
+
+    // stopped while sweeping, nothing to take afterwards
+    const int calls = ready.calls();
+    worker.request(randomSites(200000, 2), 1000, 1000);
+    std::this_thread::sleep_for(10ms);
+    worker.cancel();
+    std::this_thread::sleep_for(100ms);
+    CHECK(!worker.take());
+
+    // and it still sweeps what's requested next
+    const std::vector<Point> sites = randomSites(300, 3);
+    worker.request(sites, 1000, 1000);
+    std::unique_ptr<SweepWorker::Result> swept;
+    for (int seen = calls; !swept && CHECK(ready.waitFor(seen)); ++seen)
+        swept = worker.take();
+    CHECK(swept && sameSites(*swept->vmap, sites));
+}
+
+TEST(sweepStopsWhileClippingAndSyncing)
+{
+    const std::vector<Point> sites = randomSites(50000, 5);
+    auto sweptEvents = [&] {
+        auto vmap = std::make_shared<Voronoi>(1000, 1000);
+        for (const Point& site : sites)
+            vmap->addPoly(Polygon(site));
+        auto sl = std::make_unique<SweepLine>(vmap);
+        while (sl->nextEvent() != sl->LMAXVALUE)
+            ;
+        return std::make_pair(vmap, std::move(sl));
+    };
+    const Rectangle bounds(0, 0, 1000, 1000);
+    int calls = 0;
+    auto never = [&] { return ++calls, false; };
+    auto third = [&] { return ++calls >= 3; };
+
+    auto [vmap, sl] = sweptEvents();
+    Dcel::ClipBuffers buffers;
+    sl->finishEdges(bounds, buffers, never);
+    CHECK((size_t) calls > vmap->dcel.faces.size() / 4096);
+    auto [expected, expectedSl] = sweptEvents();
+    expectedSl->finishEdges(bounds);
+    CHECK(vmap->dcel.vertices.size() == expected->dcel.vertices.size() &&
+          vmap->dcel.halfEdges.size() == expected->dcel.halfEdges.size());
+
+    calls = 0;
+    vmap->syncPolygons(1, never);
+    CHECK((size_t) calls > vmap->polygons.size() / 4096);
+    calls = 0;
+    vmap->syncPolygons(1, third);
+    // returned at the first true
+    CHECK(calls == 3);
+
+    calls = 0;
+    auto [stopped, stoppedSl] = sweptEvents();
+    stoppedSl->finishEdges(bounds, buffers, third);
+    // clip asks once more when clipEdges returns
+    CHECK(calls == 4);
+}
+
+TEST(sweepWorkerStopsWhenDestroyed)
+{
+    using Clock = std::chrono::steady_clock;
+    const std::vector<Point> sites = randomSites(200000, 4);
+    Clock::time_point start = Clock::now();
+    {
+        auto vmap = std::make_shared<Voronoi>(1000, 1000);
+        for (const Point& site : sites)
+            vmap->addPoly(Polygon(site));
+        SweepLine(vmap).performFortune();
+    }
+    const Clock::duration sweep = Clock::now() - start;
+
+    Ready ready;
+    auto worker = std::make_unique<SweepWorker>(ready.callback());
+    worker->request(sites, 1000, 1000);
+    std::this_thread::sleep_for(sweep / 4);
+    start = Clock::now();
+    worker.reset();
+    CHECK(Clock::now() - start < sweep / 2);
+    CHECK(ready.calls() == 0);
+}
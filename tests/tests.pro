@@ -0,0 +1,29 @@
+# unit tests of the engine, `make check` runs them
+CONFIG += c++17 console testcase
+CONFIG -= qt
+CONFIG -= app_bundle
+
+TARGET = voronoi_tests
+
+include(../core/core.pri)
+
+INCLUDEPATH += ../benchmark
+
+SOURCES += \
+	../benchmark/sites.cpp \
+	cliptest.cpp \
+	delaunaytest.cpp \
+	diagramfiletest.cpp \
+	diagramlinestest.cpp \
+	incrementaltest.cpp \
+	pointlocatortest.cpp \
+	predicatestest.cpp \
+	steptest.cpp \
+	streamtest.cpp \
+	stripsweeptest.cpp \
+	sweepworkertest.cpp \
+	main.cpp
+
+HEADERS += \
+	../benchmark/sites.h \
+	check.h
@@ -0,0 +1,300 @@
+#include "cellarrays.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "data_structure/parallelfor.h"
+
+namespace
+{
+/**
+ * @brief number of vertices of the closed ring of face, with the first one
+ * repeated, or 0 if its boundary isn't a closed cycle with known vertices
+ */
+uint32_t ringSize(const Dcel& dcel, Dcel::index face)
+{
+    const Dcel::index start = dcel.faces[face].halfEdge;
+    if (start == Dcel::npos)
+        return 0;
+    uint32_t size = 1;
+    Dcel::index h = start;
+    do {
+        if (h == Dcel::npos || dcel.origin(h) == Dcel::npos)
+            return 0;
+        ++size;
+        h = dcel.halfEdges[h].next;
+    } while (h != start);
+    return size;
+}
+
+/**
+ * @brief store the metrics of cell c from the sums over its edges
+ * coordinates relative to the cell's first vertex (ox, oy) keep the products
+ * small, so that tiny cells far from the origin get exact centroids too
+ */
+void storeMetrics(CellArrays& cells,
+                  size_t c,
+                  double ox,
+                  double oy,
+                  double twiceArea,
+                  double sumX,
+                  double sumY,
+                  double length)
+{
+    cells.area[c] = 0.5 * twiceArea;
+    cells.perimeter[c] = length;
+    if (twiceArea != 0) {
+        const double third = (1.0 / 3) / twiceArea;
+        cells.centroidX[c] = ox + sumX * third;
+        cells.centroidY[c] = oy + sumY * third;
+    } else {
+        cells.centroidX[c] = cells.siteX[c];
+        cells.centroidY[c] = cells.siteY[c];
+    }
+}
+
+void measureCell(CellArrays& cells, size_t c)
+{
+    const uint32_t begin = cells.offsets[c], end = cells.offsets[c + 1];
+    if (begin == end) {
+        storeMetrics(cells, c, 0, 0, 0, 0, 0, 0);
+        cells.minX[c] = cells.maxX[c] = cells.siteX[c];
+        cells.minY[c] = cells.maxY[c] = cells.siteY[c];
+        return;
+    }
+    const double* x = cells.x.data();
+    const double* y = cells.y.data();
+    const double ox = x[begin], oy = y[begin];
+    double twiceArea = 0, sumX = 0, sumY = 0, length = 0;
+    double left = ox, right = ox, top = oy, bottom = oy;
+    double x0 = 0, y0 = 0;
+    for (uint32_t i = begin + 1; i < end; ++i) {
+        const double x1 = x[i] - ox, y1 = y[i] - oy;
+        const double cross = x0 * y1 - x1 * y0;
+        twiceArea += cross;
+        sumX += (x0 + x1) * cross;
+        sumY += (y0 + y1) * cross;
+        const double dx = x1 - x0, dy = y1 - y0;
+        length += std::sqrt(dx * dx + dy * dy);
+        left = std::min(left, x[i]);
+        right = std::max(right, x[i]);
+        top = std::min(top, y[i]);
+        bottom = std::max(bottom, y[i]);
+        x0 = x1;
+        y0 = y1;
+    }
+    storeMetrics(cells, c, ox, oy, twiceArea, sumX, sumY, length);
+    cells.minX[c] = left;
+    cells.maxX[c] = right;
+    cells.minY[c] = top;
+    cells.maxY[c] = bottom;
+}
+
+#ifdef __AVX2__
+/**
+ * @brief base[index] for four 32-bit indices
+ * the masked gather is the same instruction, but unlike _mm256_i32gather_pd
+ * doesn't make gcc warn about its undefined source operand
+ */
+__m256d gather(const double* base, __m128i index)
+{
+    return _mm256_mask_i32gather_pd(
+        _mm256_setzero_pd(), base, index,
+        _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+}
+
+/**
+ * @brief measureCell for cells c ... c + 3, one per lane
+ * the lanes walk their rings in step, a lane past its last edge keeps
+ * reading its closing vertex and masks its sums, which leaves its bounds
+ * unchanged as that vertex is also the first one
+ */
+void measureCells4(CellArrays& cells, size_t c)
+{
+    const double* x = cells.x.data();
+    const double* y = cells.y.data();
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i begin =
+        _mm_loadu_si128((const __m128i*) (cells.offsets.data() + c));
+    const __m128i end =
+        _mm_loadu_si128((const __m128i*) (cells.offsets.data() + c + 1));
+    // -1 for a cell without vertices, which reads vertex 0 instead
+    const __m128i edges = _mm_sub_epi32(_mm_sub_epi32(end, begin), one);
+    const __m128i empty = _mm_cmplt_epi32(edges, _mm_setzero_si128());
+    const __m128i start = _mm_andnot_si128(empty, begin);
+    const __m128i lastEdge = _mm_max_epi32(edges, _mm_setzero_si128());
+    alignas(16) int32_t edgeCounts[4];
+    _mm_store_si128((__m128i*) edgeCounts, edges);
+    const int maxEdges = *std::max_element(edgeCounts, edgeCounts + 4);
+
+    const __m256d ox = gather(x, start);
+    const __m256d oy = gather(y, start);
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d twiceArea = zero, sumX = zero, sumY = zero, length = zero;
+    __m256d left = ox, right = ox, top = oy, bottom = oy;
+    __m256d x0 = zero, y0 = zero;
+    for (int j = 0; j < maxEdges; ++j) {
+        const __m128i jv = _mm_set1_epi32(j);
+        const __m256d active = _mm256_castsi256_pd(
+            _mm256_cvtepi32_epi64(_mm_cmpgt_epi32(edges, jv)));
+        const __m128i next = _mm_add_epi32(
+            start, _mm_min_epi32(_mm_add_epi32(jv, one), lastEdge));
+        const __m256d rawX = gather(x, next);
+        const __m256d rawY = gather(y, next);
+        const __m256d x1 = _mm256_sub_pd(rawX, ox);
+        const __m256d y1 = _mm256_sub_pd(rawY, oy);
+        const __m256d cross = _mm256_and_pd(
+            active,
+            _mm256_sub_pd(_mm256_mul_pd(x0, y1), _mm256_mul_pd(x1, y0)));
+        twiceArea = _mm256_add_pd(twiceArea, cross);
+        sumX = _mm256_add_pd(sumX,
+                             _mm256_mul_pd(_mm256_add_pd(x0, x1), cross));
+        sumY = _mm256_add_pd(sumY,
+                             _mm256_mul_pd(_mm256_add_pd(y0, y1), cross));
+        const __m256d dx = _mm256_sub_pd(x1, x0);
+        const __m256d dy = _mm256_sub_pd(y1, y0);
+        const __m256d edgeLength = _mm256_sqrt_pd(
+            _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+        length = _mm256_add_pd(length, _mm256_and_pd(active, edgeLength));
+        left = _mm256_min_pd(left, rawX);
+        right = _mm256_max_pd(right, rawX);
+        top = _mm256_min_pd(top, rawY);
+        bottom = _mm256_max_pd(bottom, rawY);
+        x0 = x1;
+        y0 = y1;
+    }
+
+    const __m256d siteX = _mm256_loadu_pd(cells.siteX.data() + c);
+    const __m256d siteY = _mm256_loadu_pd(cells.siteY.data() + c);
+    const __m256d emptyMask =
+        _mm256_castsi256_pd(_mm256_cvtepi32_epi64(empty));
+    const __m256d flat = _mm256_cmp_pd(twiceArea, zero, _CMP_EQ_OQ);
+    const __m256d third = _mm256_div_pd(_mm256_set1_pd(1.0 / 3), twiceArea);
+    const __m256d centroidX =
+        _mm256_add_pd(ox, _mm256_mul_pd(sumX, third));
+    const __m256d centroidY =
+        _mm256_add_pd(oy, _mm256_mul_pd(sumY, third));
+    _mm256_storeu_pd(cells.area.data() + c,
+                     _mm256_mul_pd(twiceArea, _mm256_set1_pd(0.5)));
+    _mm256_storeu_pd(cells.perimeter.data() + c, length);
+    _mm256_storeu_pd(cells.centroidX.data() + c,
+                     _mm256_blendv_pd(centroidX, siteX, flat));
+    _mm256_storeu_pd(cells.centroidY.data() + c,
+                     _mm256_blendv_pd(centroidY, siteY, flat));
+    _mm256_storeu_pd(cells.minX.data() + c,
+                     _mm256_blendv_pd(left, siteX, emptyMask));
+    _mm256_storeu_pd(cells.maxX.data() + c,
+                     _mm256_blendv_pd(right, siteX, emptyMask));
+    _mm256_storeu_pd(cells.minY.data() + c,
+                     _mm256_blendv_pd(top, siteY, emptyMask));
+    _mm256_storeu_pd(cells.maxY.data() + c,
+                     _mm256_blendv_pd(bottom, siteY, emptyMask));
+}
+#endif
+
+void measureCells(CellArrays& cells, size_t begin, size_t end)
+{
+    size_t c = begin;
+#ifdef __AVX2__
+    // gathers use 32-bit indices and need a vertex to read for empty cells
+    if (!cells.x.empty() && cells.x.size() <= (size_t) INT32_MAX) {
+        for (; c + 4 <= end; c += 4)
+            measureCells4(cells, c);
+    }
+#endif
+    for (; c < end; ++c)
+        measureCell(cells, c);
+}
+}  // namespace
+
+CellArrays::CellArrays(const Voronoi& vmap, unsigned threads)
+{
+    build(vmap, threads);
+}
+
+void CellArrays::build(const Voronoi& vmap, unsigned threads)
+{
+    const Dcel& dcel = vmap.dcel;
+    const size_t cells = vmap.polygons.size();
+    const size_t faceCount = dcel.faces.size();
+    siteX.resize(cells);
+    siteY.resize(cells);
+    for (size_t c = 0; c < cells; ++c) {
+        siteX[c] = vmap.polygons[c]->focus.x;
+        siteY[c] = vmap.polygons[c]->focus.y;
+    }
+
+    // ring sizes go to offsets[polygon + 1] first, then are summed up. In a
+    // clipped dcel every face with half-edges is a closed cycle, so they're
+    // counted in one pass over the half-edges instead of walking every ring
+    offsets.assign(cells + 1, 0);
+    const unsigned faceThreads = chunkThreads(threads, faceCount, 1 << 12);
+    if (dcel.clipped) {
+        for (const Dcel::HalfEdge& half : dcel.halfEdges) {
+            if (!dcel.removed(half) && half.origin != Dcel::npos)
+                ++offsets[dcel.faces[half.face].polygon + 1];
+        }
+        for (size_t c = 1; c <= cells; ++c)
+            offsets[c] += offsets[c] != 0;
+    } else {
+        forEachChunk(faceThreads, faceCount,
+                     [&](unsigned, size_t begin, size_t end) {
+                         for (size_t f = begin; f < end; ++f) {
+                             const Dcel::Face& face = dcel.faces[f];
+                             if (!dcel.removed(face))
+                                 offsets[face.polygon + 1] =
+                                     ringSize(dcel, (Dcel::index) f);
+                         }
+                     });
+    }
+    for (size_t c = 0; c < cells; ++c)
+        offsets[c + 1] += offsets[c];
+    x.resize(offsets[cells]);
+    y.resize(offsets[cells]);
+
+    forEachChunk(faceThreads, faceCount,
+                 [&](unsigned, size_t begin, size_t end) {
+                     for (size_t f = begin; f < end; ++f) {
+                         const Dcel::Face& face = dcel.faces[f];
+                         if (dcel.removed(face))
+                             continue;
+                         uint32_t i = offsets[face.polygon];
+                         if (i == offsets[face.polygon + 1])
+                             continue;
+                         Dcel::index h = face.halfEdge;
+                         do {
+                             const PointF& vertex =
+                                 dcel.vertices[dcel.origin(h)];
+                             x[i] = vertex.x;
+                             y[i] = vertex.y;
+                             ++i;
+                             h = dcel.halfEdges[h].next;
+                         } while (h != face.halfEdge);
+                         x[i] = x[offsets[face.polygon]];
+                         y[i] = y[offsets[face.polygon]];
+                     }
+                 });
+
+    computeMetrics(threads);
+}
+
+void CellArrays::computeMetrics(unsigned threads)
+{
+    const size_t cells = size();
+    area.resize(cells);
+    centroidX.resize(cells);
+    centroidY.resize(cells);
+    perimeter.resize(cells);
+    minX.resize(cells);
+    minY.resize(cells);
+    maxX.resize(cells);
+    maxY.resize(cells);
+    forEachChunk(chunkThreads(threads, cells, 1 << 12), cells,
+                 [this](unsigned, size_t begin, size_t end) {
+                     measureCells(*this, begin, end);
+                 });
+}
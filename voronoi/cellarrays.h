@@ -0,0 +1,66 @@
+#ifndef CELLARRAYS_H
+#define CELLARRAYS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "voronoi.h"
+
+/**
+ * @brief CellArrays is a structure-of-arrays copy of the cells of a clipped
+ * Voronoi, together with the area, centroid, perimeter and bounding box of
+ * every cell.
+ *
+ * Cells are indexed like Voronoi::polygons. The vertices of cell c are
+ * (x[i], y[i]) for offsets[c] <= i < offsets[c + 1], in counter-clockwise
+ * (in y-up coordinates) order, and the ring is closed by repeating its first
+ * vertex at the end, so that edge i of the whole array always goes from
+ * vertex i to vertex i + 1. Cells that aren't a closed cycle in the dcel,
+ * like those of an unclipped diagram or of duplicate sites, have no vertices,
+ * zero area and perimeter, and their site as centroid and bounding box.
+ *
+ * Metrics are computed four cells at a time with AVX2 when the library is
+ * built with it, e.g. by CORE_CXXFLAGS="-march=native", and one at a time
+ * otherwise. Both give the same results up to rounding.
+ *
+ * Building again reuses the arrays' memory.
+ */
+class CellArrays
+{
+public:
+    CellArrays() = default;
+    explicit CellArrays(const Voronoi& vmap, unsigned threads = 1);
+
+    /**
+     * @brief copy the cells of vmap's dcel and compute their metrics
+     * @param threads number of threads to split the cells across, 0 for
+     * hardware concurrency
+     */
+    void build(const Voronoi& vmap, unsigned threads = 1);
+    /**
+     * @brief compute the metrics again, after x and y were changed in place
+     */
+    void computeMetrics(unsigned threads = 1);
+
+    std::size_t size() const { return siteX.size(); }
+    /**
+     * @brief number of vertices of cell c, without the repeated one
+     */
+    std::size_t vertexCount(std::size_t c) const
+    {
+        return offsets[c + 1] == offsets[c] ? 0
+                                            : offsets[c + 1] - offsets[c] - 1;
+    }
+
+    std::vector<uint32_t> offsets;
+    std::vector<double> x, y;
+
+    std::vector<double> siteX, siteY;
+    std::vector<double> area;
+    std::vector<double> centroidX, centroidY;
+    std::vector<double> perimeter;
+    std::vector<double> minX, minY, maxX, maxY;
+};
+
+#endif  // CELLARRAYS_H
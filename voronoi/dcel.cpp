@@ -0,0 +1,474 @@
+#include "dcel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "geometry/segmentclipper.h"
+
+namespace
+{
+/**
+ * @brief border of a rectangle, parametrized counter-clockwise (in y-up
+ * coordinates) by the distance walked from its (x0, y0) corner
+ */
+struct Border {
+    double x0, y0, x1, y1;
+    double width, height, perimeter;
+
+    template <class T>
+    explicit Border(const BasicRectangle<T>& rect)
+        : x0(rect.x),
+          y0(rect.y),
+          x1(rect.getRight()),
+          y1(rect.getBottom()),
+          width(rect.width),
+          height(rect.height),
+          perimeter(2.0 * rect.width + 2.0 * rect.height)
+    {
+    }
+
+    /**
+     * @brief position of a point on the border, the side it's nearest to is
+     * taken so that points off by rounding still get a position
+     */
+    double position(const PointF& p) const
+    {
+        const double toSide[4] = {std::abs(p.y - y0), std::abs(p.x - x1),
+                                  std::abs(p.y - y1), std::abs(p.x - x0)};
+        const int side = (int) (std::min_element(toSide, toSide + 4) - toSide);
+        switch (side) {
+        case 0:
+            return std::clamp(p.x - x0, 0.0, width);
+        case 1:
+            return width + std::clamp(p.y - y0, 0.0, height);
+        case 2:
+            return width + height + std::clamp(x1 - p.x, 0.0, width);
+        default:
+            double pos = 2 * width + height + std::clamp(y1 - p.y, 0.0, height);
+            return pos < perimeter ? pos : pos - perimeter;
+        }
+    }
+
+    /**
+     * @brief k-th corner counter-clockwise, at position cornerPosition(k)
+     */
+    PointF corner(int k) const
+    {
+        switch (k % 4) {
+        case 0:
+            return PointF(x1, y0);
+        case 1:
+            return PointF(x1, y1);
+        case 2:
+            return PointF(x0, y1);
+        default:
+            return PointF(x0, y0);
+        }
+    }
+    double cornerPosition(int k) const
+    {
+        const double positions[4] = {width, width + height,
+                                     2 * width + height, perimeter};
+        return positions[k % 4] + (k / 4) * perimeter;
+    }
+};
+}  // namespace
+
+template <class Coord, class Real>
+void BasicDcel<Coord, Real>::clear()
+{
+    vertices.clear();
+    halfEdges.clear();
+    faces.clear();
+    clipped = false;
+    freeVertices.clear();
+    freeEdges.clear();
+    freeHalfEdges.clear();
+    freeFaces.clear();
+}
+
+template <class Coord, class Real>
+DcelBase::index BasicDcel<Coord, Real>::addVertex(const Vertex& point)
+{
+    if (!freeVertices.empty()) {
+        index v = freeVertices.back();
+        freeVertices.pop_back();
+        vertices[v] = point;
+        return v;
+    }
+    vertices.push_back(point);
+    return (index) (vertices.size() - 1);
+}
+
+template <class Coord, class Real>
+DcelBase::index BasicDcel<Coord, Real>::addFace(const Site& site,
+                                                index polygon)
+{
+    if (!freeFaces.empty()) {
+        index f = freeFaces.back();
+        freeFaces.pop_back();
+        faces[f] = Face{site, polygon};
+        return f;
+    }
+    faces.push_back(Face{site, polygon});
+    return (index) (faces.size() - 1);
+}
+
+template <class Coord, class Real>
+DcelBase::index BasicDcel<Coord, Real>::addEdge(index a, index b)
+{
+    index first;
+    if (!freeEdges.empty()) {
+        first = freeEdges.back();
+        freeEdges.pop_back();
+    } else {
+        first = (index) halfEdges.size();
+        halfEdges.resize(halfEdges.size() + 2);
+    }
+    halfEdges[first] = HalfEdge{npos, first + 1, npos, npos, a};
+    halfEdges[first + 1] = HalfEdge{npos, first, npos, npos, b};
+    if (faces[a].halfEdge == npos)
+        faces[a].halfEdge = first;
+    if (faces[b].halfEdge == npos)
+        faces[b].halfEdge = first + 1;
+    return first;
+}
+
+template <class Coord, class Real>
+DcelBase::index BasicDcel<Coord, Real>::addHalfEdge(index face, index origin)
+{
+    index h;
+    if (!freeHalfEdges.empty()) {
+        h = freeHalfEdges.back();
+        freeHalfEdges.pop_back();
+    } else {
+        h = (index) halfEdges.size();
+        halfEdges.emplace_back();
+    }
+    halfEdges[h] = HalfEdge{origin, npos, npos, npos, face};
+    return h;
+}
+
+template <class Coord, class Real>
+void BasicDcel<Coord, Real>::removeVertex(index vertex)
+{
+    freeVertices.push_back(vertex);
+}
+
+template <class Coord, class Real>
+void BasicDcel<Coord, Real>::removeEdge(index halfEdge)
+{
+    index t = halfEdges[halfEdge].twin;
+    halfEdges[halfEdge] = HalfEdge{};
+    if (t == npos) {
+        freeHalfEdges.push_back(halfEdge);
+        return;
+    }
+    halfEdges[t] = HalfEdge{};
+    freeEdges.push_back(std::min(halfEdge, t));
+}
+
+template <class Coord, class Real>
+void BasicDcel<Coord, Real>::removeFace(index face)
+{
+    faces[face].polygon = npos;
+    faces[face].halfEdge = npos;
+    freeFaces.push_back(face);
+}
+
+template <class Coord, class Real>
+void BasicDcel<Coord, Real>::link(index prev, index next)
+{
+    halfEdges[prev].next = next;
+    halfEdges[next].prev = prev;
+}
+
+template <class Coord, class Real>
+DcelBase::index BasicDcel<Coord, Real>::destination(index halfEdge) const
+{
+    index t = halfEdges[halfEdge].twin;
+    if (t != npos)
+        return halfEdges[t].origin;
+    index n = halfEdges[halfEdge].next;
+    return n == npos ? npos : halfEdges[n].origin;
+}
+
+template <class Coord, class Real>
+void BasicDcel<Coord, Real>::faceNeighbours(
+    std::vector<index>& offsets,
+    std::vector<index>& neighbours) const
+{
+    // removed half-edges don't count, nor edges to removed faces
+    auto shared = [this](const HalfEdge& half) {
+        return half.twin != npos && !removed(half) &&
+               !removed(faces[half.face]) &&
+               !removed(faces[halfEdges[half.twin].face]);
+    };
+    offsets.assign(faces.size() + 1, 0);
+    for (const auto& half : halfEdges) {
+        if (shared(half))
+            ++offsets[half.face + 1];
+    }
+    for (size_t f = 0; f < faces.size(); ++f)
+        offsets[f + 1] += offsets[f];
+    neighbours.resize(offsets.back());
+    std::vector<index> fill(offsets.begin(), offsets.end() - 1);
+    for (const auto& half : halfEdges) {
+        if (shared(half))
+            neighbours[fill[half.face]++] = halfEdges[half.twin].face;
+    }
+}
+
+template <class Coord, class Real>
+void BasicDcel<Coord, Real>::clip(const Bounds& bounds)
+{
+    ClipBuffers buffers;
+    clip(bounds, buffers);
+}
+
+template <class Coord, class Real>
+void BasicDcel<Coord, Real>::clipEdges(const Bounds& bounds)
+{
+    ClipBuffers buffers;
+    clipEdges(bounds, buffers);
+}
+
+template <class Coord, class Real>
+void BasicDcel<Coord, Real>::clipEdges(const Bounds& bounds,
+                                       ClipBuffers& buffers,
+                                       const std::function<bool()>& stop)
+{
+    this->bounds = bounds;
+    const Border border(bounds);
+    const bool empty = bounds.width <= 0 || bounds.height <= 0;
+    const index edgeCount = (index) (halfEdges.size() / 2);
+
+    // clip every edge at once, the pair of twins h and h + 1 is edge h / 2
+    // and goes from origin(h) to origin(h + 1)
+    auto &x0 = buffers.x0, &y0 = buffers.y0, &x1 = buffers.x1;
+    auto &y1 = buffers.y1, &t0 = buffers.t0, &t1 = buffers.t1;
+    for (auto* coordinates : {&x0, &y0, &x1, &y1, &t0, &t1})
+        coordinates->resize(edgeCount);
+    const index batch = 1 << 16;
+    for (index begin = 0; begin < edgeCount; begin += batch) {
+        if (stop && stop())
+            return;
+        const index end = std::min(edgeCount, begin + batch);
+        for (index e = begin; e < end; ++e) {
+            index a = halfEdges[2 * e].origin, b = halfEdges[2 * e + 1].origin;
+            const Vertex& from = vertices[a == npos ? 0 : a];
+            const Vertex& to = vertices[b == npos ? 0 : b];
+            x0[e] = from.x;
+            y0[e] = from.y;
+            x1[e] = to.x;
+            y1[e] = to.y;
+        }
+        if (!vertices.empty())
+            clipSegments(bounds, end - begin, x0.data() + begin,
+                         y0.data() + begin, x1.data() + begin,
+                         y1.data() + begin, t0.data() + begin,
+                         t1.data() + begin);
+    }
+
+    // move surviving edges onto their clipped endpoints, vertices are
+    // rebuilt keeping only those still in use
+    auto& oldVertices = buffers.oldVertices;
+    oldVertices.swap(vertices);
+    vertices.clear();
+    auto& kept = buffers.kept;
+    kept.assign(oldVertices.size(), npos);
+    auto keep = [&](index v) {
+        if (kept[v] == npos)
+            kept[v] = addVertex(oldVertices[v]);
+        return kept[v];
+    };
+    auto clipped = [&](index e, double t) {
+        double x = x0[e] + t * (x1[e] - x0[e]);
+        double y = y0[e] + t * (y1[e] - y0[e]);
+        return addVertex(Vertex(PointF(std::clamp(x, border.x0, border.x1),
+                                       std::clamp(y, border.y0, border.y1))));
+    };
+    // an edge lying on the border is left to the border walk of clip, as it
+    // doesn't bound any area inside bounds
+    auto onBorder = [&](index e) {
+        return (x0[e] == x1[e] && (x0[e] == border.x0 || x0[e] == border.x1)) ||
+               (y0[e] == y1[e] && (y0[e] == border.y0 || y0[e] == border.y1));
+    };
+    auto& survives = buffers.survives;
+    survives.resize(edgeCount);
+    for (index e = 0; e < edgeCount; ++e) {
+        if (stop && e % 4096 == 0 && stop())
+            return;
+        HalfEdge& first = halfEdges[2 * e];
+        HalfEdge& second = halfEdges[2 * e + 1];
+        survives[e] = !empty && first.origin != npos &&
+                      second.origin != npos && t0[e] < t1[e] && !onBorder(e);
+        if (!survives[e]) {
+            first.origin = second.origin = npos;
+            continue;
+        }
+        first.origin = t0[e] > 0 ? clipped(e, t0[e]) : keep(first.origin);
+        second.origin = t1[e] < 1 ? clipped(e, t1[e]) : keep(second.origin);
+    }
+}
+
+template <class Coord, class Real>
+void BasicDcel<Coord, Real>::clip(const Bounds& bounds,
+                                  ClipBuffers& buffers,
+                                  const std::function<bool()>& stop)
+{
+    clipEdges(bounds, buffers, stop);
+    clipped = true;
+    if (stop && stop())
+        return;
+    const Border border(bounds);
+    const bool empty = bounds.width <= 0 || bounds.height <= 0;
+    const index edgeCount = (index) (halfEdges.size() / 2);
+    const index faceCount = (index) faces.size();
+    const auto& survives = buffers.survives;
+
+    // the walk around every face needs the links as the sweep left them,
+    // so bucket half-edges by face before unlinking them
+    auto& offsets = buffers.offsets;
+    offsets.assign(faceCount + 1, 0);
+    for (index h = 0; h < 2 * edgeCount; ++h)
+        ++offsets[halfEdges[h].face + 1];
+    for (index f = 0; f < faceCount; ++f)
+        offsets[f + 1] += offsets[f];
+    auto& faceEdges = buffers.faceEdges;
+    faceEdges.resize(offsets.back());
+    buffers.fill.assign(offsets.begin(), offsets.end() - 1);
+    for (index h = 0; h < 2 * edgeCount; ++h)
+        faceEdges[buffers.fill[halfEdges[h].face]++] = h;
+
+    index corners[4] = {npos, npos, npos, npos};
+    auto cornerVertex = [&](int k) {
+        if (corners[k % 4] == npos)
+            corners[k % 4] = addVertex(Vertex(border.corner(k)));
+        return corners[k % 4];
+    };
+    // clipped points that turn out to be the same point reached through two
+    // different edges are merged, each vertex refers to the one it merged
+    // into until the origins get resolved at the end
+    auto& merged = buffers.merged;
+    merged.clear();
+    auto resolve = [&](index v) {
+        if (merged.size() < vertices.size()) {
+            index first = (index) merged.size();
+            merged.resize(vertices.size());
+            for (index i = first; i < merged.size(); ++i)
+                merged[i] = i;
+        }
+        while (merged[v] != v)
+            v = merged[v] = merged[merged[v]];
+        return v;
+    };
+
+    auto& boundary = buffers.boundary;
+    for (index f = 0; f < faceCount; ++f) {
+        if (stop && f % 4096 == 0 && stop())
+            return;
+        Face& face = faces[f];
+
+        // half-edges of the face counter-clockwise, the boundary of a cell
+        // on the convex hull is one chain, or two for collinear sites
+        boundary.clear();
+        index h = face.halfEdge;
+        if (h != npos) {
+            do {
+                boundary.push_back(h);
+                h = halfEdges[h].next;
+            } while (h != npos && h != face.halfEdge);
+        }
+        if (h == npos) {
+            boundary.clear();
+            for (index i = offsets[f]; i < offsets[f + 1]; ++i) {
+                if (halfEdges[faceEdges[i]].prev != npos)
+                    continue;
+                for (h = faceEdges[i]; h != npos; h = halfEdges[h].next)
+                    boundary.push_back(h);
+            }
+        }
+        for (index i = offsets[f]; i < offsets[f + 1]; ++i)
+            halfEdges[faceEdges[i]].next = halfEdges[faceEdges[i]].prev = npos;
+        boundary.erase(std::remove_if(boundary.begin(), boundary.end(),
+                                      [&](index h) { return !survives[h / 2]; }),
+                       boundary.end());
+        face.halfEdge = boundary.empty() ? npos : boundary.front();
+
+        if (boundary.empty()) {
+            // bounds lies either entirely inside or outside the cell, it's
+            // inside if its center is nearer to the site than to any
+            // neighbour's
+            if (empty)
+                continue;
+            const PointF center((border.x0 + border.x1) / 2,
+                                (border.y0 + border.y1) / 2);
+            const double d = center.distance(PointF(face.site));
+            bool inside = true;
+            for (index i = offsets[f]; i < offsets[f + 1]; ++i) {
+                const Face& other = faces[halfEdges[twin(faceEdges[i])].face];
+                inside = inside && center.distance(PointF(other.site)) >= d;
+            }
+            if (!inside)
+                continue;
+            index first = npos, last = npos;
+            for (int k = 3; k < 7; ++k) {
+                index b = addHalfEdge(f, cornerVertex(k));
+                if (last != npos)
+                    link(last, b);
+                else
+                    first = b;
+                last = b;
+            }
+            link(last, first);
+            face.halfEdge = first;
+            continue;
+        }
+
+        // link consecutive half-edges, where a cell leaves bounds and
+        // enters it again walk along the border in between
+        for (size_t i = 0; i < boundary.size(); ++i) {
+            index cur = boundary[i];
+            index next = boundary[(i + 1) % boundary.size()];
+            index from = resolve(halfEdges[twin(cur)].origin);
+            index to = resolve(halfEdges[next].origin);
+            if (from == to) {
+                link(cur, next);
+                continue;
+            }
+            const double begin = border.position(vertices[from]);
+            double length = border.position(vertices[to]) - begin;
+            if (length < 0)
+                length += border.perimeter;
+            const double eps = 1e-9 * border.perimeter;
+            if (length <= eps || length >= border.perimeter - eps) {
+                merged[to] = from;
+                link(cur, next);
+                continue;
+            }
+            index prev = cur;
+            for (int k = 0; k < 8; ++k) {
+                double at = border.cornerPosition(k);
+                if (at <= begin || at >= begin + length)
+                    continue;
+                index b = addHalfEdge(f, from);
+                link(prev, b);
+                prev = b;
+                from = cornerVertex(k);
+            }
+            index b = addHalfEdge(f, from);
+            link(prev, b);
+            link(b, next);
+        }
+    }
+    for (auto& half : halfEdges) {
+        if (half.origin != npos)
+            half.origin = resolve(half.origin);
+    }
+}
+
+template class BasicDcel<int, double>;
+template class BasicDcel<int, float>;
+template class BasicDcel<double, double>;
+template class BasicDcel<int64_t, double>;
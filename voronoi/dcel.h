@@ -0,0 +1,166 @@
+#ifndef DCEL_H
+#define DCEL_H
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "geometry/point.h"
+#include "geometry/rectangle.h"
+
+/**
+ * @brief indices and half-edges, which don't depend on the coordinates
+ */
+class DcelBase
+{
+public:
+    using index = uint32_t;
+    static constexpr index npos = std::numeric_limits<index>::max();
+
+    struct HalfEdge {
+        index origin = npos;  // vertex this half-edge starts from
+        index twin = npos;    // half-edge on the other side of the edge
+        index next = npos;    // following half-edge around the same face
+        index prev = npos;    // preceding half-edge around the same face
+        index face = npos;    // face on the left of this half-edge
+    };
+};
+
+/**
+ * @brief BasicDcel is a doubly-connected edge list, vertices, half-edges and
+ * faces are stored in contiguous arrays and refer to each other by 32-bit
+ * indices. Sites have Coord coordinates, and vertices Real ones.
+ *
+ * Every voronoi edge is a pair of twin half-edges, one for each of the two
+ * faces it separates. A half-edge goes from its origin to the origin of its
+ * twin, and walking `next` goes counter-clockwise (in y-up coordinates)
+ * around its face. Links that are not known yet, like the origin of an edge
+ * still being traced by the sweep line, are npos.
+ */
+template <class Coord, class Real>
+class BasicDcel : public DcelBase
+{
+public:
+    using Site = BasicPoint<Coord>;
+    using Vertex = BasicPoint<Real>;
+    using Bounds = BasicRectangle<Coord>;
+
+    struct Face {
+        Site site;
+        index polygon;          // index of related polygon in Voronoi
+        index halfEdge = npos;  // any half-edge on boundary of this face
+    };
+
+    std::vector<Vertex> vertices;
+    std::vector<HalfEdge> halfEdges;
+    std::vector<Face> faces;
+
+    /**
+     * @brief rectangle the faces are clipped to, only meaningful once clip()
+     * has set `clipped`, or clipEdges() was called
+     */
+    Bounds bounds;
+    bool clipped = false;
+
+    void clear();
+
+    index addVertex(const Vertex& point);
+    index addFace(const Site& site, index polygon);
+    /**
+     * @brief create an edge between two faces as a pair of twin half-edges
+     * @return half-edge on face a, its twin on face b is the returned index + 1
+     */
+    index addEdge(index a, index b);
+    /**
+     * @brief create a half-edge without twin, like those along the border of
+     * the clip rectangle
+     */
+    index addHalfEdge(index face, index origin);
+
+    /**
+     * @brief release a vertex, a half-edge together with its twin, or a face,
+     * later additions reuse released slots. Released half-edges and faces
+     * stay in their arrays marked by a face, respectively polygon, of npos
+     */
+    void removeVertex(index vertex);
+    void removeEdge(index halfEdge);
+    void removeFace(index face);
+    bool removed(const HalfEdge& halfEdge) const { return halfEdge.face == npos; }
+    bool removed(const Face& face) const { return face.polygon == npos; }
+    /**
+     * @brief make `next` follow `prev` around their face
+     */
+    void link(index prev, index next);
+
+    index twin(index halfEdge) const { return halfEdges[halfEdge].twin; }
+    index origin(index halfEdge) const { return halfEdges[halfEdge].origin; }
+    /**
+     * @brief vertex a half-edge ends at, npos if unknown
+     */
+    index destination(index halfEdge) const;
+
+    /**
+     * @brief clip every face to bounds and close it along the border
+     * every vertex must be known, i.e. the sweep must be finished, and the
+     * dcel must not be clipped already. Afterwards
+     * every face is a closed counter-clockwise cycle, or has no half-edge if
+     * it doesn't reach into bounds. Border half-edges have no twin, edges
+     * entirely outside bounds keep their twin pair without vertices or links,
+     * so that faceNeighbours still reports both faces as neighbours
+     */
+    void clip(const Bounds& bounds);
+    /**
+     * @brief scratch arrays of clip, handing the same ones to every clip of
+     * a dcel that is swept again and again saves allocating them
+     */
+    struct ClipBuffers {
+        std::vector<double> x0, y0, x1, y1, t0, t1;
+        std::vector<index> offsets, faceEdges, fill;
+        std::vector<Vertex> oldVertices;
+        std::vector<index> kept, merged, boundary;
+        std::vector<bool> survives;
+    };
+    /**
+     * @param stop checked between batches of edges and faces, once it returns
+     * true clip returns and leaves the dcel half clipped
+     */
+    void clip(const Bounds& bounds,
+              ClipBuffers& buffers,
+              const std::function<bool()>& stop = nullptr);
+    /**
+     * @brief clip every edge to bounds but leave the faces open, for callers
+     * that only want the edges. Edges entirely outside bounds or along its
+     * border lose both vertices, links and faces stay as the sweep left them
+     * and `clipped` isn't set
+     * @param stop see clip
+     */
+    void clipEdges(const Bounds& bounds);
+    void clipEdges(const Bounds& bounds,
+                   ClipBuffers& buffers,
+                   const std::function<bool()>& stop = nullptr);
+
+    /**
+     * @brief collect neighbouring faces of every face, i.e. faces across a
+     * shared edge, neighbours of face f are stored in
+     * neighbours[offsets[f]] ... neighbours[offsets[f + 1] - 1]
+     */
+    void faceNeighbours(std::vector<index>& offsets,
+                        std::vector<index>& neighbours) const;
+
+private:
+    // released slots, freeEdges holds the first of twin pairs
+    std::vector<index> freeVertices;
+    std::vector<index> freeEdges;
+    std::vector<index> freeHalfEdges;
+    std::vector<index> freeFaces;
+};
+
+using Dcel = BasicDcel<int, double>;
+
+extern template class BasicDcel<int, double>;
+extern template class BasicDcel<int, float>;
+extern template class BasicDcel<double, double>;
+extern template class BasicDcel<int64_t, double>;
+
+#endif  // DCEL_H
@@ -0,0 +1,21 @@
+#include "delaunay.h"
+
+void Delaunay::clear()
+{
+    triangles.clear();
+    neighbours.clear();
+}
+
+Delaunay::index Delaunay::addTriangle(index a, index b, index c)
+{
+    index t = (index) size();
+    triangles.insert(triangles.end(), {a, b, c});
+    neighbours.insert(neighbours.end(), 3, npos);
+    return t;
+}
+
+void Delaunay::link(index side, index otherSide)
+{
+    neighbours[side] = otherSide / 3;
+    neighbours[otherSide] = side / 3;
+}
@@ -0,0 +1,50 @@
+#ifndef DELAUNAY_H
+#define DELAUNAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * @brief Delaunay is the triangulation dual to a Voronoi diagram, as an index
+ * buffer of triangles with links to their neighbours.
+ *
+ * Every vertex of the diagram is the circumcenter of a Delaunay triangle,
+ * whose corners are the sites of the cells meeting there. Corners are
+ * indices into Voronoi::polygons in counter-clockwise (in y-up coordinates)
+ * order. Four or more cocircular sites give several triangles with the same
+ * circumcenter.
+ */
+class Delaunay
+{
+public:
+    using index = uint32_t;
+    static constexpr index npos = std::numeric_limits<index>::max();
+
+    /**
+     * @brief corners of triangle t are triangles[3 * t] ... triangles[3 * t + 2]
+     */
+    std::vector<index> triangles;
+    /**
+     * @brief neighbours[3 * t + i] is the triangle across the side of t
+     * opposite to its i-th corner, npos for a side on the convex hull
+     */
+    std::vector<index> neighbours;
+
+    std::size_t size() const { return triangles.size() / 3; }
+    void clear();
+
+    /**
+     * @brief add a triangle without neighbours yet
+     * @return index of the new triangle
+     */
+    index addTriangle(index a, index b, index c);
+    /**
+     * @brief make two triangles neighbours across a shared side
+     * @param side 3 * t + i for the side of t opposite to its i-th corner
+     */
+    void link(index side, index otherSide);
+};
+
+#endif  // DELAUNAY_H
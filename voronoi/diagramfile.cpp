@@ -0,0 +1,233 @@
+#include "diagramfile.h"
+
+#include <cerrno>
+#include <cstring>
+
+namespace
+{
+// the file's numbers are little-endian and used in place
+bool littleEndian()
+{
+    const uint16_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+const char* const bigEndianError = "big-endian hosts aren't supported";
+
+// empty sections may have no storage at all
+bool writeAll(std::FILE* file, const void* data, size_t size)
+{
+    return size == 0 || std::fwrite(data, 1, size, file) == size;
+}
+}  // namespace
+
+bool DiagramFileView::open(const std::string& path, std::string& error)
+{
+    header = nullptr;
+    if (!littleEndian()) {
+        error = bigEndianError;
+        return false;
+    }
+    if (!file.open(path, error))
+        return false;
+    const char* data = file.data();
+    const size_t size = file.size();
+    if (size < sizeof(DiagramFileHeader) ||
+        std::memcmp(data, diagramFileMagic, sizeof(diagramFileMagic)) != 0) {
+        error = "not a diagram file";
+        return false;
+    }
+    const auto* h = reinterpret_cast<const DiagramFileHeader*>(data);
+    if (h->version != diagramFileVersion) {
+        error = "unsupported diagram file version " +
+                std::to_string(h->version);
+        return false;
+    }
+    // counts are checked against the size before they're multiplied, so
+    // that a damaged header can't overflow the expected size
+    const uint64_t sections[4] = {h->sites, h->vertices, h->edges, h->ring};
+    for (uint64_t count : sections) {
+        if (count > size) {
+            error = "diagram file is truncated";
+            return false;
+        }
+    }
+    const uint64_t expected = sizeof(DiagramFileHeader) + 16 * h->sites +
+                              16 * h->vertices + 16 * h->edges + 8 * h->ring;
+    if (expected != size) {
+        error = "diagram file has " + std::to_string(size) +
+                " bytes, its header says " + std::to_string(expected);
+        return false;
+    }
+
+    header = h;
+    const char* p = data + sizeof(DiagramFileHeader);
+    sites = reinterpret_cast<const int32_t*>(p);
+    p += 8 * h->sites;
+    cells = reinterpret_cast<const DiagramFileCell*>(p);
+    p += 8 * h->sites;
+    vertices = reinterpret_cast<const double*>(p);
+    p += 16 * h->vertices;
+    edges = reinterpret_cast<const DiagramFileEdge*>(p);
+    p += 16 * h->edges;
+    ring = reinterpret_cast<const uint32_t*>(p);
+    p += 4 * h->ring;
+    across = reinterpret_cast<const uint32_t*>(p);
+    return true;
+}
+
+Rectangle DiagramFileView::bounds() const
+{
+    return Rectangle(header->x, header->y, header->width, header->height);
+}
+
+DiagramFileWriter::DiagramFileWriter(const Voronoi& vmap,
+                                     const Rectangle& bounds)
+    : header{{}, diagramFileVersion, bounds.x, bounds.y, bounds.width,
+             bounds.height, vmap.polygons.size(), 0, 0, 0, 0}
+{
+    std::memcpy(header.magic, diagramFileMagic, sizeof(header.magic));
+    sites.reserve(2 * vmap.polygons.size());
+    for (const auto& polygon : vmap.polygons) {
+        sites.push_back(polygon->focus.x);
+        sites.push_back(polygon->focus.y);
+    }
+    cells.assign(vmap.polygons.size(), DiagramFileCell{0, 0});
+    added.assign(vmap.polygons.size(), false);
+    for (std::FILE*& spool : spools) {
+        spool = std::tmpfile();
+        failed = failed || !spool;
+    }
+}
+
+DiagramFileWriter::~DiagramFileWriter()
+{
+    for (std::FILE* spool : spools) {
+        if (spool)
+            std::fclose(spool);
+    }
+}
+
+void DiagramFileWriter::spool(int section, const void* data, size_t size)
+{
+    failed = failed || !writeAll(spools[section], data, size);
+}
+
+uint32_t DiagramFileWriter::addVertex(const PointF& vertex)
+{
+    const double xy[2] = {vertex.x, vertex.y};
+    spool(0, xy, sizeof(xy));
+    return (uint32_t) header.vertices++;
+}
+
+void DiagramFileWriter::addEdge(const DiagramFileEdge& edge)
+{
+    spool(1, &edge, sizeof(edge));
+    ++header.edges;
+}
+
+void DiagramFileWriter::addCell(uint32_t polygon,
+                                const uint32_t* vertices,
+                                const uint32_t* neighbours,
+                                size_t size)
+{
+    cells[polygon] = DiagramFileCell{(uint32_t) header.ring, (uint32_t) size};
+    added[polygon] = true;
+    spool(2, vertices, size * sizeof(uint32_t));
+    spool(3, neighbours, size * sizeof(uint32_t));
+    header.ring += size;
+}
+
+void DiagramFileWriter::add(const SweepLine::FinishedCell& cell)
+{
+    const size_t size = cell.vertices.size();
+    cellVertices.resize(size);
+    for (size_t i = 0; i < size; ++i)
+        cellVertices[i] = addVertex(cell.vertices[i]);
+    // the ring is counter-clockwise, so the cell is on the left of its edges
+    for (size_t i = 0; i < size; ++i) {
+        const uint32_t other = cell.neighbours[i];
+        if (other != Dcel::npos && !added[other]) {
+            addEdge(DiagramFileEdge{cellVertices[i],
+                                    cellVertices[i + 1 < size ? i + 1 : 0],
+                                    cell.polygon, other});
+        }
+    }
+    addCell(cell.polygon, cellVertices.data(), cell.neighbours.data(), size);
+}
+
+bool DiagramFileWriter::finish(const std::string& path, std::string& error)
+{
+    if (!littleEndian()) {
+        error = bigEndianError;
+        return false;
+    }
+    if (failed) {
+        error = "can't spool to temporary files";
+        return false;
+    }
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        error = std::strerror(errno);
+        return false;
+    }
+    bool written =
+        writeAll(file, &header, sizeof(header)) &&
+        writeAll(file, sites.data(), sites.size() * sizeof(int32_t)) &&
+        writeAll(file, cells.data(), cells.size() * sizeof(DiagramFileCell));
+    std::vector<char> buffer(1 << 20);
+    for (std::FILE* spool : spools) {
+        std::rewind(spool);
+        size_t got;
+        while (written &&
+               (got = std::fread(buffer.data(), 1, buffer.size(), spool)) > 0)
+            written = writeAll(file, buffer.data(), got);
+        written = written && !std::ferror(spool);
+    }
+    written = std::fclose(file) == 0 && written;
+    if (!written)
+        error = "write failed";
+    return written;
+}
+
+bool writeDiagramFile(const Voronoi& vmap,
+                      const std::string& path,
+                      std::string& error)
+{
+    const Dcel& dcel = vmap.dcel;
+    DiagramFileWriter writer(vmap, dcel.bounds);
+    for (const PointF& vertex : dcel.vertices)
+        writer.addVertex(vertex);
+    for (Dcel::index h = 0; h < dcel.halfEdges.size(); ++h) {
+        const Dcel::HalfEdge& half = dcel.halfEdges[h];
+        // every edge once, skipping those entirely outside the bounds
+        if (half.twin == Dcel::npos || half.twin < h || dcel.removed(half) ||
+            half.origin == Dcel::npos)
+            continue;
+        const Dcel::HalfEdge& twin = dcel.halfEdges[half.twin];
+        writer.addEdge(DiagramFileEdge{half.origin, twin.origin,
+                                       dcel.faces[half.face].polygon,
+                                       dcel.faces[twin.face].polygon});
+    }
+
+    std::vector<uint32_t> ring, across;
+    for (const Dcel::Face& face : dcel.faces) {
+        if (dcel.removed(face) || face.halfEdge == Dcel::npos)
+            continue;
+        ring.clear();
+        across.clear();
+        Dcel::index h = face.halfEdge;
+        do {
+            const Dcel::index t = dcel.twin(h);
+            ring.push_back(dcel.origin(h));
+            across.push_back(t == Dcel::npos
+                                 ? Dcel::npos
+                                 : dcel.faces[dcel.halfEdges[t].face].polygon);
+            h = dcel.halfEdges[h].next;
+        } while (h != face.halfEdge);
+        writer.addCell(face.polygon, ring.data(), across.data(), ring.size());
+    }
+    return writer.finish(path, error);
+}
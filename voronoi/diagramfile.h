@@ -0,0 +1,187 @@
+#ifndef DIAGRAMFILE_H
+#define DIAGRAMFILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "mappedfile.h"
+#include "sweepline.h"
+#include "voronoi.h"
+
+/**
+ * Finished diagrams are stored in a binary file laid out so that it can be
+ * mapped and used in place, without parsing. All numbers are little-endian,
+ * and the sections follow each other without padding, in this order:
+ *
+ *   header    DiagramFileHeader, 64 bytes
+ *   sites     int32 x and y of every polygon, in the order of the diagram's
+ *             polygons
+ *   cells     DiagramFileCell of every polygon, the range of its ring
+ *   vertices  double x and y of every vertex
+ *   edges     DiagramFileEdge of every edge between two cells, once
+ *   ring      uint32 vertex indices of the cells' rings, counter-clockwise
+ *             (in y-up coordinates)
+ *   across    uint32 polygon across the ring edge from ring[i] to the next
+ *             vertex of the same cell, npos along the border of bounds
+ *
+ * So every section is aligned to the size of its numbers. Polygons without
+ * a cell, like duplicates of an earlier site or cells outside bounds, have
+ * an empty ring. Files written from a dcel share vertices between cells,
+ * streamed ones don't, and where several vertices nearly coincide a cell
+ * can have an edge a few ulps long that its neighbour lacks.
+ */
+constexpr char diagramFileMagic[4] = {'V', 'D', 'G', 'M'};
+constexpr uint32_t diagramFileVersion = 1;
+
+struct DiagramFileHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t x, y, width, height;  // bounds the cells are clipped to
+    uint64_t sites;
+    uint64_t vertices;
+    uint64_t edges;
+    uint64_t ring;
+    uint64_t reserved;
+};
+static_assert(sizeof(DiagramFileHeader) == 64, "header layout");
+
+struct DiagramFileCell {
+    uint32_t first;  // first entry in ring and across
+    uint32_t size;   // number of vertices
+};
+
+struct DiagramFileEdge {
+    uint32_t from, to;     // vertices
+    uint32_t left, right;  // polygons on either side going from `from` to `to`
+};
+
+/**
+ * @brief DiagramFileView gives access to a mapped diagram file, references
+ * point into the mapping and stay valid until the view is opened again or
+ * destroyed
+ */
+class DiagramFileView
+{
+public:
+    static constexpr uint32_t npos = Dcel::npos;
+
+    /**
+     * @brief map path and check its header and size
+     * the sections aren't read, so a damaged file can still hold indices out
+     * of range
+     * @param error set to the reason if it fails
+     */
+    bool open(const std::string& path, std::string& error);
+
+    Rectangle bounds() const;
+
+    std::size_t siteCount() const { return header->sites; }
+    Point site(std::size_t i) const
+    {
+        return Point(sites[2 * i], sites[2 * i + 1]);
+    }
+
+    std::size_t vertexCount() const { return header->vertices; }
+    PointF vertex(std::size_t i) const
+    {
+        return PointF(vertices[2 * i], vertices[2 * i + 1]);
+    }
+
+    std::size_t edgeCount() const { return header->edges; }
+    const DiagramFileEdge& edge(std::size_t i) const { return edges[i]; }
+
+    /**
+     * @brief number of vertices of polygon c's cell
+     */
+    std::size_t cellSize(std::size_t c) const { return cells[c].size; }
+    /**
+     * @brief k-th vertex of polygon c's cell
+     */
+    PointF cellVertex(std::size_t c, std::size_t k) const
+    {
+        return vertex(ring[cells[c].first + k]);
+    }
+    /**
+     * @brief polygon across the edge of c's cell from its k-th vertex to the
+     * next one, npos along the border of bounds
+     */
+    uint32_t cellNeighbour(std::size_t c, std::size_t k) const
+    {
+        return across[cells[c].first + k];
+    }
+
+private:
+    MappedFile file;
+    const DiagramFileHeader* header = nullptr;
+    const int32_t* sites = nullptr;
+    const DiagramFileCell* cells = nullptr;
+    const double* vertices = nullptr;
+    const DiagramFileEdge* edges = nullptr;
+    const uint32_t* ring = nullptr;
+    const uint32_t* across = nullptr;
+};
+
+/**
+ * @brief DiagramFileWriter writes a diagram file while its vertices, edges
+ * and cells are added in any order, e.g. as SweepLine::streamFortune
+ * finishes the cells. Everything but the sites and cells is spooled to
+ * temporary files and copied behind them by finish, so memory stays
+ * proportional to the number of sites.
+ */
+class DiagramFileWriter
+{
+public:
+    /**
+     * @brief start the diagram of vmap's polygons clipped to bounds
+     */
+    DiagramFileWriter(const Voronoi& vmap, const Rectangle& bounds);
+    DiagramFileWriter(const DiagramFileWriter&) = delete;
+    DiagramFileWriter& operator=(const DiagramFileWriter&) = delete;
+    ~DiagramFileWriter();
+
+    uint32_t addVertex(const PointF& vertex);
+    void addEdge(const DiagramFileEdge& edge);
+    /**
+     * @brief set the cell of polygon to the given vertices and the polygons
+     * across its edges
+     */
+    void addCell(uint32_t polygon,
+                 const uint32_t* vertices,
+                 const uint32_t* neighbours,
+                 std::size_t size);
+    /**
+     * @brief add a cell streamed by SweepLine with its own vertices, and its
+     * edges to neighbours that weren't added yet
+     */
+    void add(const SweepLine::FinishedCell& cell);
+
+    /**
+     * @brief write everything added to path
+     * @param error set to the reason if it fails
+     */
+    bool finish(const std::string& path, std::string& error);
+
+private:
+    DiagramFileHeader header;
+    std::vector<int32_t> sites;
+    std::vector<DiagramFileCell> cells;
+    // vertices, edges, ring and across
+    std::FILE* spools[4] = {};
+    bool failed = false;
+    std::vector<uint32_t> cellVertices;
+    std::vector<bool> added;
+
+    void spool(int section, const void* data, std::size_t size);
+};
+
+/**
+ * @brief write the cells and edges of vmap's clipped dcel to path
+ * @param error set to the reason if it fails
+ */
+bool writeDiagramFile(const Voronoi& vmap,
+                      const std::string& path,
+                      std::string& error);
+
+#endif  // DIAGRAMFILE_H
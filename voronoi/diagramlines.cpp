@@ -0,0 +1,159 @@
+#include "diagramlines.h"
+
+#include <cstring>
+#include <functional>
+
+namespace
+{
+uint64_t bits(double value)
+{
+    // +0.0 and -0.0 are the same endpoint
+    value += 0.0;
+    uint64_t result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result;
+}
+}  // namespace
+
+std::size_t DiagramLines::KeyHash::operator()(const Key& key) const
+{
+    uint64_t h = bits(key.ax);
+    for (double value : {key.ay, key.bx, key.by})
+        h = (h ^ bits(value)) * 0x9e3779b97f4a7c15ull;
+    return std::hash<uint64_t>()(h ^ (h >> 32));
+}
+
+void DiagramLines::update(const Voronoi& vmap)
+{
+    ++generation;
+    for (const auto& polygon : vmap.polygons)
+        setCell(polygon.get());
+    for (auto it = cells.begin(); it != cells.end();) {
+        if (it->second.seen == generation) {
+            ++it;
+        } else {
+            dropCell(it->second);
+            it = cells.erase(it);
+        }
+    }
+    finish();
+}
+
+void DiagramLines::update(const std::vector<const Polygon*>& cells)
+{
+    ++generation;
+    for (const Polygon* polygon : cells)
+        setCell(polygon);
+    finish();
+}
+
+void DiagramLines::erase(const Polygon* polygon)
+{
+    auto it = cells.find(polygon);
+    if (it == cells.end())
+        return;
+    // the slots stay touched until the next update reports them
+    dropCell(it->second);
+    cells.erase(it);
+}
+
+void DiagramLines::clear()
+{
+    segments.clear();
+    added.clear();
+    removed.clear();
+    slotOf.clear();
+    cells.clear();
+    refs.clear();
+    state.clear();
+    freeSlots.clear();
+    touched.clear();
+}
+
+void DiagramLines::setCell(const Polygon* polygon)
+{
+    Cell& cell = cells[polygon];
+    cell.seen = generation;
+    // a cell that didn't change releases and acquires the same slots, which
+    // touches them but leaves them as they are
+    for (index slot : cell.segmentSlots)
+        release(slot);
+    cell.segmentSlots.clear();
+    for (const auto& edge : polygon->edges) {
+        if (!(edge->a && edge->b) || *edge->a == *edge->b)
+            continue;
+        cell.segmentSlots.push_back(acquire(*edge->a, *edge->b));
+    }
+}
+
+void DiagramLines::dropCell(Cell& cell)
+{
+    for (index slot : cell.segmentSlots)
+        release(slot);
+    cell.segmentSlots.clear();
+}
+
+DiagramLines::index DiagramLines::acquire(const PointF& a, const PointF& b)
+{
+    // the neighbour across walks the segment the other way
+    const bool forward = a.x < b.x || (a.x == b.x && a.y < b.y);
+    const PointF& from = forward ? a : b;
+    const PointF& to = forward ? b : a;
+    auto [it, inserted] = slotOf.try_emplace(Key{from.x, from.y, to.x, to.y});
+    if (inserted) {
+        if (freeSlots.empty()) {
+            it->second = (index) segments.size();
+            segments.emplace_back();
+            refs.push_back(0);
+            state.push_back(0);
+        } else {
+            it->second = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        segments[it->second] = Segment{from, to};
+    }
+    const index slot = it->second;
+    ++refs[slot];
+    touch(slot);
+    return slot;
+}
+
+void DiagramLines::release(index slot)
+{
+    --refs[slot];
+    touch(slot);
+}
+
+void DiagramLines::touch(index slot)
+{
+    if (!(state[slot] & touchedBit)) {
+        state[slot] |= touchedBit;
+        touched.push_back(slot);
+    }
+}
+
+void DiagramLines::finish()
+{
+    added.clear();
+    removed.clear();
+    for (index slot : touched) {
+        state[slot] &= ~touchedBit;
+        if (refs[slot] > 0) {
+            if (!(state[slot] & drawnBit)) {
+                state[slot] |= drawnBit;
+                added.push_back(slot);
+            }
+            continue;
+        }
+        // slots freed here are only reused by later updates, so a view can
+        // still look up what it drew for removed ones
+        if (state[slot] & drawnBit)
+            removed.push_back(slot);
+        state[slot] = 0;
+        const Segment& segment = segments[slot];
+        slotOf.erase(
+            Key{segment.a.x, segment.a.y, segment.b.x, segment.b.y});
+        freeSlots.push_back(slot);
+    }
+    touched.clear();
+}
@@ -0,0 +1,110 @@
+#ifndef DIAGRAMLINES_H
+#define DIAGRAMLINES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "voronoi.h"
+
+/**
+ * @brief DiagramLines keeps every segment of the polygons' edges once, however
+ * many cells share it, and which segments appeared or disappeared with the
+ * last update, so that a view only has to touch those.
+ *
+ * Segments are identified by their endpoints, which neighbouring cells take
+ * from the same dcel vertices, and live in slots that are reused once their
+ * segment disappeared. Edges with an unknown or coinciding endpoint aren't
+ * segments. A cell is remembered by its Polygon, so the cells of polygons
+ * that are erased have to be dropped with erase() before the Polygon is
+ * freed, another one may get its address.
+ */
+class DiagramLines
+{
+public:
+    using index = uint32_t;
+
+    struct Segment {
+        PointF a, b;
+    };
+
+    /**
+     * @brief take the edges of every polygon of vmap, and drop the cells of
+     * polygons that aren't in vmap anymore
+     */
+    void update(const Voronoi& vmap);
+    /**
+     * @brief take the edges of cells only, e.g. those Voronoi::insertSite
+     * reports as changed
+     */
+    void update(const std::vector<const Polygon*>& cells);
+    /**
+     * @brief drop the cell of polygon while it's still alive, e.g. before
+     * Voronoi::eraseSite, its segments count as removed by the next update
+     */
+    void erase(const Polygon* polygon);
+    void clear();
+
+    /**
+     * @brief number of slots, every slot in added and removed is below it
+     */
+    std::size_t slotCount() const { return segments.size(); }
+    /**
+     * @brief whether slot holds a segment of the current diagram
+     */
+    bool inUse(index slot) const { return state[slot] & drawnBit; }
+
+    /**
+     * @brief segment of every slot, only meaningful for slots in use
+     */
+    std::vector<Segment> segments;
+    /**
+     * @brief slots whose segment appeared and disappeared with the last
+     * update, a slot is never in both
+     */
+    std::vector<index> added;
+    std::vector<index> removed;
+
+private:
+    struct Key {
+        double ax, ay, bx, by;
+        bool operator==(const Key& other) const
+        {
+            return ax == other.ax && ay == other.ay && bx == other.bx &&
+                   by == other.by;
+        }
+    };
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const;
+    };
+    struct Cell {
+        // not named slots, which Qt defines as a macro
+        std::vector<index> segmentSlots;
+        uint64_t seen = 0;
+    };
+
+    std::unordered_map<Key, index, KeyHash> slotOf;
+    std::unordered_map<const Polygon*, Cell> cells;
+    // number of cells every slot's segment belongs to
+    std::vector<uint32_t> refs;
+    // drawn and touched bits of every slot
+    enum : uint8_t { drawnBit = 1, touchedBit = 2 };
+    std::vector<uint8_t> state;
+    std::vector<index> freeSlots;
+    // slots whose refs changed since the last update
+    std::vector<index> touched;
+    uint64_t generation = 0;
+
+    void setCell(const Polygon* polygon);
+    void dropCell(Cell& cell);
+    index acquire(const PointF& a, const PointF& b);
+    void release(index slot);
+    void touch(index slot);
+    /**
+     * @brief collect added and removed from the touched slots
+     */
+    void finish();
+};
+
+#endif  // DIAGRAMLINES_H
@@ -0,0 +1,69 @@
+#include "lloydrelaxation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "data_structure/parallelfor.h"
+#include "stripsweep.h"
+
+LloydRelaxation::LloydRelaxation(std::shared_ptr<Voronoi> vmap)
+    : LloydRelaxation(vmap, Rectangle(0, 0, vmap->width, vmap->height))
+{
+}
+
+LloydRelaxation::LloydRelaxation(std::shared_ptr<Voronoi> vmap,
+                                 const Rectangle& bounds)
+    : vmap(vmap),
+      bounds(bounds)
+{
+}
+
+double LloydRelaxation::step()
+{
+    if (!swept)
+        sweep();
+
+    auto& polygons = vmap->polygons;
+    const size_t n = polygons.size();
+    const unsigned moveThreads = chunkThreads(threads, n, 1 << 14);
+    std::vector<double> moved(moveThreads, 0);
+    forEachChunk(moveThreads, n, [&](unsigned t, size_t begin, size_t end) {
+        double farthest = 0;
+        for (size_t i = begin; i < end; ++i) {
+            Point& focus = polygons[i]->focus;
+            const Point centroid((int) std::lround(cellArrays.centroidX[i]),
+                                 (int) std::lround(cellArrays.centroidY[i]));
+            farthest = std::max(farthest, focus.distance(centroid));
+            focus = centroid;
+        }
+        moved[t] = farthest;
+    });
+
+    sweep();
+    return *std::max_element(moved.begin(), moved.end());
+}
+
+int LloydRelaxation::relax(int maxIterations, double tolerance)
+{
+    int iterations = 0;
+    while (iterations < maxIterations) {
+        ++iterations;
+        if (step() <= tolerance)
+            break;
+    }
+    return iterations;
+}
+
+void LloydRelaxation::sweep()
+{
+    if (threads == 1) {
+        sweepLine.loadVmap(vmap);
+        while (sweepLine.nextEvent() != sweepLine.LMAXVALUE)
+            ;
+        sweepLine.finishEdges(bounds, clipBuffers);
+    } else {
+        StripSweep(vmap).sweep(bounds, threads);
+    }
+    cellArrays.build(*vmap, threads);
+    swept = true;
+}
@@ -0,0 +1,70 @@
+#ifndef LLOYDRELAXATION_H
+#define LLOYDRELAXATION_H
+
+#include <memory>
+
+#include "cellarrays.h"
+#include "sweepline.h"
+
+/**
+ * @brief LloydRelaxation moves every site of a Voronoi to the centroid of its
+ * clipped cell, again and again, so that the diagram converges to a
+ * centroidal Voronoi tessellation.
+ *
+ * Every iteration sweeps with the same SweepLine into the same dcel and
+ * measures the cells into the same CellArrays, so once the first iteration
+ * has sized them no engine storage is allocated again. The polygons' edges
+ * aren't synced in between, call Voronoi::syncPolygons when done.
+ *
+ * Sites are integer points, a site moves to its cell's centroid rounded to
+ * the nearest one. Sites without a cell, i.e. duplicates, stay where they
+ * are.
+ */
+class LloydRelaxation
+{
+public:
+    /**
+     * @brief relax the sites of vmap within its width and height
+     */
+    explicit LloydRelaxation(std::shared_ptr<Voronoi> vmap);
+    LloydRelaxation(std::shared_ptr<Voronoi> vmap, const Rectangle& bounds);
+
+    std::shared_ptr<Voronoi> vmap;
+    // rectangle the cells are clipped to, sites never leave it
+    Rectangle bounds;
+    /**
+     * @brief threads to sweep and measure cells on, 0 for hardware
+     * concurrency. More than one sweeps strips in parallel with StripSweep,
+     * which keeps less of its storage between iterations
+     */
+    unsigned threads = 1;
+
+    /**
+     * @brief move every site to its cell's centroid and sweep again
+     * the first step sweeps the sites as they are before moving them
+     * @return largest distance a site moved
+     */
+    double step();
+    /**
+     * @brief step until no site moves farther than tolerance, or
+     * maxIterations steps were taken
+     * @return number of steps taken
+     */
+    int relax(int maxIterations, double tolerance = 0);
+
+    /**
+     * @brief cells of the current sites, valid after the first step
+     */
+    const CellArrays& cells() const { return cellArrays; }
+
+private:
+    SweepLine sweepLine;
+    Dcel::ClipBuffers clipBuffers;
+    CellArrays cellArrays;
+    // whether cellArrays belongs to the current sites
+    bool swept = false;
+
+    void sweep();
+};
+
+#endif  // LLOYDRELAXATION_H
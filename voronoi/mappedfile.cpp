@@ -0,0 +1,118 @@
+#include "mappedfile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+int openFile(const char* path)
+{
+    return _open(path, _O_RDONLY | _O_BINARY);
+}
+
+long readFile(int fd, char* data, std::size_t size)
+{
+    return _read(fd, data, (unsigned) std::min<std::size_t>(size, 1 << 30));
+}
+
+void closeFile(int fd)
+{
+    _close(fd);
+}
+#else
+int openFile(const char* path)
+{
+    return ::open(path, O_RDONLY | O_CLOEXEC);
+}
+
+long readFile(int fd, char* data, std::size_t size)
+{
+    return (long) ::read(fd, data, size);
+}
+
+void closeFile(int fd)
+{
+    ::close(fd);
+}
+#endif
+}  // namespace
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& path, std::string& error)
+{
+    close();
+    const int fd = openFile(path.c_str());
+    if (fd < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+    bool opened = false;
+#ifndef _WIN32
+    struct stat status;
+    if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode)) {
+        const std::size_t size = (std::size_t) status.st_size;
+        void* pages = size == 0 ? MAP_FAILED
+                                : mmap(nullptr, size, PROT_READ, MAP_PRIVATE,
+                                       fd, 0);
+        if (pages != MAP_FAILED) {
+            begin = static_cast<const char*>(pages);
+            length = size;
+            mapped = opened = true;
+        }
+    }
+#endif
+    if (!opened)
+        opened = read(fd, error);
+    closeFile(fd);
+    return opened;
+}
+
+void MappedFile::close()
+{
+#ifndef _WIN32
+    if (mapped)
+        munmap(const_cast<char*>(begin), length);
+#endif
+    begin = nullptr;
+    length = 0;
+    mapped = false;
+}
+
+bool MappedFile::read(int fd, std::string& error)
+{
+    buffer.resize(std::max<std::size_t>(buffer.size(), 1 << 16));
+    std::size_t size = 0;
+    for (;;) {
+        if (size == buffer.size())
+            buffer.resize(buffer.size() * 2);
+        const long got =
+            readFile(fd, buffer.data() + size, buffer.size() - size);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0) {
+            error = std::strerror(errno);
+            return false;
+        }
+        if (got == 0)
+            break;
+        size += (std::size_t) got;
+    }
+    begin = buffer.data();
+    length = size;
+    return true;
+}
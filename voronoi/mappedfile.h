@@ -0,0 +1,41 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief MappedFile is the read-only content of a file, mapped into memory
+ * where the system allows it, so that the pages are only read as they're
+ * touched and shared with the page cache. Files that can't be mapped, like
+ * pipes, are read into a buffer instead, which is kept for the next file.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    /**
+     * @brief map path, closing the file mapped before
+     * @param error set to the reason if it fails
+     */
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    const char* data() const { return begin; }
+    std::size_t size() const { return length; }
+
+private:
+    const char* begin = nullptr;
+    std::size_t length = 0;
+    bool mapped = false;
+    std::vector<char> buffer;
+
+    bool read(int fd, std::string& error);
+};
+
+#endif  // MAPPEDFILE_H
@@ -0,0 +1,314 @@
+#include "pointlocator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "data_structure/parallelfor.h"
+
+namespace
+{
+// scratch space of the expanding searches, kept per thread so that queries
+// don't allocate once it has grown to size
+struct ExpandState {
+    std::vector<std::pair<double, uint32_t>> frontier;
+    std::vector<uint32_t> seen;  // query stamp per face
+    uint32_t stamp = 0;
+};
+
+thread_local ExpandState expandState;
+}  // namespace
+
+PointLocator::PointLocator(const Voronoi& vmap)
+{
+    build(vmap);
+}
+
+void PointLocator::build(const Voronoi& vmap)
+{
+    const auto& faces = vmap.dcel.faces;
+    const size_t n = faces.size();
+    bucketSite.clear();
+    neighbours.clear();
+    facePolygon.clear();
+    columns = rows = 0;
+    if (n == 0)
+        return;
+
+    // faces freed by Voronoi::eraseSite keep their slot but aren't indexed
+    size_t first = 0;
+    while (first < n && vmap.dcel.removed(faces[first]))
+        ++first;
+    if (first == n)
+        return;
+    double maxX, maxY;
+    minX = maxX = faces[first].site.x;
+    minY = maxY = faces[first].site.y;
+    facePolygon.assign(n, npos);
+    for (size_t f = first; f < n; ++f) {
+        if (vmap.dcel.removed(faces[f]))
+            continue;
+        const Point& site = faces[f].site;
+        minX = std::min(minX, (double) site.x);
+        maxX = std::max(maxX, (double) site.x);
+        minY = std::min(minY, (double) site.y);
+        maxY = std::max(maxY, (double) site.y);
+        facePolygon[f] = faces[f].polygon;
+    }
+
+    std::vector<Dcel::index> neighbourFaces;
+    vmap.dcel.faceNeighbours(neighbourStart, neighbourFaces);
+    neighbours.resize(neighbourFaces.size());
+    for (size_t i = 0; i < neighbourFaces.size(); ++i) {
+        neighbours[i].point = PointF(faces[neighbourFaces[i]].site);
+        neighbours[i].face = neighbourFaces[i];
+    }
+
+    // about two buckets per site, also when the sites are (nearly) collinear
+    const double width = std::max(maxX - minX, 1.0);
+    const double height = std::max(maxY - minY, 1.0);
+    bucketSize = std::max(std::sqrt(width * height / (2 * n)),
+                          std::max(width, height) / n);
+    columns = (int) std::ceil(width / bucketSize) + 1;
+    rows = (int) std::ceil(height / bucketSize) + 1;
+
+    // every non-empty bucket starts from one of its own sites, the others
+    // inherit a site from the nearest non-empty bucket by breadth first search
+    bucketSite.assign((size_t) columns * rows, Site{PointF(0, 0), npos});
+    std::vector<uint32_t> queue;
+    queue.reserve(bucketSite.size());
+    for (size_t f = first; f < n; ++f) {
+        if (vmap.dcel.removed(faces[f]))
+            continue;
+        PointF site(faces[f].site);
+        uint32_t bucket =
+            (uint32_t) rowOf(site.y) * columns + columnOf(site.x);
+        if (bucketSite[bucket].face == npos) {
+            bucketSite[bucket] = Site{site, (uint32_t) f};
+            queue.push_back(bucket);
+        }
+    }
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const uint32_t bucket = queue[i];
+        const int column = (int) (bucket % columns);
+        const int row = (int) (bucket / columns);
+        auto visit = [&](int c, int r) {
+            if (c < 0 || c >= columns || r < 0 || r >= rows)
+                return;
+            uint32_t next = (uint32_t) r * columns + c;
+            if (bucketSite[next].face != npos)
+                return;
+            bucketSite[next] = bucketSite[bucket];
+            queue.push_back(next);
+        };
+        visit(column - 1, row);
+        visit(column + 1, row);
+        visit(column, row - 1);
+        visit(column, row + 1);
+    }
+}
+
+int PointLocator::columnOf(double x) const
+{
+    return std::clamp((int) std::floor((x - minX) / bucketSize), 0,
+                      columns - 1);
+}
+
+int PointLocator::rowOf(double y) const
+{
+    return std::clamp((int) std::floor((y - minY) / bucketSize), 0, rows - 1);
+}
+
+uint32_t PointLocator::locateFace(const PointF& point) const
+{
+    double distance;
+    return walk(point, distance);
+}
+
+uint32_t PointLocator::walk(const PointF& point, double& best) const
+{
+    if (bucketSite.empty())
+        return npos;
+
+    auto distance = [&point](const PointF& site) {
+        double dx = site.x - point.x;
+        double dy = site.y - point.y;
+        return dx * dx + dy * dy;
+    };
+    const Site& start =
+        bucketSite[(size_t) rowOf(point.y) * columns + columnOf(point.x)];
+    uint32_t bestFace = start.face;
+    best = distance(start.point);
+
+    // walk to the neighbour closest to point until there's none closer
+    for (uint32_t cur = npos; cur != bestFace;) {
+        cur = bestFace;
+        for (uint32_t i = neighbourStart[cur]; i < neighbourStart[cur + 1];
+             ++i) {
+            double d = distance(neighbours[i].point);
+            if (d < best) {
+                best = d;
+                bestFace = neighbours[i].face;
+            }
+        }
+    }
+    return bestFace;
+}
+
+uint32_t PointLocator::locate(const PointF& point) const
+{
+    uint32_t face = locateFace(point);
+    return face == npos ? npos : facePolygon[face];
+}
+
+void PointLocator::locate(const PointF* points,
+                          size_t count,
+                          uint32_t* cells,
+                          unsigned threads) const
+{
+    threads = chunkThreads(threads, count, 1 << 14);
+    if (count < bucketSite.size() / 4) {
+        forEachChunk(threads, count, [&](unsigned, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                cells[i] = locate(points[i]);
+        });
+        return;
+    }
+
+    // large batches are answered in bucket order, so that consecutive
+    // queries walk the same part of the diagram and stay in cache
+    std::vector<uint32_t> bucketOf(count);
+    std::vector<uint32_t> start(bucketSite.size() + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        bucketOf[i] =
+            (uint32_t) rowOf(points[i].y) * columns + columnOf(points[i].x);
+        ++start[bucketOf[i] + 1];
+    }
+    for (size_t b = 1; b < start.size(); ++b)
+        start[b] += start[b - 1];
+    std::vector<uint32_t> order(count);
+    for (size_t i = 0; i < count; ++i)
+        order[start[bucketOf[i]]++] = (uint32_t) i;
+
+    forEachChunk(threads, count, [&](unsigned, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            cells[order[i]] = locate(points[order[i]]);
+    });
+}
+
+template <class Visit>
+void PointLocator::expand(const PointF& point, Visit visit) const
+{
+    double firstDistance;
+    uint32_t first = walk(point, firstDistance);
+    if (first == npos)
+        return;
+
+    ExpandState& state = expandState;
+    if (state.seen.size() < facePolygon.size())
+        state.seen.resize(facePolygon.size(), 0);
+    if (++state.stamp == 0) {
+        std::fill(state.seen.begin(), state.seen.end(), 0);
+        state.stamp = 1;
+    }
+    auto& frontier = state.frontier;
+    auto closer = std::greater<std::pair<double, uint32_t>>();
+    frontier.clear();
+    frontier.emplace_back(firstDistance, first);
+    state.seen[first] = state.stamp;
+
+    while (!frontier.empty()) {
+        std::pop_heap(frontier.begin(), frontier.end(), closer);
+        auto [d, face] = frontier.back();
+        frontier.pop_back();
+        if (!visit(face, d))
+            return;
+        for (uint32_t i = neighbourStart[face]; i < neighbourStart[face + 1];
+             ++i) {
+            uint32_t next = neighbours[i].face;
+            if (state.seen[next] == state.stamp)
+                continue;
+            state.seen[next] = state.stamp;
+            double dx = neighbours[i].point.x - point.x;
+            double dy = neighbours[i].point.y - point.y;
+            frontier.emplace_back(dx * dx + dy * dy, next);
+            std::push_heap(frontier.begin(), frontier.end(), closer);
+        }
+    }
+}
+
+void PointLocator::nearest(const PointF& point,
+                           size_t k,
+                           std::vector<uint32_t>& cells) const
+{
+    cells.clear();
+    if (k == 0)
+        return;
+    expand(point, [&](uint32_t face, double) {
+        cells.push_back(facePolygon[face]);
+        return cells.size() < k;
+    });
+}
+
+void PointLocator::nearest(const PointF* points,
+                           size_t count,
+                           size_t k,
+                           uint32_t* cells,
+                           unsigned threads) const
+{
+    if (k == 0)
+        return;
+    threads = chunkThreads(threads, count, 1 << 12);
+    forEachChunk(threads, count, [&](unsigned, size_t begin, size_t end) {
+        std::vector<uint32_t> found;
+        found.reserve(k);
+        for (size_t i = begin; i < end; ++i) {
+            nearest(points[i], k, found);
+            uint32_t* out = std::copy(found.begin(), found.end(), cells + i * k);
+            std::fill(out, cells + (i + 1) * k, npos);
+        }
+    });
+}
+
+void PointLocator::within(const PointF& point,
+                          double radius,
+                          std::vector<uint32_t>& cells) const
+{
+    cells.clear();
+    if (radius < 0)
+        return;
+    const double limit = radius * radius;
+    expand(point, [&](uint32_t face, double d) {
+        if (d > limit)
+            return false;
+        cells.push_back(facePolygon[face]);
+        return true;
+    });
+}
+
+void PointLocator::within(const PointF* points,
+                          size_t count,
+                          double radius,
+                          std::vector<uint32_t>& offsets,
+                          std::vector<uint32_t>& cells,
+                          unsigned threads) const
+{
+    // every thread collects its chunk, then the chunks are concatenated
+    threads = chunkThreads(threads, count, 1 << 12);
+    std::vector<std::vector<uint32_t>> chunkCells(threads);
+    offsets.assign(count + 1, 0);
+    forEachChunk(threads, count, [&](unsigned t, size_t begin, size_t end) {
+        std::vector<uint32_t> found;
+        for (size_t i = begin; i < end; ++i) {
+            within(points[i], radius, found);
+            chunkCells[t].insert(chunkCells[t].end(), found.begin(),
+                                 found.end());
+            offsets[i + 1] = (uint32_t) found.size();
+        }
+    });
+    for (size_t i = 0; i < count; ++i)
+        offsets[i + 1] += offsets[i];
+    cells.clear();
+    cells.reserve(offsets.back());
+    for (const auto& chunk : chunkCells)
+        cells.insert(cells.end(), chunk.begin(), chunk.end());
+}
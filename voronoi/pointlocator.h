@@ -0,0 +1,137 @@
+#ifndef POINTLOCATOR_H
+#define POINTLOCATOR_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "voronoi.h"
+
+/**
+ * @brief PointLocator answers which cell of a finished Voronoi contains a
+ * point, in O(1) expected time.
+ *
+ * A point lies in the cell of its nearest site. The locator lays a uniform
+ * grid of about two buckets per site over the sites, and remembers for every
+ * bucket a site in or near it. A query starts at the site of its bucket and
+ * walks the neighbour graph of the diagram, moving to whichever neighbour is
+ * closer to the query. A site without a closer neighbour is the nearest
+ * site, so the walk is exact, and the grid keeps it short.
+ *
+ * Nearest neighbour and radius queries expand from the located cell in order
+ * of distance. The i-th nearest site always neighbours one of the i - 1
+ * nearer ones, so such an expansion only touches the answer and the cells
+ * bordering it.
+ *
+ * The locator copies what it needs, it stays valid after the Voronoi changes
+ * but then answers for the diagram it was built from.
+ */
+class PointLocator
+{
+public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    PointLocator() = default;
+    explicit PointLocator(const Voronoi& vmap);
+
+    /**
+     * @brief index the faces of vmap's dcel
+     */
+    void build(const Voronoi& vmap);
+
+    /**
+     * @brief find the cell containing point
+     * @return index into Voronoi::polygons, npos if the diagram is empty
+     */
+    uint32_t locate(const PointF& point) const;
+    /**
+     * @brief find the cell containing each point, split across threads
+     * @param points array of count points
+     * @param cells array of count indices into Voronoi::polygons to write to
+     * @param threads number of threads to use, 0 for hardware concurrency
+     */
+    void locate(const PointF* points,
+                size_t count,
+                uint32_t* cells,
+                unsigned threads = 0) const;
+
+    /**
+     * @brief find the dcel face whose site is nearest to point
+     * @return index into Dcel::faces, npos if the diagram is empty
+     */
+    uint32_t locateFace(const PointF& point) const;
+
+    /**
+     * @brief find the k cells whose sites are nearest to point
+     * @param cells filled with up to k indices into Voronoi::polygons, nearest
+     * first, fewer if the diagram has less than k cells
+     */
+    void nearest(const PointF& point,
+                 size_t k,
+                 std::vector<uint32_t>& cells) const;
+    /**
+     * @brief k nearest cells of each point, split across threads
+     * @param cells array of count * k indices to write to, the k cells of
+     * points[i] start at cells[i * k], missing ones are npos
+     */
+    void nearest(const PointF* points,
+                 size_t count,
+                 size_t k,
+                 uint32_t* cells,
+                 unsigned threads = 0) const;
+
+    /**
+     * @brief find all cells whose sites are within radius of point
+     * @param cells filled with indices into Voronoi::polygons, nearest first
+     */
+    void within(const PointF& point,
+                double radius,
+                std::vector<uint32_t>& cells) const;
+    /**
+     * @brief cells within radius of each point, split across threads
+     * @param offsets resized to count + 1, the cells of points[i] are
+     * cells[offsets[i]] ... cells[offsets[i + 1] - 1]
+     */
+    void within(const PointF* points,
+                size_t count,
+                double radius,
+                std::vector<uint32_t>& offsets,
+                std::vector<uint32_t>& cells,
+                unsigned threads = 0) const;
+
+private:
+    double minX = 0, minY = 0;
+    double bucketSize = 1;
+    int columns = 0, rows = 0;
+
+    struct Site {
+        PointF point;
+        uint32_t face;
+    };
+
+    // site to start walking from, for every bucket
+    std::vector<Site> bucketSite;
+
+    // neighbours of face f are
+    // neighbours[neighbourStart[f]] ... neighbours[neighbourStart[f + 1] - 1]
+    // with their sites stored inline, so a walk step reads one range
+    std::vector<uint32_t> neighbourStart;
+    std::vector<Site> neighbours;
+    std::vector<uint32_t> facePolygon;
+
+    /**
+     * @brief locateFace, also giving the squared distance to the found site
+     */
+    uint32_t walk(const PointF& point, double& distance) const;
+    /**
+     * @brief visit faces in order of increasing distance of their sites to
+     * point, as long as visit(face, squared distance) returns true
+     */
+    template <class Visit>
+    void expand(const PointF& point, Visit visit) const;
+
+    int columnOf(double x) const;
+    int rowOf(double y) const;
+};
+
+#endif  // POINTLOCATOR_H
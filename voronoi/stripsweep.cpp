@@ -0,0 +1,425 @@
+#include "stripsweep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "data_structure/parallelfor.h"
+#include "data_structure/radixsort.h"
+#include "sweepline.h"
+
+namespace
+{
+uint64_t sideKey(Dcel::index a, Dcel::index b)
+{
+    return (uint64_t) std::min(a, b) << 32 | std::max(a, b);
+}
+
+// a site seen from a line, at its foot on the line and its squared distance
+struct LineSite {
+    double at;
+    double distance2;
+    Dcel::index face;
+};
+
+/**
+ * @brief add the faces of sites nearest to some point of [from, to] on the
+ * line to faces
+ * the lower envelope of the squared distances to the sites, parabolas in the
+ * position on the line, is found by a single scan. Sites on the envelope at
+ * a single point or within rounding of it are kept too, so no nearest site
+ * is left out
+ * @param sites sorted by at, at most one per at
+ */
+void nearestOnLine(const std::vector<LineSite>& sites,
+                   double from,
+                   double to,
+                   std::vector<Dcel::index>& faces)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    // envelope so far, sites[envelope[k]] is nearest from start[k] on
+    std::vector<size_t> envelope;
+    std::vector<double> start;
+    for (size_t i = 0; i < sites.size(); ++i) {
+        const LineSite& q = sites[i];
+        double meet = -inf;
+        while (!envelope.empty()) {
+            const LineSite& p = sites[envelope.back()];
+            const double rise =
+                (q.distance2 - p.distance2) / (2 * (q.at - p.at));
+            const double middle = (q.at + p.at) / 2;
+            meet = rise + middle;
+            const double slack =
+                1e-9 * (std::abs(rise) + std::abs(middle) + 1);
+            if (meet + slack >= start.back())
+                break;
+            envelope.pop_back();
+            start.pop_back();
+            meet = -inf;
+        }
+        envelope.push_back(i);
+        start.push_back(meet);
+    }
+    const double slack = 1e-9 * (std::abs(from) + std::abs(to) + 1);
+    for (size_t k = 0; k < envelope.size(); ++k) {
+        const double end = k + 1 < envelope.size() ? start[k + 1] : inf;
+        if (start[k] <= to + slack && end >= from - slack)
+            faces.push_back(sites[envelope[k]].face);
+    }
+}
+}  // namespace
+
+struct StripSweep::Strip {
+    // faces whose cells this strip computes
+    Dcel::index begin, end;
+    // faces swept are [first, last), i.e. [begin, end) and a margin on both
+    // sides, and the border faces
+    Dcel::index first, last;
+    // face of vmap's dcel of every face of local
+    std::vector<Dcel::index> faces;
+    // diagram of the faces swept, closed but not clipped
+    std::shared_ptr<Voronoi> local;
+
+    bool owns(Dcel::index localFace) const
+    {
+        return faces[localFace] >= begin && faces[localFace] < end;
+    }
+};
+
+StripSweep::StripSweep(std::shared_ptr<Voronoi> vmap)
+    : vmap(vmap)
+{
+}
+
+void StripSweep::performFortune(unsigned threads)
+{
+    performFortune(Rectangle(0, 0, vmap->width, vmap->height), threads);
+}
+
+void StripSweep::performFortune(const Rectangle& bounds, unsigned threads)
+{
+    sweep(bounds, threads);
+    vmap->syncPolygons(threads);
+}
+
+void StripSweep::sweep(const Rectangle& bounds, unsigned threads)
+{
+    // the serial sweep's loadVmap sorts the sites and creates their faces,
+    // in (x, y) order
+    SweepLine serial(vmap);
+    Dcel& dcel = vmap->dcel;
+    const Dcel::index n = (Dcel::index) dcel.faces.size();
+    threads = chunkThreads(threads, n, 1 << 14);
+    if (threads < 2) {
+        while (serial.nextEvent() != serial.LMAXVALUE)
+            ;
+        serial.finishEdges(bounds);
+        return;
+    }
+
+    double minX = bounds.x, maxX = (double) bounds.x + bounds.width;
+    double minY = bounds.y, maxY = (double) bounds.y + bounds.height;
+    siteX.resize(n);
+    for (Dcel::index f = 0; f < n; ++f) {
+        const Point& site = dcel.faces[f].site;
+        siteX[f] = site.x;
+        minX = std::min<double>(minX, site.x);
+        maxX = std::max<double>(maxX, site.x);
+        minY = std::min<double>(minY, site.y);
+        maxY = std::max<double>(maxY, site.y);
+    }
+    extent = BasicRectangle<double>(minX, minY, maxX - minX, maxY - minY);
+    findBorderFaces(threads);
+
+    bucketSize = std::max(
+        1.0, std::sqrt((double) (extent.width + 1) * (extent.height + 1) / n));
+    columns = (int) (extent.width / bucketSize) + 1;
+    rows = (int) (extent.height / bucketSize) + 1;
+    auto bucketOf = [&](const Point& site) {
+        return (int) ((site.y - minY) / bucketSize) * columns +
+               (int) ((site.x - minX) / bucketSize);
+    };
+    bucketStart.assign((size_t) columns * rows + 1, 0);
+    for (Dcel::index f = 0; f < n; ++f)
+        ++bucketStart[bucketOf(dcel.faces[f].site) + 1];
+    for (size_t b = 1; b < bucketStart.size(); ++b)
+        bucketStart[b] += bucketStart[b - 1];
+    bucketFaces.resize(n);
+    std::vector<Dcel::index> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (Dcel::index f = 0; f < n; ++f)
+        bucketFaces[fill[bucketOf(dcel.faces[f].site)]++] = f;
+
+    // strips of about the same number of sites, sites on the same x stay in
+    // the same strip
+    std::vector<Strip> strips(threads);
+    std::vector<Dcel::index> borders(threads + 1, n);
+    for (unsigned s = 0; s < threads; ++s) {
+        Dcel::index b = (Dcel::index) ((uint64_t) n * s / threads);
+        while (b > 0 && b < n && siteX[b] == siteX[b - 1])
+            ++b;
+        borders[s] = std::max(b, s > 0 ? borders[s - 1] : 0);
+    }
+    for (unsigned s = 0; s < threads; ++s) {
+        strips[s].begin = borders[s];
+        strips[s].end = borders[s + 1];
+    }
+    forEachChunk(threads, threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t s = begin; s < end; ++s)
+            sweepStrip(strips[s]);
+    });
+
+    crossEdges.clear();
+    for (Strip& strip : strips) {
+        stitchStrip(strip);
+        strip.local.reset();
+    }
+    dcel.clip(bounds);
+}
+
+void StripSweep::findBorderFaces(unsigned threads)
+{
+    const auto& faces = vmap->dcel.faces;
+    const Dcel::index n = (Dcel::index) faces.size();
+    const double minX = extent.x, maxX = extent.getRight();
+    const double minY = extent.y, maxY = extent.getBottom();
+    borderFaces.clear();
+
+    // only the nearest site of every row or column can be nearest to a point
+    // on the side it faces
+    std::vector<LineSite> near, far;
+    auto square = [](double d) { return d * d; };
+    for (Dcel::index f = 0; f < n; ++f) {
+        const Point& site = faces[f].site;
+        if (f == 0 || siteX[f - 1] != site.x)
+            near.push_back({(double) site.x, square(site.y - minY), f});
+        if (f + 1 == n || siteX[f + 1] != site.x)
+            far.push_back({(double) site.x, square(maxY - site.y), f});
+    }
+    nearestOnLine(near, minX, maxX, borderFaces);
+    nearestOnLine(far, minX, maxX, borderFaces);
+
+    std::vector<Dcel::index> byY(n);
+    for (Dcel::index f = 0; f < n; ++f)
+        byY[f] = f;
+    parallelRadixSort(
+        byY,
+        [&](Dcel::index f) { return (uint64_t) (faces[f].site.y - extent.y); },
+        threads);
+    near.clear();
+    far.clear();
+    for (Dcel::index i = 0; i < n; ++i) {
+        const Point& site = faces[byY[i]].site;
+        if (i == 0 || faces[byY[i - 1]].site.y != site.y)
+            near.push_back({(double) site.y, square(site.x - minX), byY[i]});
+        if (i + 1 == n || faces[byY[i + 1]].site.y != site.y)
+            far.push_back({(double) site.y, square(maxX - site.x), byY[i]});
+    }
+    nearestOnLine(near, minY, maxY, borderFaces);
+    nearestOnLine(far, minY, maxY, borderFaces);
+
+    std::sort(borderFaces.begin(), borderFaces.end());
+    borderFaces.erase(std::unique(borderFaces.begin(), borderFaces.end()),
+                      borderFaces.end());
+}
+
+void StripSweep::sweepStrip(Strip& strip) const
+{
+    const Dcel::index n = (Dcel::index) siteX.size();
+    if (strip.begin == strip.end)
+        return;
+    const auto& faces = vmap->dcel.faces;
+    // a cell of uniform sites is final a few cells away from the margin's
+    // end, for a strip spanning the height that's about this many sites
+    size_t margin = (size_t) (4 * std::sqrt((double) n * (extent.height + 1) /
+                                            (extent.width + 1))) +
+                    16;
+    for (;;) {
+        strip.first = (Dcel::index) (strip.begin - std::min<size_t>(
+                                                      strip.begin, margin));
+        strip.last = (Dcel::index) std::min<size_t>(n, strip.end + margin);
+        while (strip.first > 0 && siteX[strip.first] == siteX[strip.first - 1])
+            --strip.first;
+        while (strip.last < n && siteX[strip.last] == siteX[strip.last - 1])
+            ++strip.last;
+
+        // in (x, y) order, so the local faces keep the order of their sites
+        strip.faces.clear();
+        auto borderFirst = std::lower_bound(borderFaces.begin(),
+                                            borderFaces.end(), strip.first);
+        auto borderLast =
+            std::lower_bound(borderFirst, borderFaces.end(), strip.last);
+        strip.faces.insert(strip.faces.end(), borderFaces.begin(),
+                           borderFirst);
+        for (Dcel::index f = strip.first; f < strip.last; ++f)
+            strip.faces.push_back(f);
+        strip.faces.insert(strip.faces.end(), borderLast, borderFaces.end());
+
+        strip.local = std::make_shared<Voronoi>(vmap->width, vmap->height);
+        for (Dcel::index f : strip.faces)
+            strip.local->addPoly(Polygon(faces[f].site));
+        SweepLine sweep(strip.local);
+        while (sweep.nextEvent() != sweep.LMAXVALUE)
+            ;
+        sweep.closeEdges(extent);
+
+        if ((strip.first == 0 && strip.last == n) || finalCells(strip))
+            return;
+        margin *= 4;
+    }
+}
+
+bool StripSweep::finalCells(const Strip& strip) const
+{
+    const Dcel& local = strip.local->dcel;
+    const double left = strip.first > 0
+                            ? siteX[strip.first - 1]
+                            : -std::numeric_limits<double>::infinity();
+    const double right = strip.last < siteX.size()
+                             ? siteX[strip.last]
+                             : std::numeric_limits<double>::infinity();
+
+    // a site that isn't swept cuts a cell iff it's nearer to one of its
+    // vertices than the cell's own site. Vertices out of extent have a
+    // border site nearest, which is swept, so only those inside can be cut
+    std::vector<uint8_t> checked(local.vertices.size());
+    for (const auto& half : local.halfEdges) {
+        if (!strip.owns(half.face))
+            continue;
+        const PointF site(local.faces[half.face].site);
+        for (Dcel::index v : {half.origin, local.halfEdges[half.twin].origin}) {
+            if (checked[v])
+                continue;
+            checked[v] = 1;
+            const PointF& p = local.vertices[v];
+            if (p.x <= extent.x || p.x >= extent.getRight() ||
+                p.y <= extent.y || p.y >= extent.getBottom())
+                continue;
+            const double r = p.distance(site);
+            // slack for the rounding of p and r
+            const double slack = 1e-9 * (std::abs(p.x) + r) + 1e-9;
+            if ((p.x - r - slack <= left || p.x + r + slack >= right) &&
+                !emptyCircle(strip, p, r + slack))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool StripSweep::emptyCircle(const Strip& strip,
+                             const PointF& center,
+                             double radius) const
+{
+    const double left = strip.first > 0
+                            ? siteX[strip.first - 1]
+                            : -std::numeric_limits<double>::infinity();
+    const double right = strip.last < siteX.size()
+                             ? siteX[strip.last]
+                             : std::numeric_limits<double>::infinity();
+    auto column = [&](double x) {
+        return (int) std::clamp((x - extent.x) / bucketSize, 0.0,
+                                columns - 1.0);
+    };
+    auto row = [&](double y) {
+        return (int) std::clamp((y - extent.y) / bucketSize, 0.0, rows - 1.0);
+    };
+    // columns of the circle's parts left and right of the sweep, rows of the
+    // circle within each column
+    for (auto [from, to] : {std::make_pair(center.x - radius, left),
+                            std::make_pair(right, center.x + radius)}) {
+        if (from > to)
+            continue;
+        for (int c = column(from); c <= column(to); ++c) {
+            const double x0 = extent.x + c * bucketSize, x1 = x0 + bucketSize;
+            const double dx = std::max({x0 - center.x, center.x - x1, 0.0});
+            if (dx > radius)
+                continue;
+            const double dy = std::sqrt(radius * radius - dx * dx);
+            for (int r = row(center.y - dy); r <= row(center.y + dy); ++r) {
+                const size_t b = (size_t) r * columns + c;
+                for (Dcel::index i = bucketStart[b]; i < bucketStart[b + 1];
+                     ++i) {
+                    const Dcel::index f = bucketFaces[i];
+                    if ((f >= strip.first && f < strip.last) ||
+                        std::binary_search(borderFaces.begin(),
+                                           borderFaces.end(), f))
+                        continue;
+                    const Point& site = vmap->dcel.faces[f].site;
+                    if (center.distance(site) <= radius)
+                        return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void StripSweep::stitchStrip(Strip& strip)
+{
+    const Dcel::index npos = Dcel::npos;
+    if (strip.begin == strip.end)
+        return;
+    Dcel& dcel = vmap->dcel;
+    const Dcel& local = strip.local->dcel;
+    std::vector<Dcel::index> vertex(local.vertices.size(), npos);
+    std::vector<Dcel::index> edge(local.halfEdges.size(), npos);
+
+    // edges shared with the strips before exist already, so do their
+    // vertices
+    for (Dcel::index h = 0; h < local.halfEdges.size(); ++h) {
+        const Dcel::HalfEdge& half = local.halfEdges[h];
+        if (!strip.owns(half.face))
+            continue;
+        const Dcel::index f = strip.faces[half.face];
+        const Dcel::index g = strip.faces[local.halfEdges[half.twin].face];
+        if (g >= strip.begin)
+            continue;
+        auto it = crossEdges.find(sideKey(f, g));
+        if (it == crossEdges.end())
+            continue;
+        Dcel::index e = it->second;
+        if (dcel.halfEdges[e].face != f)
+            e = dcel.twin(e);
+        edge[h] = e;
+        vertex[half.origin] = dcel.origin(e);
+        vertex[local.origin(half.twin)] = dcel.origin(dcel.twin(e));
+    }
+
+    auto vertexOf = [&](Dcel::index v) {
+        if (vertex[v] == npos)
+            vertex[v] = dcel.addVertex(local.vertices[v]);
+        return vertex[v];
+    };
+    for (Dcel::index h = 0; h < local.halfEdges.size(); ++h) {
+        const Dcel::HalfEdge& half = local.halfEdges[h];
+        if (!strip.owns(half.face) || edge[h] != npos)
+            continue;
+        const Dcel::index f = strip.faces[half.face];
+        const Dcel::index g = strip.faces[local.halfEdges[half.twin].face];
+        // the sweep creates an edge in the same event as the serial one, so
+        // it keeps the direction the edge is clipped in
+        const bool second = h % 2;
+        const Dcel::index pair =
+            second ? dcel.addEdge(g, f) : dcel.addEdge(f, g);
+        const Dcel::index e = pair + second;
+        dcel.halfEdges[e].origin = vertexOf(half.origin);
+        dcel.halfEdges[dcel.twin(e)].origin =
+            vertexOf(local.origin(half.twin));
+        edge[h] = e;
+        if (g >= strip.begin && g < strip.end)
+            edge[half.twin] = dcel.twin(e);
+        else
+            crossEdges.emplace(sideKey(f, g), pair);
+    }
+
+    for (Dcel::index h = 0; h < local.halfEdges.size(); ++h) {
+        const Dcel::HalfEdge& half = local.halfEdges[h];
+        if (strip.owns(half.face) && half.next != npos)
+            dcel.link(edge[h], edge[half.next]);
+    }
+    for (Dcel::index lf = 0; lf < local.faces.size(); ++lf) {
+        if (!strip.owns(lf))
+            continue;
+        Dcel::index h = local.faces[lf].halfEdge;
+        dcel.faces[strip.faces[lf]].halfEdge = h == npos ? npos : edge[h];
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef STRIPSWEEP_H
+#define STRIPSWEEP_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "geometry/rectangle.h"
+#include "voronoi.h"
+
+/**
+ * @brief StripSweep computes the same diagram as SweepLine::performFortune
+ * on several threads.
+ *
+ * Sites are split by x into one strip per thread, and every strip is swept
+ * on its own together with a margin of sites from the strips next to it and
+ * the border sites, whose cells reach out of the box around all sites.
+ * Beyond that box only border sites are nearest to anything, so there every
+ * strip's diagram is the full one. The cell of one of its own sites is final
+ * once no site left out of the sweep lies within the empty circle of any of
+ * its vertices inside the box. Circles within the x range swept pass right
+ * away, others are checked against a grid of the sites. A strip with cells
+ * that aren't final is swept again with a wider margin.
+ *
+ * The final cells are stitched into vmap's dcel along the edges they share
+ * with the neighbouring strips, and the whole diagram is clipped like a
+ * serial sweep's. Vertices come from the same circle events and the same
+ * closing directrix in both, so the result is the same as
+ * SweepLine::performFortune. No Delaunay triangulation is recorded.
+ */
+class StripSweep
+{
+public:
+    explicit StripSweep(std::shared_ptr<Voronoi> vmap);
+
+    std::shared_ptr<Voronoi> vmap;
+
+    /**
+     * @brief compute the diagram clipped to vmap's width and height
+     * @param threads number of strips and threads, 0 for hardware
+     * concurrency. Small inputs use fewer
+     */
+    void performFortune(unsigned threads = 0);
+    void performFortune(const Rectangle& bounds, unsigned threads = 0);
+    /**
+     * @brief compute the diagram clipped to bounds into vmap's dcel, like
+     * performFortune but without syncing the polygons' edges
+     */
+    void sweep(const Rectangle& bounds, unsigned threads = 0);
+
+private:
+    struct Strip;
+
+    /**
+     * @brief find the faces nearest to some point on the border of extent
+     */
+    void findBorderFaces(unsigned threads);
+    void sweepStrip(Strip& strip) const;
+    bool finalCells(const Strip& strip) const;
+    /**
+     * @brief whether no site left out of strip's sweep lies within or on the
+     * circle
+     */
+    bool emptyCircle(const Strip& strip,
+                     const PointF& center,
+                     double radius) const;
+    void stitchStrip(Strip& strip);
+
+    // box around all sites and the bounds, in double as its size doesn't
+    // always fit in int
+    BasicRectangle<double> extent;
+    // faces whose cells reach the border of extent, sorted
+    std::vector<Dcel::index> borderFaces;
+    // x of every face's site, faces are in (x, y) order
+    std::vector<int> siteX;
+    // uniform grid of about one site per bucket over extent, bucket b holds
+    // bucketFaces[bucketStart[b]] ... bucketFaces[bucketStart[b + 1] - 1]
+    double bucketSize = 1;
+    int columns = 0, rows = 0;
+    std::vector<Dcel::index> bucketStart;
+    std::vector<Dcel::index> bucketFaces;
+    // first half-edge of edges between a stitched strip and a later one, by
+    // their faces (min << 32 | max)
+    std::unordered_map<uint64_t, Dcel::index> crossEdges;
+};
+
+#endif  // STRIPSWEEP_H
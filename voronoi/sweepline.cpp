@@ -1,118 +1,129 @@
 #include "sweepline.h"
 
-#include <QDebug>
+#include <algorithm>
+#include <type_traits>
+
+#include "data_structure/radixsort.h"
+#include "geometry/predicates.h"
 
 // Use (void) to silence unused warnings.
 #define assertm(exp, msg) assert(((void) (msg), (exp)))
 
-/**
- * @brief calculate determinant
- * @param m 3 by 3 matrix of type double[3][3]
- * @return determinant
- */
-double det(double m[3][3])
-{
-    return (m[0][0] * m[1][1] * m[2][2] + m[0][1] * m[1][2] * m[2][0] +
-            m[0][2] * m[1][0] * m[2][1]) -
-           (m[0][2] * m[1][1] * m[2][0] + m[0][1] * m[1][0] * m[2][2] +
-            m[0][0] * m[1][2] * m[2][1]);
-}
-
 double distance(const PointF& a, const PointF& b)
 {
-    return sqrt(pow(a.x - b.x, 2) + pow(a.y - b.y, 2));
-}
-
-/**
- * @brief cross calculates cross product of oa cross ob
- * @param o orig point
- * @param a first vertex
- * @param b second vertex
- * @return value of oa cross ob
- */
-double cross(const PointF& o, const PointF& a, const PointF& b)
-{
-    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    double dx = a.x - b.x;
+    double dy = a.y - b.y;
+    return sqrt(dx * dx + dy * dy);
 }
 
 /**
- * @brief find circumcenter of three points by the following formula
- * https://zh.wikipedia.org/wiki/%E5%A4%96%E6%8E%A5%E5%9C%93#%E4%B8%89%E8%A7%92%E5%BD%A2%E7%9A%84%E5%A4%96%E6%8E%A5%E5%9C%93
- * @return PointF representing the circumcenter
+ * @brief map site to an unsigned key whose order matches (x, y) order
  */
-PointF findCircumcenter(const PointF& r1, const PointF& r2, const PointF& r3)
+static uint64_t siteKey(const Point& p)
 {
-    double X[3][3] = {{pow(r1.x, 2) + pow(r1.y, 2), r1.y, 1},
-                      {pow(r2.x, 2) + pow(r2.y, 2), r2.y, 1},
-                      {pow(r3.x, 2) + pow(r3.y, 2), r3.y, 1}};
-    double Y[3][3] = {{r1.x, pow(r1.x, 2) + pow(r1.y, 2), 1},
-                      {r2.x, pow(r2.x, 2) + pow(r2.y, 2), 1},
-                      {r3.x, pow(r3.x, 2) + pow(r3.y, 2), 1}};
-    double D[3][3] = {{r1.x, r1.y, 1}, {r2.x, r2.y, 1}, {r3.x, r3.y, 1}};
-    double DX = det(X);
-    double DY = det(Y);
-    double DD = det(D);
-    assertm(DD != 0, "three points are collinear, can't find circumcenter");
-    return PointF(DX / (2 * DD), DY / (2 * DD));
+    uint64_t x = (uint32_t) p.x ^ 0x80000000u;
+    uint64_t y = (uint32_t) p.y ^ 0x80000000u;
+    return x << 32 | y;
 }
 
-Parabola::Parabola(const Point& focus,
-                   const std::shared_ptr<Polygon>& poly,
-                   SelectivePriorityQueue<CircleEvent>::iterator eventIt)
+Parabola::Parabola(const PointF& focus,
+                   DcelBase::index face,
+                   CircleEventQueue::handle eventIt)
     : focus(focus),
-      poly(poly),
+      face(face),
       eventIt(eventIt)
 {
 }
 
 CircleEvent::CircleEvent(const PointF& center,
                          double x,
-                         std::list<Parabola>::iterator const& paraIt)
+                         BeachLine<Parabola>::iterator const& paraIt)
     : center(center),
       x(x),
       paraIt(paraIt)
 {
 }
 
-SweepLine::SweepLine(std::shared_ptr<Voronoi> vmap)
+template <class Coord, class Real, class Output>
+BasicSweepLine<Coord, Real, Output>::BasicSweepLine(
+    std::shared_ptr<Voronoi> vmap)
 {
     this->loadVmap(vmap);
 }
 
-void SweepLine::loadVmap(std::shared_ptr<Voronoi> vmap)
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::loadVmap(
+    std::shared_ptr<Voronoi> vmap)
 {
+    if constexpr (SweepStats::enabled)
+        stats.reset();
     this->vmap = vmap;
+    vmap->dcel.clear();
+    vmap->delaunay.clear();
+    edgeSide.clear();
+    edgesFinished = false;
     beachParas.clear();
     siteEvent.clear();
+    nextSite = 0;
     circleEvent.clear();
-    for (const auto& poly_sptr : vmap->polygons) {
-        poly_sptr->edges.clear();
-        poly_sptr->unOrganize();
-        this->addSite(poly_sptr);
+
+    const auto& polygons = vmap->polygons;
+    siteOrder.resize(polygons.size());
+    for (size_t i = 0; i < polygons.size(); ++i) {
+        polygons[i]->edges.clear();
+        polygons[i]->unOrganize();
+        siteOrder[i].index = (uint32_t) i;
+    }
+    // 32 bit sites fit a radix key, others are compared
+    if constexpr (std::is_same_v<Coord, int>) {
+        for (SortItem& item : siteOrder)
+            item.key = siteKey(polygons[item.index]->focus);
+        parallelRadixSort(siteOrder, siteOrderBuffer,
+                          [](const SortItem& item) { return item.key; });
+    } else {
+        std::stable_sort(siteOrder.begin(), siteOrder.end(),
+                         [&polygons](const SortItem& a, const SortItem& b) {
+                             return Site()(polygons[a.index]->focus,
+                                           polygons[b.index]->focus);
+                         });
     }
-}
 
-void SweepLine::addSite(const std::shared_ptr<Polygon>& poly)
-{
-    // prevent duplicate points
-    auto it = siteEvent.lower_bound(poly->focus);
-    if (it != siteEvent.end() && it->poly->focus == poly->focus)
-        return;
-    siteEvent.emplace(poly);
+    // sort is stable, so the first of duplicate points is kept
+    siteEvent.reserve(siteOrder.size());
+    vmap->dcel.faces.reserve(siteOrder.size());
+    for (size_t i = 0; i < siteOrder.size(); ++i) {
+        const Site& site = polygons[siteOrder[i].index]->focus;
+        if (i > 0 && polygons[siteOrder[i - 1].index]->focus == site)
+            continue;
+        index face = vmap->dcel.addFace(site, siteOrder[i].index);
+        siteEvent.emplace_back(PointF(site), face);
+    }
+    if constexpr (SweepStats::enabled) {
+        stats.endPhase("load", 0);
+        eventsStart = stats.now();
+    }
 }
 
-double SweepLine::nextEvent()
+template <class Coord, class Real, class Output>
+double BasicSweepLine<Coord, Real, Output>::nextEvent()
 {
     L = LMAXVALUE;
-    if (siteEvent.empty() && circleEvent.empty()) {
+    if (nextSite == siteEvent.size() && circleEvent.empty()) {
+        if constexpr (SweepStats::enabled) {
+            if (eventsStart >= 0)
+                stats.endPhase("events", eventsStart);
+            eventsStart = -1;
+        }
         return L;
     }
-    if (siteEvent.size() &&
-        (circleEvent.empty() || siteEvent.top().x < circleEvent.top().x)) {
+    if (nextSite < siteEvent.size() &&
+        (circleEvent.empty() || siteEvent[nextSite].x < circleEvent.top().x)) {
         // site event
-        L = siteEvent.top().x;
-        beachAdd(siteEvent.top().poly);
-        siteEvent.pop();
+        const SiteEvent& site = siteEvent[nextSite++];
+        L = site.x;
+        beachAdd(site.face);
+        if constexpr (SweepStats::enabled)
+            recordEvent(true);
         return L;
     };
     // circle event
@@ -135,98 +146,158 @@ double SweepLine::nextEvent()
     Parabola& pj = *event.paraIt;
     Parabola& pi = *std::prev(event.paraIt);
 
-    // new edge for parabola above and beneath pj
-    auto newEdge = std::make_shared<Edge>();
-    auto newPoint = std::make_shared<Point>(eventPoint);
-    newEdge->a = newPoint;
-    pk.bottomEdge = newEdge;
-    pk.poly->edges.push_back(newEdge);
-    pi.topEdge = newEdge;
-    pi.poly->edges.push_back(newEdge);
-
-    // close the edges for current parabola
-    if (!pj.bottomEdge->a) {
-        pj.bottomEdge->a = newPoint;
-    } else {
-        pj.bottomEdge->b = newPoint;
+    Dcel& dcel = vmap->dcel;
+    index newPoint = npos;
+    if constexpr (Output::vertices) {
+        newPoint = dcel.addVertex(Vertex(eventPoint));
+        if (emitCell) {
+            if (vertexFaces.size() <= newPoint)
+                vertexFaces.resize(newPoint + 1);
+            vertexFaces[newPoint] = 3;
+        }
     }
-    if (!pj.topEdge->a) {
-        pj.topEdge->a = newPoint;
-    } else {
-        pj.topEdge->b = newPoint;
+
+    // close the edges for current parabola, pi.topEdge and pk.bottomEdge are
+    // the twins of pj's edges
+    dcel.halfEdges[pi.topEdge].origin = newPoint;
+    dcel.halfEdges[pj.topEdge].origin = newPoint;
+    if constexpr (Output::cells)
+        dcel.link(pj.bottomEdge, pj.topEdge);
+
+    // new edge for parabola above and beneath pj, starting at newPoint
+    index newEdge = dcel.addEdge(pi.face, pk.face);
+    dcel.halfEdges[newEdge + 1].origin = newPoint;
+    if constexpr (Output::triangles)
+        addTriangle(pi, pj, pk, newEdge);
+    if constexpr (Output::cells) {
+        dcel.link(newEdge, pi.topEdge);
+        dcel.link(pk.bottomEdge, newEdge + 1);
     }
+    pi.topEdge = newEdge;
+    pk.bottomEdge = newEdge + 1;
 
     auto prev = std::prev(event.paraIt);
     auto next = std::next(event.paraIt);
+    const index removedFace = pj.face;
     if (event.paraIt != beachParas.end())
         beachParas.erase(event.paraIt);
     // update neighbour's event
     checkCircleEvent(prev);
     checkCircleEvent(next);
+    if (emitCell)
+        arcRemoved(removedFace);
+    if constexpr (SweepStats::enabled)
+        recordEvent(false);
     return L;
 }
 
-void SweepLine::beachAdd(const std::shared_ptr<Polygon>& poly)
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::recordEvent(bool site)
+{
+    ++(site ? stats.siteEvents : stats.circleEvents);
+    stats.peakBeachLine = std::max(stats.peakBeachLine, beachParas.size());
+    if ((stats.siteEvents + stats.circleEvents) % SweepStats::sampleInterval ==
+        0) {
+        stats.samples.push_back(SweepStats::Sample{
+            stats.now(), (uint32_t) beachParas.size(),
+            (uint32_t) circleEvent.size()});
+    }
+}
+
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::addTriangle(const Parabola& pi,
+                                                      const Parabola& pj,
+                                                      const Parabola& pk,
+                                                      index newEdge)
+{
+    const auto& faces = vmap->dcel.faces;
+    Delaunay& delaunay = vmap->delaunay;
+    // pi, pj, pk turn clockwise, see checkCircleEvent
+    Delaunay::index t = delaunay.addTriangle(faces[pi.face].polygon,
+                                             faces[pk.face].polygon,
+                                             faces[pj.face].polygon);
+    // the side opposite to a corner is dual to the edge between the other
+    // two cells, the sweep creates twins as pairs (2k, 2k + 1)
+    const index edges[3] = {pj.topEdge, pi.topEdge, newEdge};
+    edgeSide.resize(vmap->dcel.halfEdges.size() / 2, Delaunay::npos);
+    for (Delaunay::index i = 0; i < 3; ++i) {
+        Delaunay::index& side = edgeSide[edges[i] / 2];
+        if (side == Delaunay::npos)
+            side = 3 * t + i;
+        else
+            delaunay.link(side, 3 * t + i);
+    }
+}
+
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::beachAdd(index face)
 {
-    Parabola newPara(poly->focus, poly, circleEvent.end());
+    Dcel& dcel = vmap->dcel;
+    const PointF focus(dcel.faces[face].site);
+    Parabola newPara(focus, face, CircleEventQueue::npos);
+    if (emitCell)
+        ++faceArcs[face];
     if (beachParas.empty()) {
         beachParas.push_back(newPara);
         return;
     }
     // paraIt is an iterator pointing to the parabola that's going to be cut in
-    // half by newly added parabola
-    auto paraIt = beachParas.end();
-    for (auto it = beachParas.begin(); it != beachParas.end(); ++it) {
-        double intxn1 = -LMAXVALUE, intxn2 = LMAXVALUE;
-        if (it != beachParas.begin())
-            intxn1 = getIntersect(std::prev(it)->focus, it->focus).y;
-        if (std::next(it) != beachParas.end())
-            intxn2 = getIntersect(it->focus, std::next(it)->focus).y;
-        if (intxn1 <= poly->focus.y && poly->focus.y < intxn2) {
-            paraIt = it;
-            break;
-        }
-    }
-
-    if (paraIt->focus.x == poly->focus.x) {
+    // half by newly added parabola. Since the beach line is ordered by y, it's
+    // the first parabola whose intersection with the next one lies above the
+    // new focus, intersections are only evaluated along the search path
+    const double y = focus.y;
+    auto paraIt = beachParas.partition_point([this, y](auto it) {
+        auto next = std::next(it);
+        return next != beachParas.end() &&
+               getIntersect(it->focus, next->focus).y <= y;
+    });
+
+    if (paraIt->focus.x == focus.x) {
         // special case, first two or more point on same x coordinate
-        auto newEdge = std::make_shared<Edge>();
+        index newEdge = dcel.addEdge(paraIt->face, face);
         // the new edge will be a horizontal line, whose y is in the middle of
-        // two focus
-        newEdge->a = std::make_shared<Point>(
-            -LMAXVALUE, (paraIt->focus.y + poly->focus.y) / 2);
-        poly->edges.push_back(newEdge);
-        paraIt->poly->edges.push_back(newEdge);
-        if (paraIt->focus.y > poly->focus.y) {
+        // two focus, starting far left and traced to the right
+        index newPoint = npos;
+        if constexpr (Output::vertices) {
+            newPoint = dcel.addVertex(
+                Vertex(farLeft, (Real) ((paraIt->focus.y + focus.y) / 2)));
+        }
+        if (paraIt->focus.y > focus.y) {
+            dcel.halfEdges[newEdge].origin = newPoint;
             paraIt->bottomEdge = newEdge;
-            newPara.topEdge = newEdge;
+            newPara.topEdge = newEdge + 1;
             beachParas.insert(paraIt, std::move(newPara));
         } else {
+            dcel.halfEdges[newEdge + 1].origin = newPoint;
             paraIt->topEdge = newEdge;
-            newPara.bottomEdge = newEdge;
+            newPara.bottomEdge = newEdge + 1;
             beachParas.insert(std::next(paraIt), std::move(newPara));
         }
         return;
     }
 
-    Parabola dupPara(paraIt->focus, paraIt->poly, circleEvent.end());
-    auto newEdge = std::make_shared<Edge>();
-
-    poly->edges.push_back(newEdge);
-    paraIt->poly->edges.push_back(newEdge);
+    // both intersections of the new parabola trace the same edge, in opposite
+    // directions
+    Parabola dupPara(paraIt->focus, paraIt->face, CircleEventQueue::npos);
+    if (emitCell)
+        ++faceArcs[paraIt->face];
+    index newEdge = dcel.addEdge(paraIt->face, face);
 
     dupPara.topEdge = paraIt->topEdge;
     paraIt->topEdge = newEdge;
-    newPara.bottomEdge = newPara.topEdge = newEdge;
+    newPara.bottomEdge = newPara.topEdge = newEdge + 1;
     dupPara.bottomEdge = newEdge;
 
     beachParas.insert(std::next(paraIt), std::move(newPara));
     beachParas.insert(std::next(paraIt, 2), std::move(dupPara));
 
     // remove deprecated circle event
-    if (paraIt->eventIt != circleEvent.end())
+    if (paraIt->eventIt != CircleEventQueue::npos) {
         circleEvent.erase(paraIt->eventIt);
-    paraIt->eventIt = circleEvent.end();
+        if constexpr (SweepStats::enabled)
+            ++stats.circleEventsInvalidated;
+    }
+    paraIt->eventIt = CircleEventQueue::npos;
     // now paraIt points to the new parabola
     ++paraIt;
     // update neighbour's event
@@ -234,14 +305,19 @@ void SweepLine::beachAdd(const std::shared_ptr<Polygon>& poly)
     checkCircleEvent(std::next(paraIt));
 }
 
-void SweepLine::checkCircleEvent(std::list<Parabola>::iterator const& paraIt)
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::checkCircleEvent(
+    BeachLine<Parabola>::iterator const& paraIt)
 {
     Parabola& cur = *paraIt;
 
     // remove deprecated event
-    if (cur.eventIt != circleEvent.end())
+    if (cur.eventIt != CircleEventQueue::npos) {
         circleEvent.erase(cur.eventIt);
-    cur.eventIt = circleEvent.end();
+        if constexpr (SweepStats::enabled)
+            ++stats.circleEventsInvalidated;
+    }
+    cur.eventIt = CircleEventQueue::npos;
 
     // if cur is the first or last parabola in beachline, there's no way it can
     // generate an event
@@ -252,40 +328,225 @@ void SweepLine::checkCircleEvent(std::list<Parabola>::iterator const& paraIt)
     Parabola& next = *std::next(paraIt);
     // connect a line from `prev` to `cur` to `next`, it must be concave towards
     // where L is going for the circumcenter to be after `L` and be able to
-    // close `cur` parabola
-    if (cross(prev.focus, cur.focus, next.focus) >= 0)
+    // close `cur` parabola. The exact sign keeps nearly collinear foci from
+    // queuing events that never happen
+    const double turn = orientation(prev.focus, cur.focus, next.focus);
+    if (turn >= 0)
         return;
 
-    PointF center = findCircumcenter(prev.focus, cur.focus, next.focus);
+    PointF center = circumcenter(prev.focus, cur.focus, next.focus, turn);
     // center.x + radius of circumcircle = L's value when event happens
     double x = center.x + distance(cur.focus, center);
     auto eventIt = circleEvent.emplace(center, x, paraIt);
     cur.eventIt = eventIt;
+    if constexpr (SweepStats::enabled)
+        ++stats.circleEventsCreated;
+}
+
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::finishEdges()
+{
+    finishEdges(Bounds(0, 0, vmap->width, vmap->height));
+}
+
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::finishEdges(const Bounds& bounds)
+{
+    typename Dcel::ClipBuffers buffers;
+    finishEdges(bounds, buffers);
+}
+
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::finishEdges(
+    const Bounds& bounds,
+    typename Dcel::ClipBuffers& buffers,
+    const std::function<bool()>& stop)
+{
+    if constexpr (!Output::vertices)
+        return;
+    // the dcel is clipped already, and clip needs it unclipped
+    if (edgesFinished)
+        return;
+    edgesFinished = true;
+    // box around all sites and bounds, its size needn't fit in Coord
+    double minX = bounds.x, maxX = (double) bounds.x + bounds.width;
+    double minY = bounds.y, maxY = (double) bounds.y + bounds.height;
+    for (const auto& face : vmap->dcel.faces) {
+        minX = std::min(minX, (double) face.site.x);
+        maxX = std::max(maxX, (double) face.site.x);
+        minY = std::min(minY, (double) face.site.y);
+        maxY = std::max(maxY, (double) face.site.y);
+    }
+    {
+        SweepPhase phase(stats, "close edges");
+        closeEdges(Extent(minX, minY, maxX - minX, maxY - minY));
+    }
+    if (stop && stop())
+        return;
+    SweepPhase phase(stats, "clip");
+    if constexpr (Output::cells)
+        vmap->dcel.clip(bounds, buffers, stop);
+    else
+        vmap->dcel.clipEdges(bounds, buffers, stop);
 }
 
-void SweepLine::finishEdges()
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::closeEdges(const Extent& extent)
 {
-    // set L arbitrary large enough
-    L = 2 * vmap->width + 2 * vmap->height;
+    Dcel& dcel = vmap->dcel;
+    const double minX = extent.x, maxX = extent.getRight();
+    const double size = extent.width + extent.height;
+
+    // an intersection of parabolas is as far from their foci as from L, a
+    // point in the box is at most `size` away from its nearest site, hence
+    // with L this far right every intersection lies beyond the box
+    L = maxX + 2 * size + 1;
     for (auto it = beachParas.begin(); it != std::prev(beachParas.end());
          ++it) {
         PointF intersection = getIntersect(it->focus, std::next(it)->focus);
-        auto newPoint = std::make_shared<Point>(intersection);
-        if (!it->topEdge->a)
-            it->topEdge->a = newPoint;
-        else
-            it->topEdge->b = newPoint;
+        dcel.halfEdges[it->topEdge].origin =
+            dcel.addVertex(Vertex(intersection));
+    }
+    // edges between sites on the first x start infinitely far left
+    for (auto& vertex : dcel.vertices) {
+        if (vertex.x == farLeft)
+            vertex.x = (Real) (minX - size - 1);
+    }
+}
+
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::performFortune()
+{
+    performFortune(Bounds(0, 0, vmap->width, vmap->height));
+}
+
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::performFortune(const Bounds& bounds)
+{
+    while (nextEvent() != LMAXVALUE)
+        ;
+    finishEdges(bounds);
+    if constexpr (Output::polygons) {
+        SweepPhase phase(stats, "sync polygons");
+        vmap->syncPolygons();
     }
 }
 
-void SweepLine::performFortune()
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::stream(const Bounds& bounds,
+                                                  const CellCallback& callback)
 {
+    emitCell = &callback;
+    streamBounds = bounds;
+    faceArcs.assign(vmap->dcel.faces.size(), 0);
+    vertexFaces.clear();
     while (nextEvent() != LMAXVALUE)
         ;
-    finishEdges();
+    {
+        SweepPhase phase(stats, "finish stream");
+        finishStream();
+    }
+    emitCell = nullptr;
+}
+
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::arcRemoved(index face)
+{
+    if (--faceArcs[face] != 0)
+        return;
+    // the boundary is closed unless the cell reaches infinitely far left,
+    // which only cells of the first sites' column do
+    Dcel& dcel = vmap->dcel;
+    const index start = dcel.faces[face].halfEdge;
+    cellEdges.clear();
+    clipper.clear();
+    auto same = [](const Vertex& a, const Vertex& b) {
+        return a.x == b.x && a.y == b.y;
+    };
+    index h = start;
+    do {
+        if (h == npos)
+            return;
+        cellEdges.push_back(h);
+        const index other = dcel.halfEdges[dcel.twin(h)].face;
+        const Vertex& vertex = dcel.vertices[dcel.origin(h)];
+        // where more than three cells meet, the vertex is split by edges of
+        // zero length, which the cells cut out by finishStream don't have
+        if (!clipper.vertices.empty() && same(clipper.vertices.back(), vertex))
+            clipper.labels.back() = dcel.faces[other].polygon;
+        else
+            clipper.add(vertex, dcel.faces[other].polygon);
+        h = dcel.halfEdges[h].next;
+    } while (h != start);
+    if (clipper.vertices.size() > 1 &&
+        same(clipper.vertices.back(), clipper.vertices.front())) {
+        clipper.vertices.pop_back();
+        clipper.labels.pop_back();
+    }
+    clipper.clip(streamBounds, npos);
+    emitFace(face);
+
+    // free what no unfinished cell refers to anymore
+    for (index h : cellEdges) {
+        const index v = dcel.origin(h);
+        if (v < vertexFaces.size() && vertexFaces[v] > 0 &&
+            --vertexFaces[v] == 0)
+            dcel.removeVertex(v);
+        if (faceArcs[dcel.halfEdges[dcel.twin(h)].face] == finished)
+            dcel.removeEdge(h);
+    }
 }
 
-double SweepLine::parabolaX(const Point& focus, double y)
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::emitFace(index face)
+{
+    const typename Dcel::Face& f = vmap->dcel.faces[face];
+    (*emitCell)(FinishedCell{f.polygon, f.site, clipper.vertices,
+                             clipper.labels});
+    faceArcs[face] = finished;
+}
+
+template <class Coord, class Real, class Output>
+void BasicSweepLine<Coord, Real, Output>::finishStream()
+{
+    Dcel& dcel = vmap->dcel;
+    // half-edges of the faces left, by face
+    std::vector<std::pair<index, index>> open;
+    for (index h = 0; h < dcel.halfEdges.size(); ++h) {
+        const index face = dcel.halfEdges[h].face;
+        if (face != npos && faceArcs[face] != finished)
+            open.emplace_back(face, h);
+    }
+    std::sort(open.begin(), open.end());
+
+    // the boundaries of these cells aren't closed, and their open edges
+    // have no second vertex yet. But a cell is also the part of the plane
+    // nearer to its site than to any neighbour's, so it's cut out of bounds
+    // by the bisectors with its neighbours, which are exact
+    auto it = open.begin();
+    for (index face = 0; face < dcel.faces.size(); ++face) {
+        if (faceArcs[face] == finished)
+            continue;
+        const Site& site = dcel.faces[face].site;
+        clipper.assign(streamBounds, npos);
+        for (; it != open.end() && it->first == face; ++it) {
+            const typename Dcel::Face& other =
+                dcel.faces[dcel.halfEdges[dcel.twin(it->second)].face];
+            // the bisector runs through the midpoint with site on its left
+            const PointF middle((site.x + (double) other.site.x) / 2,
+                                (site.y + (double) other.site.y) / 2);
+            const PointF ahead(middle.x - ((double) other.site.y - site.y),
+                               middle.y + ((double) other.site.x - site.x));
+            clipper.clip(middle, ahead, other.polygon);
+        }
+        emitFace(face);
+    }
+    dcel.clear();
+}
+
+template <class Coord, class Real, class Output>
+double BasicSweepLine<Coord, Real, Output>::parabolaX(const PointF& focus,
+                                                     double y)
 {
     /**
      *  note parabola equation:
@@ -300,11 +561,13 @@ double SweepLine::parabolaX(const Point& focus, double y)
         // c >= 0 means `L`, our directrix, hasn't pass point `focus` yet
         return -LMAXVALUE;
     } else {
-        return pow(y - k, 2) / (4 * c) + h;
+        return (y - k) * (y - k) / (4 * c) + h;
     }
 }
 
-PointF SweepLine::getIntersect(const PointF& A, const PointF& B)
+template <class Coord, class Real, class Output>
+PointF BasicSweepLine<Coord, Real, Output>::getIntersect(const PointF& A,
+                                                         const PointF& B)
 {
     /**
      *  note parabola equation:
@@ -324,16 +587,26 @@ PointF SweepLine::getIntersect(const PointF& A, const PointF& B)
      *  b = -2k_1c_2 + 2k_2c_1
      *  c = k_1^2c_2-k_2^2c_1 + 4c_1c_2(h_1 - h_2)
      */
-    double ka = A.y;
-    double ha = (L + A.x) / 2.0;
-    double ca = -(L - A.x) / 2.0;
-    double kb = B.y;
-    double hb = (L + B.x) / 2.0;
-    double cb = -(L - B.x) / 2.0;
+    // relative to A, like circumcenter, so that the squares stay small far
+    // from the origin
+    const double bx = B.x - A.x, l = L - A.x;
+    double ka = 0;
+    double ha = l / 2.0;
+    double ca = -l / 2.0;
+    double kb = B.y - A.y;
+    double hb = (l + bx) / 2.0;
+    double cb = -(l - bx) / 2.0;
     double a = cb - ca;
     double b = -2 * (cb * ka - ca * kb);
     double c = -(4 * ca * cb * (hb - ha) - cb * ka * ka + ca * kb * kb);
-    double discriminant = b * b - 4 * a * c;
+    // rounding can take a discriminant that should be 0 below it
+    double discriminant = std::max(b * b - 4 * a * c, 0.0);
+    if (ca == 0 && cb != 0) {
+        // A is on the directrix, its parabola is the ray left from A
+        return PointF(A.x + (ka - kb) * (ka - kb) / (4 * cb) + hb, A.y);
+    }
+    if (cb == 0 && ca != 0)
+        return PointF(A.x + (kb - ka) * (kb - ka) / (4 * ca) + ha, B.y);
     if (a == 0) {
         // a == 0 means that A.x == B.x
         if (b == 0) {
@@ -341,11 +614,20 @@ PointF SweepLine::getIntersect(const PointF& A, const PointF& B)
             return PointF(-LMAXVALUE, (A.y + B.y) / 2);
         }
         double y = -c / b;
-        double x = pow(y - ka, 2) / (4 * ca) + ha;
-        return PointF((float) x, (float) y);
+        double x = (y - ka) * (y - ka) / (4 * ca) + ha;
+        return PointF(A.x + x, A.y + y);
     } else {
         double y = (-b - sqrt(discriminant)) / (2 * a);
-        double x = pow(y - ka, 2) / (4 * ca) + ha;
-        return PointF(x, y);
+        double x = (y - ka) * (y - ka) / (4 * ca) + ha;
+        return PointF(A.x + x, A.y + y);
     }
 }
+
+template class BasicSweepLine<int, double>;
+template class BasicSweepLine<int, float>;
+template class BasicSweepLine<double, double>;
+template class BasicSweepLine<int64_t, double>;
+template class BasicSweepLine<int, double, CellOutput>;
+template class BasicSweepLine<int, double, EdgeOutput>;
+template class BasicSweepLine<int, double, AdjacencyOutput>;
+template class BasicSweepLine<int, double, DelaunayOutput>;
@@ -2,66 +2,66 @@
 #define SWEEPLINE_H
 
 #include <cassert>
-#include <list>
+#include <functional>
+#include <type_traits>
 
-#include "data_structure/selectivepriorityqueue.h"
+#include "data_structure/beachline.h"
+#include "data_structure/indexedheap.h"
+#include "geometry/convexclipper.h"
 #include "geometry/polygon.h"
+#include "sweepstats.h"
 #include "voronoi.h"
 
 class CircleEvent;
 
+// min heap of circle events, handles stay valid until the event is erased
+using CircleEventQueue = IndexedHeap<CircleEvent, std::greater<>>;
+
 class Parabola
 {
 public:
-	Parabola(const Point& focus,
-			 const std::shared_ptr<Polygon>& poly,
-			 SelectivePriorityQueue<CircleEvent>::iterator eventIt);
+	Parabola(const PointF& focus,
+			 DcelBase::index face,
+			 CircleEventQueue::handle eventIt);
 	~Parabola() = default;
 
 	PointF focus;
 
 	/**
-	 * @brief records which polygon does this parabola referring to
+	 * @brief records which dcel face does this parabola referring to
+	 */
+	DcelBase::index face;
+	/**
+	 * @brief half-edges of `face` traced by the intersections with the
+	 * parabola beneath and above, bottomEdge runs towards the beach line and
+	 * topEdge away from it
 	 */
-	std::shared_ptr<Polygon> poly;
-	std::shared_ptr<Edge> bottomEdge, topEdge;
+	DcelBase::index bottomEdge = DcelBase::npos, topEdge = DcelBase::npos;
 
 	/**
-	 * @brief event iterator to event related to this parabola.
+	 * @brief handle to event related to this parabola, or
+	 * CircleEventQueue::npos if there's none.
 	 * use for efficient deletion purpose when the event gets invalidated
 	 */
-	SelectivePriorityQueue<CircleEvent>::iterator eventIt;
+	CircleEventQueue::handle eventIt;
 };
 
 class SiteEvent
 {
 public:
-	SiteEvent(const std::shared_ptr<Polygon>& poly)
-		: x(poly->focus.x),
-		  y(poly->focus.y),
-		  poly(poly)
+	SiteEvent(const PointF& site, DcelBase::index face)
+		: x(site.x),
+		  y(site.y),
+		  face(face)
 	{
 	}
 
 	double x;  // sweepline position when event happen
-	double y;  // site's y coordinate, for compare equal purpose
+	double y;  // site's y coordinate
 	/**
-	 * @brief polygon associated with this event
+	 * @brief dcel face associated with this event
 	 */
-	std::shared_ptr<Polygon> poly;
-
-	bool operator>(const SiteEvent& rhs) const
-	{
-		return std::tie(x, y) > std::tie(rhs.x, rhs.y);
-	}
-	friend bool operator>(const PointF& lhs, const SiteEvent& rhs)
-	{
-		return std::tie(lhs.x, lhs.y) > std::tie(rhs.x, rhs.y);
-	}
-	friend bool operator>(const SiteEvent& lhs, const PointF& rhs)
-	{
-		return std::tie(lhs.x, lhs.y) > std::tie(rhs.x, rhs.y);
-	}
+	DcelBase::index face;
 };
 
 class CircleEvent
@@ -69,7 +69,7 @@ class CircleEvent
 public:
 	CircleEvent(const PointF& center,
 				double x,
-				std::list<Parabola>::iterator const& paraIt);
+				BeachLine<Parabola>::iterator const& paraIt);
 
 	PointF center;  // center of the circumcenter
 	double x;       // sweepline position when event happen
@@ -78,41 +78,135 @@ public:
 	 * @brief parabola associated with this event
 	 * the one that'll be deleted from beachLine
 	 */
-	std::list<Parabola>::iterator const paraIt;
+	BeachLine<Parabola>::iterator paraIt;
+
+	/**
+	 * @brief later event first by x, ties by center and parabola's face
+	 * the order of simultaneous events decides the zero-length edges between
+	 * cocircular sites, so it mustn't depend on the order events were queued
+	 */
+	bool operator>(const CircleEvent& rhs) const
+	{
+		if (x != rhs.x)
+			return x > rhs.x;
+		if (center.y != rhs.center.y)
+			return center.y > rhs.center.y;
+		return paraIt->face > rhs.paraIt->face;
+	}
+};
+
+/**
+ * Output policies of BasicSweepLine, what a sweep builds is decided at
+ * compile time, and what isn't asked for isn't computed at all:
+ *   vertices   the vertices of the edges, closed and clipped to bounds
+ *   cells      the faces linked into closed cycles along the border of
+ *              bounds, needs vertices
+ *   polygons   the polygons' edges synced by performFortune, needs cells
+ *   triangles  vmap's Delaunay triangulation, one triangle per circle event
+ * Without vertices the dcel still holds every face and twin pair of edges of
+ * the unclipped diagram, which is all Dcel::faceNeighbours needs.
+ */
+struct PolygonOutput {
+	static constexpr bool vertices = true;
+	static constexpr bool cells = true;
+	static constexpr bool polygons = true;
+	static constexpr bool triangles = false;
+};
+
+// the clipped dcel, like the writers of cli use
+struct CellOutput {
+	static constexpr bool vertices = true;
+	static constexpr bool cells = true;
+	static constexpr bool polygons = false;
+	static constexpr bool triangles = false;
+};
+
+// every edge once, clipped to bounds, faces aren't closed
+struct EdgeOutput {
+	static constexpr bool vertices = true;
+	static constexpr bool cells = false;
+	static constexpr bool polygons = false;
+	static constexpr bool triangles = false;
+};
 
-	bool operator>(const CircleEvent& rhs) const { return x > rhs.x; }
+// which faces are neighbours, nothing but the dcel's twin pairs
+struct AdjacencyOutput {
+	static constexpr bool vertices = false;
+	static constexpr bool cells = false;
+	static constexpr bool polygons = false;
+	static constexpr bool triangles = false;
 };
 
-class SweepLine
+// vmap's Delaunay triangulation, the dcel holds what AdjacencyOutput does
+struct DelaunayOutput {
+	static constexpr bool vertices = false;
+	static constexpr bool cells = false;
+	static constexpr bool polygons = false;
+	static constexpr bool triangles = true;
+};
+
+/**
+ * @brief BasicSweepLine runs fortune's algorithm on the sites of a
+ * BasicVoronoi, whose sites have Coord coordinates and vertices Real ones,
+ * building what Output asks for.
+ * The beach line and events are always in double, rounding an event to float
+ * can move it past a site and break the diagram. The instantiations are
+ *   SweepLine                        int sites and double vertices
+ *   BasicSweepLine<int, float>       half the memory per vertex, sites are
+ *                                    exact up to 2^24
+ *   BasicSweepLine<double, double>   sub-pixel sites
+ *   BasicSweepLine<int64_t, double>  large integer worlds, sites are exact
+ *                                    up to 2^53
+ * all with polygons, and SweepLine's Coord and Real with every other output
+ * policy above.
+ */
+template <class Coord, class Real, class Output = PolygonOutput>
+class BasicSweepLine
 {
 public:
-	SweepLine() = default;
-	SweepLine(std::shared_ptr<Voronoi> vmap);
+	using Site = BasicPoint<Coord>;
+	using Vertex = BasicPoint<Real>;
+	using Bounds = BasicRectangle<Coord>;
+	using Extent = BasicRectangle<double>;
+	using Voronoi = BasicVoronoi<Coord, Real>;
+	using Dcel = BasicDcel<Coord, Real>;
+	using index = DcelBase::index;
+	static constexpr index npos = DcelBase::npos;
+
+	BasicSweepLine() = default;
+	BasicSweepLine(std::shared_ptr<Voronoi> vmap);
 
 	// sweep line position
 	double L;
+	// whether finishEdges ran since vmap was loaded, it doesn't run twice
+	bool edgesFinished = false;
 
-	// parabolas who made up the beach line
-	std::list<Parabola> beachParas;
+	// parabolas who made up the beach line, ordered by y
+	BeachLine<Parabola> beachParas;
 
-	// priority queues of events, min heap
-	SelectivePriorityQueue<SiteEvent, std::greater<>> siteEvent;
-	SelectivePriorityQueue<CircleEvent, std::greater<>> circleEvent;
+	// site events sorted by (x, y) without duplicates, and the next one to
+	// be processed
+	std::vector<SiteEvent> siteEvent;
+	size_t nextSite = 0;
+	// priority queue of circle events, min heap
+	CircleEventQueue circleEvent;
 
 	// voronoi map who stores important informations such as polygons
 	std::shared_ptr<Voronoi> vmap;
 
+	/**
+	 * @brief counters, phase times and a timeline of the last sweep, only
+	 * recorded when built with VORONOI_SWEEP_STATS
+	 */
+	SweepStats stats;
+
 	/**
 	 * @brief set vmap and load it's content for preparation
+	 * all sites are radix sorted by (x, y) into `siteEvent` and get a face in
+	 * vmap's dcel, polygons whose focus duplicates an earlier one are skipped
 	 * @param vmap shared_ptr to Voronoi
 	 */
 	void loadVmap(std::shared_ptr<Voronoi> vmap);
-	/**
-	 * @brief add site event
-	 * site event is represented as polygon
-	 * @param pol site event wrap up as polygon
-	 */
-	void addSite(const std::shared_ptr<Polygon>& poly);
 
 	/**
 	 * @brief process next event and return directrix value
@@ -122,35 +216,104 @@ public:
 
 	/**
 	 * @brief add parabola to beachline
-	 * @param poly polygon related to to-be added parabola
+	 * @param face dcel face related to to-be added parabola
 	 */
-	void beachAdd(const std::shared_ptr<Polygon>& poly);
+	void beachAdd(index face);
 
 	/**
 	 * @brief handles newly added circle event
 	 * also maintain existed circle event and remove deprecated events
 	 * @param event new circle event to add
 	 */
-	void checkCircleEvent(std::list<Parabola>::iterator const& paraIt);
+	void checkCircleEvent(BeachLine<Parabola>::iterator const& paraIt);
 
 	/**
-	 * @brief finish open edges
-	 * when all event are handled, there are still some open edges, and we need
-	 * to find the edges' other vertex, we can do so by setting directrix `L` to
-	 * a very large value and set those to intersections of parabolas
+	 * @brief finish open edges and clip the diagram to vmap's width and height
 	 */
 	void finishEdges();
+	/**
+	 * @brief finish open edges and clip the diagram to bounds
+	 * when all event are handled, there are still some open edges, and we need
+	 * to find the edges' other vertex, we can do so by setting directrix `L`
+	 * large enough for all remaining intersections of parabolas to lie beyond
+	 * bounds. Then every cell is clipped to bounds and closed along its border,
+	 * see Dcel::clip. Without cells in Output only the edges are clipped, see
+	 * Dcel::clipEdges, and without vertices there's nothing to finish. Once
+	 * finished, later calls do nothing until vmap is loaded again
+	 */
+	void finishEdges(const Bounds& bounds);
+	/**
+	 * @brief finishEdges, clipping with buffers kept by the caller
+	 * @param stop see Dcel::clip
+	 */
+	void finishEdges(const Bounds& bounds,
+					 typename Dcel::ClipBuffers& buffers,
+					 const std::function<bool()>& stop = nullptr);
+	/**
+	 * @brief give every open edge its missing vertex without clipping
+	 * the new vertices only depend on the edge's foci and extent, so sweeps of
+	 * different parts of the same sites agree on them
+	 * @param extent rectangle containing every site of the diagram, also
+	 * those not in this sweep, and the bounds it'll be clipped to. In double,
+	 * as its size doesn't always fit in Coord
+	 */
+	void closeEdges(const Extent& extent);
 
 	/**
-	 * @brief perform fortune's algorithm, and finish edges
+	 * @brief perform fortune's algorithm, finish edges and sync polygons
+	 * cells are clipped to vmap's width and height
 	 */
 	void performFortune();
+	/**
+	 * @brief perform fortune's algorithm, clip cells to bounds and sync
+	 * polygons, as far as Output asks for them
+	 */
+	void performFortune(const Bounds& bounds);
+
+	/**
+	 * @brief a cell handed out by streamFortune, only valid during the call
+	 */
+	struct FinishedCell {
+		index polygon;  // index of the cell's polygon in vmap
+		Site site;
+		/**
+		 * @brief vertices of the cell clipped to bounds, counter-clockwise
+		 * (in y-up coordinates), none if it doesn't reach into bounds
+		 */
+		const std::vector<Vertex>& vertices;
+		/**
+		 * @brief polygon on the other side of the edge from vertices[i] to
+		 * the next one, npos along the border of bounds
+		 */
+		const std::vector<index>& neighbours;
+	};
+	using CellCallback = std::function<void(const FinishedCell&)>;
+	/**
+	 * @brief perform fortune's algorithm on the loaded vmap and hand every
+	 * cell to callback as soon as it can't change anymore, clipped to bounds
+	 * a cell is finished once the last of its parabolas leaves the beach
+	 * line, its edges are freed as soon as the cell on their other side is
+	 * finished too, and their slots in vmap's dcel are reused. So the dcel
+	 * holds about as many edges as there are along the beach line instead
+	 * of the whole diagram, only cells on the convex hull and left of the
+	 * first sites wait until the end. Afterwards the dcel is cleared and
+	 * polygons get no edges, sites duplicating an earlier one aren't
+	 * emitted. Output must have cells and no triangles
+	 */
+	template <class O = Output>
+	void streamFortune(const Bounds& bounds, const CellCallback& callback)
+	{
+		static_assert(std::is_same_v<O, Output> && O::cells && !O::triangles,
+					  "cells need their vertices and links, and triangles "
+					  "can't be linked across edges that were freed");
+		stream(bounds, callback);
+	}
 
 	/**
 	 * @brief returns parabola's x value given y
 	 * with directrix using member variable `L`
 	 */
-	double parabolaX(const Point& focus, double y);
+	double parabolaX(const PointF& focus, double y);
 
 	/**
 	 * @brief get intersection of two parabola given focus point A and B
@@ -160,11 +323,83 @@ public:
 	 * @return intersection point of two parabola
 	 */
 	PointF getIntersect(const PointF& A, const PointF& B);
-	PointF getIntersect(const Point& A, const Point& B);
+
+private:
+	// per voronoi edge, i.e. twin pair, the side of the first triangle found
+	// at one of its ends, the triangle at the other end is its neighbour
+	std::vector<Delaunay::index> edgeSide;
+	// when the event loop started, negative once its phase is recorded
+	double eventsStart = -1;
+
+	// sites by (x, y) key, kept with the sort's buffer to load again
+	// without allocating
+	struct SortItem {
+		uint64_t key;
+		uint32_t index;
+	};
+	std::vector<SortItem> siteOrder, siteOrderBuffer;
+
+	// x of the vertices edges start at when they come from infinitely far
+	// left, until closeEdges moves them
+	static constexpr Real farLeft = -std::numeric_limits<Real>::max();
+
+	// while streaming, the callback and bounds, how many parabolas each face
+	// has on the beach line or `finished` once it's emitted, and how many
+	// unfinished faces meet at each vertex of a circle event
+	const CellCallback* emitCell = nullptr;
+	Bounds streamBounds;
+	static constexpr index finished = npos;
+	std::vector<index> faceArcs;
+	std::vector<uint8_t> vertexFaces;
+	std::vector<index> cellEdges;
+	BasicConvexClipper<Real> clipper;
+
+	/**
+	 * @brief count an event that was just handled and sample the sizes
+	 */
+	void recordEvent(bool site);
+
+	/**
+	 * @brief while streaming, a parabola of face left the beach line, emit
+	 * and free the face if it was the last one and its boundary is closed
+	 */
+	void arcRemoved(index face);
+	/**
+	 * @brief hand the cell in clipper to emitCell and mark face finished
+	 */
+	void emitFace(index face);
+	/**
+	 * @brief streamFortune, which checks Output when it's instantiated
+	 */
+	void stream(const Bounds& bounds, const CellCallback& callback);
+	/**
+	 * @brief emit the faces left
+	 */
+	void finishStream();
+
+	/**
+	 * @brief record the triangle of a circle event that removes pj, before
+	 * pi's and pk's edges are moved to newEdge
+	 */
+	void addTriangle(const Parabola& pi,
+					 const Parabola& pj,
+					 const Parabola& pk,
+					 index newEdge);
 
 public:
 	const double LMAXVALUE = std::numeric_limits<double>::max();
 	const float MAXVALUE = std::numeric_limits<float>::max();
 };
 
+using SweepLine = BasicSweepLine<int, double>;
+
+extern template class BasicSweepLine<int, double>;
+extern template class BasicSweepLine<int, float>;
+extern template class BasicSweepLine<double, double>;
+extern template class BasicSweepLine<int64_t, double>;
+extern template class BasicSweepLine<int, double, CellOutput>;
+extern template class BasicSweepLine<int, double, EdgeOutput>;
+extern template class BasicSweepLine<int, double, AdjacencyOutput>;
+extern template class BasicSweepLine<int, double, DelaunayOutput>;
+
 #endif  // SWEEPLINE_H
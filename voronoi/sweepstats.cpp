@@ -0,0 +1,51 @@
+#include "sweepstats.h"
+
+void SweepStats::reset()
+{
+    *this = SweepStats();
+    origin = std::chrono::steady_clock::now();
+}
+
+double SweepStats::now() const
+{
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - origin)
+        .count();
+}
+
+void SweepStats::endPhase(const char* name, double start)
+{
+    phases.push_back(Phase{name, start, now() - start});
+}
+
+void SweepStats::writeChromeTrace(std::FILE* file) const
+{
+    std::fprintf(file, "{\"traceEvents\": [\n");
+    const char* separator = "";
+    for (const Phase& phase : phases) {
+        std::fprintf(file,
+                     "%s{\"name\": \"%s\", \"cat\": \"sweep\", \"ph\": \"X\", "
+                     "\"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": 1}",
+                     separator, phase.name, phase.start, phase.duration);
+        separator = ",\n";
+    }
+    for (const Sample& sample : samples) {
+        std::fprintf(file,
+                     "%s{\"name\": \"sizes\", \"ph\": \"C\", \"ts\": %.3f, "
+                     "\"pid\": 1, \"args\": {\"beach line\": %u, "
+                     "\"circle events\": %u}}",
+                     separator, sample.time, sample.beachLine,
+                     sample.circleEvents);
+        separator = ",\n";
+    }
+    std::fprintf(file,
+                 "\n],\n\"displayTimeUnit\": \"ms\",\n"
+                 "\"otherData\": {\"site events\": %llu, "
+                 "\"circle events\": %llu, \"circle events created\": %llu, "
+                 "\"circle events invalidated\": %llu, "
+                 "\"peak beach line\": %zu}\n}\n",
+                 (unsigned long long) siteEvents,
+                 (unsigned long long) circleEvents,
+                 (unsigned long long) circleEventsCreated,
+                 (unsigned long long) circleEventsInvalidated, peakBeachLine);
+}
@@ -0,0 +1,98 @@
+#ifndef SWEEPSTATS_H
+#define SWEEPSTATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/**
+ * @brief SweepStats tells what a SweepLine did and where its time went, to
+ * find out what makes an input slow.
+ *
+ * Recording is compiled in with VORONOI_SWEEP_STATS defined, for instance by
+ * qmake CONFIG+=sweep_stats. Otherwise SweepLine doesn't touch its stats and
+ * they stay empty.
+ */
+struct SweepStats {
+#ifdef VORONOI_SWEEP_STATS
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+    // beach line and queue sizes are sampled once per this many events
+    static constexpr uint64_t sampleInterval = 1024;
+
+    struct Phase {
+        const char* name;
+        double start;  // microseconds since the sweep started
+        double duration;
+    };
+    struct Sample {
+        double time;
+        uint32_t beachLine;
+        uint32_t circleEvents;
+    };
+
+    uint64_t siteEvents = 0;
+    // circle events that happened
+    uint64_t circleEvents = 0;
+    // circle events queued, and those removed again before they happened
+    uint64_t circleEventsCreated = 0;
+    uint64_t circleEventsInvalidated = 0;
+    size_t peakBeachLine = 0;
+    // in the order they ended
+    std::vector<Phase> phases;
+    std::vector<Sample> samples;
+
+    /**
+     * @brief forget everything and start the clock
+     */
+    void reset();
+    /**
+     * @brief microseconds since reset
+     */
+    double now() const;
+    /**
+     * @brief record a phase from start until now
+     */
+    void endPhase(const char* name, double start);
+
+    /**
+     * @brief write phases and samples as a timeline in Chrome's trace event
+     * format, which chrome://tracing and Perfetto open, with the counters as
+     * metadata
+     */
+    void writeChromeTrace(std::FILE* file) const;
+
+private:
+    std::chrono::steady_clock::time_point origin;
+};
+
+/**
+ * @brief records a phase into stats from construction to destruction, if
+ * recording is enabled
+ */
+class SweepPhase
+{
+public:
+    SweepPhase(SweepStats& stats, const char* name)
+        : stats(stats),
+          name(name)
+    {
+        if constexpr (SweepStats::enabled)
+            start = stats.now();
+    }
+    ~SweepPhase()
+    {
+        if constexpr (SweepStats::enabled)
+            stats.endPhase(name, start);
+    }
+
+private:
+    SweepStats& stats;
+    const char* name;
+    double start = 0;
+};
+
+#endif  // SWEEPSTATS_H
@@ -0,0 +1,147 @@
+#include "sweepworker.h"
+
+#include <algorithm>
+
+#include "sweepline.h"
+
+SweepWorker::SweepWorker(std::function<void()> ready)
+    : ready(std::move(ready))
+{
+    thread = std::thread(&SweepWorker::run, this);
+}
+
+SweepWorker::~SweepWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        ++latest;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void SweepWorker::request(std::vector<Point> sites, int width, int height)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job.sites = std::move(sites);
+        job.width = width;
+        job.height = height;
+        job.generation = ++latest;
+        waiting = true;
+        if (result)
+            garbage.push_back(std::move(result));
+    }
+    wake.notify_one();
+}
+
+void SweepWorker::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++latest;
+        waiting = false;
+        job.sites.clear();
+        if (result)
+            garbage.push_back(std::move(result));
+    }
+    wake.notify_one();
+}
+
+std::unique_ptr<SweepWorker::Result> SweepWorker::take()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    // a superseded result is already in garbage
+    return std::move(result);
+}
+
+void SweepWorker::dispose(std::unique_ptr<Result> result)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        garbage.push_back(std::move(result));
+    }
+    wake.notify_one();
+}
+
+void SweepWorker::run()
+{
+    for (;;) {
+        Job current;
+        std::vector<std::unique_ptr<Result>> freeing;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] {
+                return waiting || stopping || !garbage.empty();
+            });
+            if (stopping)
+                return;
+            // freeing a diagram takes about as long as a sweep, so a waiting
+            // one goes first, unless two old diagrams would be kept around
+            if (waiting && garbage.size() <= 1) {
+                current = std::move(job);
+                waiting = false;
+            } else {
+                freeing.swap(garbage);
+            }
+        }
+        if (!freeing.empty())
+            continue;
+
+        auto swept = std::make_unique<Result>();
+        const bool done = sweep(current, *swept);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!done || current.generation != latest) {
+                garbage.push_back(std::move(swept));
+                continue;
+            }
+            result = std::move(swept);
+        }
+        ready();
+    }
+}
+
+bool SweepWorker::sweep(const Job& job, Result& swept) const
+{
+    auto superseded = [&] {
+        return latest.load(std::memory_order_relaxed) != job.generation;
+    };
+    swept.vmap = std::make_shared<Voronoi>(job.width, job.height);
+    Voronoi& vmap = *swept.vmap;
+    vmap.polygons.reserve(job.sites.size());
+    for (const Point& site : job.sites)
+        vmap.addPoly(Polygon(site));
+    SweepLine sl(swept.vmap);
+    while (sl.nextEvent() != sl.LMAXVALUE) {
+        if (superseded())
+            return false;
+    }
+    // clipping and syncing take more than half of the sweep, so they stop
+    // in between too
+    Dcel::ClipBuffers buffers;
+    sl.finishEdges(Rectangle(0, 0, job.width, job.height), buffers,
+                   superseded);
+    if (superseded())
+        return false;
+    // the thread asking for it is mostly idle meanwhile
+    vmap.syncPolygons(std::max(1u, std::thread::hardware_concurrency()),
+                      superseded);
+    if (superseded())
+        return false;
+
+    // collected a batch of cells at a time, to stop in between
+    const size_t batch = 1 << 14;
+    std::vector<const Polygon*> cells;
+    for (size_t begin = 0; begin < vmap.polygons.size(); begin += batch) {
+        if (superseded())
+            return false;
+        const size_t end = std::min(vmap.polygons.size(), begin + batch);
+        cells.clear();
+        for (size_t i = begin; i < end; ++i)
+            cells.push_back(vmap.polygons[i].get());
+        swept.lines.update(cells);
+    }
+    return true;
+}
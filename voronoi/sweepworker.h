@@ -0,0 +1,94 @@
+#ifndef SWEEPWORKER_H
+#define SWEEPWORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "diagramlines.h"
+#include "geometry/point.h"
+#include "voronoi.h"
+
+/**
+ * @brief SweepWorker performs fortune's algorithm on a thread of its own, so
+ * that whoever asks for a diagram doesn't wait for it.
+ *
+ * A request holds its own copy of the sites. There's at most one request
+ * waiting, a newer one takes its place, and a sweep whose request was
+ * superseded stops at its next event. Only the diagram of the newest request
+ * can be taken, so the worker never falls behind by more than one sweep.
+ *
+ * The segments of the diagram are collected on the worker too, and both can
+ * be handed back to be freed there, as that takes about as long as sweeping.
+ */
+class SweepWorker
+{
+public:
+    /**
+     * @param ready called on the worker thread once a diagram can be taken
+     */
+    explicit SweepWorker(std::function<void()> ready);
+    ~SweepWorker();
+
+    SweepWorker(const SweepWorker&) = delete;
+    SweepWorker& operator=(const SweepWorker&) = delete;
+
+    struct Result {
+        std::shared_ptr<Voronoi> vmap;
+        DiagramLines lines;
+    };
+
+    /**
+     * @brief sweep sites clipped to width and height instead of anything
+     * requested before, the polygons of the diagram are in the same order
+     */
+    void request(std::vector<Point> sites, int width, int height);
+    /**
+     * @brief drop the waiting request and stop the running sweep
+     */
+    void cancel();
+    /**
+     * @brief the diagram of the newest request, nullptr if it isn't done or
+     * was already taken
+     */
+    std::unique_ptr<Result> take();
+    /**
+     * @brief free result on the worker thread, before the next sweep
+     */
+    void dispose(std::unique_ptr<Result> result);
+
+private:
+    struct Job {
+        std::vector<Point> sites;
+        int width = 0, height = 0;
+        uint64_t generation = 0;
+    };
+
+    std::function<void()> ready;
+    std::mutex mutex;
+    std::condition_variable wake;
+    // generation of the newest request or cancel, read between events
+    std::atomic<uint64_t> latest{0};
+    bool waiting = false;
+    bool stopping = false;
+    Job job;
+    // the newest request's, superseded ones are moved to garbage
+    std::unique_ptr<Result> result;
+    std::vector<std::unique_ptr<Result>> garbage;
+    std::thread thread;
+
+    void run();
+    /**
+     * @brief sweep job into swept
+     * @return false if the job was superseded before it was done, swept is
+     * left half way then
+     */
+    bool sweep(const Job& job, Result& swept) const;
+};
+
+#endif  // SWEEPWORKER_H
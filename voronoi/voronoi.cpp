@@ -1,25 +1,107 @@
 #include "voronoi.h"
 
 #include <algorithm>
+#include <atomic>
 
-Voronoi::Voronoi(int width, int height)
+#include "data_structure/parallelfor.h"
+#include "sweepline.h"
+
+namespace
+{
+template <class A, class B>
+double squaredDistance(const BasicPoint<A>& a, const BasicPoint<B>& b)
+{
+    double dx = (double) a.x - b.x;
+    double dy = (double) a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+template <class T>
+bool inside(const BasicRectangle<T>& rect, const BasicPoint<T>& point)
+{
+    return point.x >= rect.x && point.x <= rect.getRight() &&
+           point.y >= rect.y && point.y <= rect.getBottom();
+}
+
+template <class T>
+std::pair<T, T> siteKey(const BasicPoint<T>& site)
+{
+    return {site.x, site.y};
+}
+
+template <class T>
+bool contains(const std::vector<T>& items, const T& item)
+{
+    return std::find(items.begin(), items.end(), item) != items.end();
+}
+
+void sortUnique(std::vector<size_t>& items)
+{
+    std::sort(items.begin(), items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+}
+
+/**
+ * @brief call fn(h) for every half-edge around face
+ */
+template <class Diagram, class Fn>
+void forEachHalfEdge(const Diagram& dcel, DcelBase::index face, Fn fn)
+{
+    const DcelBase::index start = dcel.faces[face].halfEdge;
+    if (start == DcelBase::npos)
+        return;
+    DcelBase::index h = start;
+    do {
+        fn(h);
+        h = dcel.halfEdges[h].next;
+    } while (h != start);
+}
+
+/**
+ * @brief whether a vertex of face lies on the clip border, give or take
+ * tolerance, i.e. its cell may go on outside the clip bounds
+ */
+template <class Diagram>
+bool reachesBorder(const Diagram& dcel, DcelBase::index face, double tolerance)
+{
+    const double x0 = dcel.bounds.x, x1 = x0 + dcel.bounds.width;
+    const double y0 = dcel.bounds.y, y1 = y0 + dcel.bounds.height;
+    bool found = false;
+    forEachHalfEdge(dcel, face, [&](DcelBase::index h) {
+        const double x = dcel.vertices[dcel.origin(h)].x;
+        const double y = dcel.vertices[dcel.origin(h)].y;
+        found = found || std::abs(x - x0) <= tolerance ||
+                std::abs(x - x1) <= tolerance ||
+                std::abs(y - y0) <= tolerance || std::abs(y - y1) <= tolerance;
+    });
+    return found;
+}
+}  // namespace
+
+template <class Coord, class Real>
+BasicVoronoi<Coord, Real>::BasicVoronoi(Coord width, Coord height)
     : width(width),
       height(height)
 {
 }
 
-Voronoi::polygons_iterator Voronoi::addPoly(const Polygon& poly)
+template <class Coord, class Real>
+typename BasicVoronoi<Coord, Real>::polygons_iterator
+BasicVoronoi<Coord, Real>::addPoly(const Polygon& poly)
 {
     return polygons.insert(polygons.end(), std::make_shared<Polygon>(poly));
 }
 
-Voronoi::polygons_iterator Voronoi::addPoly(
-    const std::shared_ptr<Polygon>& poly_ptr)
+template <class Coord, class Real>
+typename BasicVoronoi<Coord, Real>::polygons_iterator
+BasicVoronoi<Coord, Real>::addPoly(const std::shared_ptr<Polygon>& poly_ptr)
 {
     return polygons.insert(polygons.end(), poly_ptr);
 }
 
-Voronoi::polygons_iterator Voronoi::erasePoly(const Polygon& poly)
+template <class Coord, class Real>
+typename BasicVoronoi<Coord, Real>::polygons_iterator
+BasicVoronoi<Coord, Real>::erasePoly(const Polygon& poly)
 {
     auto it = std::find_if(
         polygons.begin(), polygons.end(),
@@ -27,9 +109,670 @@ Voronoi::polygons_iterator Voronoi::erasePoly(const Polygon& poly)
     return polygons.erase(it);
 }
 
-Voronoi::polygons_iterator Voronoi::erasePoly(
-    const std::shared_ptr<Polygon>& poly_ptr)
+template <class Coord, class Real>
+typename BasicVoronoi<Coord, Real>::polygons_iterator
+BasicVoronoi<Coord, Real>::erasePoly(const std::shared_ptr<Polygon>& poly_ptr)
 {
     auto it = std::find(polygons.begin(), polygons.end(), poly_ptr);
     return polygons.erase(it);
 }
+
+template <class Coord, class Real>
+void BasicVoronoi<Coord, Real>::syncPolygons(
+    unsigned threads,
+    const std::function<bool()>& stop)
+{
+    std::atomic<bool> stopped{false};
+    auto stopAt = [&](size_t i) {
+        if (stop && i % 4096 == 0 && !stopped && stop())
+            stopped = true;
+        return stopped.load(std::memory_order_relaxed);
+    };
+    threads = chunkThreads(threads, polygons.size(), 1 << 12);
+    forEachChunk(threads, polygons.size(),
+                 [&](unsigned, size_t begin, size_t end) {
+                     for (size_t i = begin; i < end && !stopAt(i); ++i) {
+                         polygons[i]->edges.clear();
+                         polygons[i]->unOrganize();
+                     }
+                 });
+    if (stopped)
+        return;
+    polygonFaces.assign(polygons.size(), npos);
+    outsideSites = 0;
+    stale = false;
+    for (index f = 0; f < dcel.faces.size(); ++f) {
+        const typename Dcel::Face& face = dcel.faces[f];
+        if (dcel.removed(face))
+            continue;
+        polygonFaces[face.polygon] = f;
+        if (dcel.clipped && !inside(dcel.bounds, face.site))
+            ++outsideSites;
+    }
+    duplicates.clear();
+    for (size_t i = 0; i < polygons.size(); ++i) {
+        if (polygonFaces[i] == npos)
+            duplicates.emplace(siteKey(polygons[i]->focus), i);
+    }
+
+    // neighbouring polygons share the point of a vertex, so create those
+    // before the polygons are filled in parallel
+    std::vector<std::shared_ptr<Vertex>> points(dcel.vertices.size());
+    std::vector<uint8_t> used(dcel.vertices.size(), 0);
+    for (const auto& half : dcel.halfEdges) {
+        if (!dcel.removed(half) && half.origin != npos)
+            used[half.origin] = 1;
+    }
+    forEachChunk(chunkThreads(threads, points.size(), 1 << 14), points.size(),
+                 [&](unsigned, size_t begin, size_t end) {
+                     for (size_t v = begin; v < end && !stopAt(v); ++v) {
+                         if (used[v])
+                             points[v] = std::make_shared<Vertex>(
+                                 dcel.vertices[v]);
+                     }
+                 });
+    if (stopped)
+        return;
+    auto pointAt = [&](index v) -> std::shared_ptr<Vertex> {
+        return v == npos ? nullptr : points[v];
+    };
+    auto addEdge = [&](Polygon& poly, index h) {
+        auto edge = std::make_shared<Edge>();
+        edge->a = pointAt(dcel.origin(h));
+        edge->b = pointAt(dcel.destination(h));
+        poly.edges.push_back(std::move(edge));
+    };
+
+    // bucket half-edges by face, for faces whose boundary isn't a cycle yet
+    const size_t faceCount = dcel.faces.size();
+    std::vector<index> offsets(faceCount + 1, 0);
+    for (const auto& half : dcel.halfEdges) {
+        if (!dcel.removed(half))
+            ++offsets[half.face + 1];
+    }
+    for (size_t f = 0; f < faceCount; ++f)
+        offsets[f + 1] += offsets[f];
+    std::vector<index> faceEdges(dcel.halfEdges.size());
+    {
+        std::vector<index> fill(offsets.begin(), offsets.end() - 1);
+        for (index h = 0; h < dcel.halfEdges.size(); ++h) {
+            if (!dcel.removed(dcel.halfEdges[h]))
+                faceEdges[fill[dcel.halfEdges[h].face]++] = h;
+        }
+    }
+
+    std::vector<uint8_t> visited(dcel.halfEdges.size(), 0);
+    auto syncFace = [&](index f) {
+        const typename Dcel::Face& face = dcel.faces[f];
+        if (dcel.removed(face))
+            return;
+        Polygon& poly = *polygons[face.polygon];
+        poly.edges.reserve(offsets[f + 1] - offsets[f]);
+
+        // walking `next` from any half-edge goes counter-clockwise, if it
+        // comes back with every vertex known the cell is closed
+        bool complete = face.halfEdge != npos;
+        index h = face.halfEdge;
+        do {
+            if (h == npos || dcel.origin(h) == npos) {
+                complete = false;
+                break;
+            }
+            h = dcel.halfEdges[h].next;
+        } while (h != face.halfEdge);
+        if (complete) {
+            do {
+                addEdge(poly, h);
+                h = dcel.halfEdges[h].next;
+            } while (h != face.halfEdge);
+            poly.markOrganized(true);
+            return;
+        }
+
+        // open cell, emit each chain from its first half-edge on. Half-edges
+        // without any known vertex, like those of an edge just created or
+        // clipped away, have nothing to show
+        auto unknown = [&](index h) {
+            return dcel.origin(h) == npos && dcel.destination(h) == npos;
+        };
+        for (index i = offsets[f]; i < offsets[f + 1]; ++i) {
+            if (dcel.halfEdges[faceEdges[i]].prev != npos ||
+                unknown(faceEdges[i]))
+                continue;
+            for (h = faceEdges[i]; h != npos; h = dcel.halfEdges[h].next) {
+                visited[h] = 1;
+                addEdge(poly, h);
+            }
+        }
+        for (index i = offsets[f]; i < offsets[f + 1]; ++i) {
+            if (!visited[faceEdges[i]] && !unknown(faceEdges[i]))
+                addEdge(poly, faceEdges[i]);
+        }
+        poly.markOrganized(false);
+    };
+    forEachChunk(chunkThreads(threads, faceCount, 1 << 12), faceCount,
+                 [&](unsigned, size_t begin, size_t end) {
+                     for (size_t f = begin; f < end && !stopAt(f); ++f)
+                         syncFace((index) f);
+                 });
+}
+
+template <class Coord, class Real>
+std::vector<size_t> BasicVoronoi<Coord, Real>::insertSite(const Site& site)
+{
+    std::optional<std::vector<size_t>> changed = tryInsertSite(site);
+    return changed ? std::move(*changed) : sweepAll();
+}
+
+template <class Coord, class Real>
+std::vector<size_t> BasicVoronoi<Coord, Real>::eraseSite(size_t polygon)
+{
+    std::optional<std::vector<size_t>> changed = tryEraseSite(polygon);
+    return changed ? std::move(*changed) : sweepAll();
+}
+
+template <class Coord, class Real>
+std::vector<size_t> BasicVoronoi<Coord, Real>::moveSite(size_t polygon,
+                                                         const Site& site)
+{
+    std::optional<std::vector<size_t>> changed = tryMoveSite(polygon, site);
+    return changed ? std::move(*changed) : sweepAll();
+}
+
+template <class Coord, class Real>
+std::optional<std::vector<size_t>> BasicVoronoi<Coord, Real>::tryInsertSite(
+    const Site& site)
+{
+    delaunay.clear();
+    addPoly(Polygon(site));
+    const size_t polygon = polygons.size() - 1;
+    polygonFaces.push_back(npos);
+    if (stale || !dcel.clipped || outsideSites > 0 ||
+        !inside(dcel.bounds, site))
+        return fallBack();
+
+    std::vector<size_t> changed{polygon};
+    if (!placeSite(polygon, changed))
+        return fallBack();
+    sortUnique(changed);
+    return changed;
+}
+
+template <class Coord, class Real>
+std::optional<std::vector<size_t>> BasicVoronoi<Coord, Real>::tryEraseSite(
+    size_t polygon)
+{
+    delaunay.clear();
+    std::vector<size_t> changed;
+    if (stale) {
+        erasePolygonAt(polygon, changed);
+        return fallBack();
+    }
+    if (polygonFaces[polygon] == npos) {
+        dropDuplicate(polygon);
+        erasePolygonAt(polygon, changed);
+        return changed;
+    }
+    if (!dcel.clipped || outsideSites > 0) {
+        erasePolygonAt(polygon, changed);
+        return fallBack();
+    }
+
+    if (!handOverFace(polygon, changed) && !removeCell(polygon, changed)) {
+        erasePolygonAt(polygon, changed);
+        return fallBack();
+    }
+    erasePolygonAt(polygon, changed);
+    sortUnique(changed);
+    return changed;
+}
+
+template <class Coord, class Real>
+std::optional<std::vector<size_t>> BasicVoronoi<Coord, Real>::tryMoveSite(
+    size_t polygon,
+    const Site& site)
+{
+    Polygon& poly = *polygons[polygon];
+    if (poly.focus == site)
+        return std::vector<size_t>();
+    delaunay.clear();
+    if (stale || !dcel.clipped || outsideSites > 0 ||
+        !inside(dcel.bounds, site)) {
+        poly.focus = site;
+        return fallBack();
+    }
+
+    std::vector<size_t> changed{polygon};
+    if (polygonFaces[polygon] == npos) {
+        dropDuplicate(polygon);
+    } else if (!handOverFace(polygon, changed) &&
+               !removeCell(polygon, changed)) {
+        poly.focus = site;
+        return fallBack();
+    }
+    poly.focus = site;
+    if (!placeSite(polygon, changed))
+        return fallBack();
+    sortUnique(changed);
+    return changed;
+}
+
+template <class Coord, class Real>
+bool BasicVoronoi<Coord, Real>::placeSite(size_t polygon,
+                                          std::vector<size_t>& changed)
+{
+    Polygon& poly = *polygons[polygon];
+    index nearest = nearestFace(PointF(poly.focus));
+    if (nearest != npos && dcel.faces[nearest].site == poly.focus) {
+        // like in the sweep, a duplicate site gets no cell
+        duplicates.emplace(siteKey(poly.focus), polygon);
+        poly.edges.clear();
+        poly.markOrganized(false);
+        return true;
+    }
+    index face = dcel.addFace(poly.focus, (index) polygon);
+    polygonFaces[polygon] = face;
+    return attachFace(face, nearest, changed);
+}
+
+template <class Coord, class Real>
+bool BasicVoronoi<Coord, Real>::handOverFace(size_t polygon,
+                                             std::vector<size_t>& changed)
+{
+    const index face = polygonFaces[polygon];
+    auto duplicate = duplicates.find(siteKey(dcel.faces[face].site));
+    if (duplicate == duplicates.end())
+        return false;
+    const size_t i = duplicate->second;
+    duplicates.erase(duplicate);
+    dcel.faces[face].polygon = (index) i;
+    polygonFaces[i] = face;
+    polygonFaces[polygon] = npos;
+    syncPolygon(face);
+    changed.push_back(i);
+    return true;
+}
+
+template <class Coord, class Real>
+bool BasicVoronoi<Coord, Real>::removeCell(size_t polygon,
+                                           std::vector<size_t>& changed)
+{
+    const index face = polygonFaces[polygon];
+    if (!detachFace(face, changed))
+        return false;
+    dcel.removeFace(face);
+    polygonFaces[polygon] = npos;
+    return true;
+}
+
+template <class Coord, class Real>
+void BasicVoronoi<Coord, Real>::erasePolygonAt(size_t polygon,
+                                               std::vector<size_t>& changed)
+{
+    const size_t last = polygons.size() - 1;
+    if (polygon != last) {
+        auto duplicate = findDuplicate(last);
+        if (duplicate != duplicates.end())
+            duplicate->second = polygon;
+        polygons[polygon] = std::move(polygons[last]);
+        polygonFaces[polygon] = polygonFaces[last];
+        if (polygonFaces[polygon] != npos)
+            dcel.faces[polygonFaces[polygon]].polygon = (index) polygon;
+        std::replace(changed.begin(), changed.end(), last, polygon);
+    }
+    polygons.pop_back();
+    polygonFaces.pop_back();
+}
+
+template <class Coord, class Real>
+typename std::multimap<std::pair<Coord, Coord>, size_t>::iterator
+BasicVoronoi<Coord, Real>::findDuplicate(size_t polygon)
+{
+    if (polygonFaces[polygon] != npos)
+        return duplicates.end();
+    auto [first, end] =
+        duplicates.equal_range(siteKey(polygons[polygon]->focus));
+    for (auto it = first; it != end; ++it) {
+        if (it->second == polygon)
+            return it;
+    }
+    return duplicates.end();
+}
+
+template <class Coord, class Real>
+void BasicVoronoi<Coord, Real>::dropDuplicate(size_t polygon)
+{
+    auto duplicate = findDuplicate(polygon);
+    if (duplicate != duplicates.end())
+        duplicates.erase(duplicate);
+}
+
+template <class Coord, class Real>
+void BasicVoronoi<Coord, Real>::syncPolygon(index face)
+{
+    Polygon& poly = *polygons[dcel.faces[face].polygon];
+    poly.edges.clear();
+    forEachHalfEdge(dcel, face, [&](index h) {
+        poly.edges.push_back(
+            std::make_shared<Edge>(dcel.vertices[dcel.origin(h)],
+                                   dcel.vertices[dcel.destination(h)]));
+    });
+    poly.markOrganized(!poly.edges.empty());
+}
+
+template <class Coord, class Real>
+std::vector<size_t> BasicVoronoi<Coord, Real>::sweepAll()
+{
+    const Bounds bounds =
+        dcel.clipped ? dcel.bounds : Bounds(0, 0, width, height);
+    // SweepLine wants shared ownership, hand it a pointer that doesn't own
+    BasicSweepLine<Coord, Real> sweep(
+        std::shared_ptr<BasicVoronoi>(std::shared_ptr<BasicVoronoi>(), this));
+    sweep.performFortune(bounds);
+    std::vector<size_t> changed(polygons.size());
+    for (size_t i = 0; i < changed.size(); ++i)
+        changed[i] = i;
+    return changed;
+}
+
+template <class Coord, class Real>
+std::nullopt_t BasicVoronoi<Coord, Real>::fallBack()
+{
+    stale = true;
+    return std::nullopt;
+}
+
+template <class Coord, class Real>
+DcelBase::index BasicVoronoi<Coord, Real>::nearestFace(
+    const PointF& point) const
+{
+    auto hasCell = [this](index f) {
+        return !dcel.removed(dcel.faces[f]) &&
+               dcel.faces[f].halfEdge != npos;
+    };
+    index face = lastFace;
+    if (face >= dcel.faces.size() || !hasCell(face)) {
+        face = 0;
+        while (face < dcel.faces.size() && !hasCell(face))
+            ++face;
+        if (face == dcel.faces.size())
+            return npos;
+    }
+    // move to the closest neighbour as long as there's a closer one, all
+    // sites lying inside the clip bounds, so do their shared edges
+    double best = squaredDistance(dcel.faces[face].site, point);
+    for (index cur = npos; cur != face;) {
+        cur = face;
+        forEachHalfEdge(dcel, cur, [&](index h) {
+            index twin = dcel.twin(h);
+            if (twin == npos)
+                return;
+            index other = dcel.halfEdges[twin].face;
+            double d = squaredDistance(dcel.faces[other].site, point);
+            if (d < best) {
+                best = d;
+                face = other;
+            }
+        });
+    }
+    return face;
+}
+
+template <class Coord, class Real>
+bool BasicVoronoi<Coord, Real>::attachFace(index face,
+                                           index nearest,
+                                           std::vector<size_t>& changed)
+{
+    const PointF site(dcel.faces[face].site);
+
+    // the new cell takes part of a cell iff one of its vertices is at least
+    // as close to the new site as to its own, such cells are connected
+    auto reaches = [&](index f) {
+        bool found = false;
+        const PointF own(dcel.faces[f].site);
+        forEachHalfEdge(dcel, f, [&](index h) {
+            const PointF v(dcel.vertices[dcel.origin(h)]);
+            double d = squaredDistance(v, own);
+            found = found || squaredDistance(v, site) <= d + 1e-9 * (d + 1);
+        });
+        return found;
+    };
+    std::vector<index> cells;
+    if (nearest != npos)
+        cells.push_back(nearest);
+    for (size_t i = 0; i < cells.size(); ++i) {
+        forEachHalfEdge(dcel, cells[i], [&](index h) {
+            index twin = dcel.twin(h);
+            if (twin == npos)
+                return;
+            index other = dcel.halfEdges[twin].face;
+            if (!contains(cells, other) && reaches(other))
+                cells.push_back(other);
+        });
+    }
+    cells.push_back(face);
+    if (!rebuildCells(cells, npos, changed))
+        return false;
+    lastFace = face;
+    return true;
+}
+
+template <class Coord, class Real>
+bool BasicVoronoi<Coord, Real>::detachFace(index face,
+                                           std::vector<size_t>& changed)
+{
+    // a removed cell is shared among its neighbours only
+    std::vector<index> cells;
+    forEachHalfEdge(dcel, face, [&](index h) {
+        index twin = dcel.twin(h);
+        if (twin == npos)
+            return;
+        index other = dcel.halfEdges[twin].face;
+        if (!contains(cells, other))
+            cells.push_back(other);
+    });
+    if (!rebuildCells(cells, face, changed))
+        return false;
+    if (!cells.empty())
+        lastFace = cells.front();
+    return true;
+}
+
+template <class Coord, class Real>
+bool BasicVoronoi<Coord, Real>::rebuildCells(std::vector<index> cells,
+                                             index removed,
+                                             std::vector<size_t>& changed)
+{
+    const double tolerance = 1e-6 * (dcel.bounds.width + dcel.bounds.height);
+    // edges outside the clip bounds aren't on any cycle, and the splice below
+    // leaves them alone. They stay right as long as the cell added or removed
+    // lies inside the bounds, as the cells only change within it
+    if (removed != npos && reachesBorder(dcel, removed, tolerance))
+        return false;
+    auto near = [tolerance](const Vertex& a, const Vertex& b) {
+        return std::abs((double) a.x - b.x) <= tolerance &&
+               std::abs((double) a.y - b.y) <= tolerance;
+    };
+
+    std::shared_ptr<BasicVoronoi> local;
+    std::vector<index> globalFace, localFace, localVertex;
+    // local half-edges shared with a cell that's kept, and their global twin
+    std::vector<std::pair<index, index>> kept;
+    for (;;) {
+        // every new neighbour of a cell is an old neighbour of one of them, so
+        // sweeping cells and their neighbours gets their new cells right
+        std::vector<index> sites = cells;
+        for (index f : cells) {
+            forEachHalfEdge(dcel, f, [&](index h) {
+                index twin = dcel.twin(h);
+                if (twin == npos)
+                    return;
+                index other = dcel.halfEdges[twin].face;
+                if (other != removed && !contains(sites, other))
+                    sites.push_back(other);
+            });
+        }
+        local = std::make_shared<BasicVoronoi>(width, height);
+        for (index f : sites)
+            local->addPoly(Polygon(dcel.faces[f].site));
+        BasicSweepLine<Coord, Real> sweep(local);
+        while (sweep.nextEvent() != sweep.LMAXVALUE)
+            ;
+        sweep.finishEdges(dcel.bounds);
+        const Dcel& ld = local->dcel;
+
+        globalFace.resize(ld.faces.size());
+        localFace.assign(sites.size(), npos);
+        for (index lf = 0; lf < ld.faces.size(); ++lf) {
+            globalFace[lf] = sites[ld.faces[lf].polygon];
+            localFace[ld.faces[lf].polygon] = lf;
+        }
+
+        // a neighbour that keeps its cell must see the same edge as before,
+        // which rounding or cocircular sites can break, then it's swept again
+        // as well
+        std::vector<index> grow;
+        kept.clear();
+        localVertex.assign(ld.vertices.size(), npos);
+        auto keepVertex = [&](index lv, index gv) {
+            if (localVertex[lv] != npos && localVertex[lv] != gv)
+                return false;
+            localVertex[lv] = gv;
+            return true;
+        };
+        for (size_t i = 0; i < cells.size(); ++i) {
+            const index g = cells[i];
+            const index lf = localFace[i];
+            if (lf == npos || ld.faces[lf].halfEdge == npos)
+                return false;
+            // a face without a cycle yet is the one being added
+            if (dcel.faces[g].halfEdge == npos &&
+                reachesBorder(ld, lf, tolerance))
+                return false;
+            std::vector<index> matched;
+            forEachHalfEdge(ld, lf, [&](index e) {
+                index te = ld.twin(e);
+                if (te == npos)
+                    return;
+                index other = globalFace[ld.halfEdges[te].face];
+                if (contains(cells, other))
+                    return;
+                index x = npos;
+                forEachHalfEdge(dcel, g, [&](index h) {
+                    index twin = dcel.twin(h);
+                    if (twin != npos && dcel.halfEdges[twin].face == other)
+                        x = h;
+                });
+                if (x == npos ||
+                    !near(ld.vertices[ld.origin(e)],
+                          dcel.vertices[dcel.origin(x)]) ||
+                    !near(ld.vertices[ld.destination(e)],
+                          dcel.vertices[dcel.destination(x)]) ||
+                    !keepVertex(ld.origin(e), dcel.origin(x)) ||
+                    !keepVertex(ld.destination(e), dcel.destination(x))) {
+                    grow.push_back(other);
+                    return;
+                }
+                matched.push_back(x);
+                kept.emplace_back(e, x);
+            });
+            forEachHalfEdge(dcel, g, [&](index h) {
+                index twin = dcel.twin(h);
+                if (twin == npos)
+                    return;
+                index other = dcel.halfEdges[twin].face;
+                if (other != removed && !contains(cells, other) &&
+                    !contains(matched, h))
+                    grow.push_back(other);
+            });
+        }
+        if (grow.empty())
+            break;
+        for (index f : grow) {
+            if (!contains(cells, f))
+                cells.push_back(f);
+        }
+    }
+    const Dcel& ld = local->dcel;
+
+    // release the old cells, but the edges and vertices shared with cells
+    // that are kept
+    std::vector<index> dead, keptVertices;
+    for (const auto& [e, x] : kept) {
+        keptVertices.push_back(dcel.origin(x));
+        keptVertices.push_back(dcel.destination(x));
+    }
+    auto collect = [&](index f) {
+        forEachHalfEdge(dcel, f, [&](index h) {
+            bool isKept = std::any_of(kept.begin(), kept.end(),
+                                      [h](const auto& k) { return k.second == h; });
+            if (!isKept)
+                dead.push_back(h);
+        });
+        dcel.faces[f].halfEdge = npos;
+    };
+    for (index f : cells)
+        collect(f);
+    if (removed != npos)
+        collect(removed);
+    std::vector<index> deadVertices;
+    for (index h : dead) {
+        index v = dcel.origin(h);
+        if (!contains(keptVertices, v) && !contains(deadVertices, v))
+            deadVertices.push_back(v);
+    }
+    // removing a pair resets both halves, so decide before removing any
+    std::vector<index> deadEdges;
+    for (index h : dead) {
+        index twin = dcel.twin(h);
+        if (twin == npos || h < twin)
+            deadEdges.push_back(h);
+    }
+    for (index h : deadEdges)
+        dcel.removeEdge(h);
+    for (index v : deadVertices)
+        dcel.removeVertex(v);
+
+    // splice in the new cells
+    auto vertexOf = [&](index lv) {
+        if (localVertex[lv] == npos)
+            localVertex[lv] = dcel.addVertex(ld.vertices[lv]);
+        return localVertex[lv];
+    };
+    std::vector<index> globalEdge(ld.halfEdges.size(), npos);
+    for (const auto& [e, x] : kept)
+        globalEdge[e] = x;
+    for (size_t i = 0; i < cells.size(); ++i) {
+        const index g = cells[i];
+        forEachHalfEdge(ld, localFace[i], [&](index e) {
+            if (globalEdge[e] != npos)
+                return;
+            index te = ld.twin(e);
+            if (te == npos) {
+                globalEdge[e] = dcel.addHalfEdge(g, vertexOf(ld.origin(e)));
+                return;
+            }
+            index h =
+                dcel.addEdge(g, globalFace[ld.halfEdges[te].face]);
+            dcel.halfEdges[h].origin = vertexOf(ld.origin(e));
+            dcel.halfEdges[h + 1].origin = vertexOf(ld.origin(te));
+            globalEdge[e] = h;
+            globalEdge[te] = h + 1;
+        });
+    }
+    for (size_t i = 0; i < cells.size(); ++i) {
+        forEachHalfEdge(ld, localFace[i], [&](index e) {
+            dcel.link(globalEdge[e], globalEdge[ld.halfEdges[e].next]);
+        });
+        dcel.faces[cells[i]].halfEdge =
+            globalEdge[ld.faces[localFace[i]].halfEdge];
+        syncPolygon(cells[i]);
+        changed.push_back(dcel.faces[cells[i]].polygon);
+    }
+    return true;
+}
+
+template class BasicVoronoi<int, double>;
+template class BasicVoronoi<int, float>;
+template class BasicVoronoi<double, double>;
+template class BasicVoronoi<int64_t, double>;
@@ -1,27 +1,196 @@
 #ifndef VORONOI_H
 #define VORONOI_H
 
+#include <functional>
+#include <map>
+#include <optional>
+#include <utility>
 #include <vector>
 
+#include "dcel.h"
+#include "delaunay.h"
 #include "geometry/polygon.h"
 
-class Voronoi
+/**
+ * @brief BasicVoronoi holds sites with Coord coordinates and their diagram,
+ * whose vertices have Real coordinates, see BasicSweepLine
+ */
+template <class Coord, class Real>
+class BasicVoronoi
 {
 public:
-    Voronoi() = default;
-    Voronoi(int width, int height);
+    using Site = BasicPoint<Coord>;
+    using Vertex = BasicPoint<Real>;
+    using Bounds = BasicRectangle<Coord>;
+    using Polygon = BasicPolygon<Coord, Real>;
+    using Edge = BasicEdge<Real>;
+    using Dcel = BasicDcel<Coord, Real>;
+    using index = DcelBase::index;
+    static constexpr index npos = DcelBase::npos;
 
-    int width;
-    int height;
+    BasicVoronoi() = default;
+    BasicVoronoi(Coord width, Coord height);
+
+    Coord width;
+    Coord height;
     std::vector<std::shared_ptr<Polygon>> polygons;
     using polygons_const_iterator =
-        std::vector<std::shared_ptr<Polygon>>::const_iterator;
-    using polygons_iterator = std::vector<std::shared_ptr<Polygon>>::iterator;
+        typename std::vector<std::shared_ptr<Polygon>>::const_iterator;
+    using polygons_iterator =
+        typename std::vector<std::shared_ptr<Polygon>>::iterator;
+
+    /**
+     * @brief diagram computed by SweepLine, faces refer to `polygons` by index
+     * thus it's only valid until polygons are added or erased
+     */
+    Dcel dcel;
+    /**
+     * @brief triangulation recorded by a sweep whose output has triangles,
+     * see DelaunayOutput, empty otherwise. The incremental updates below
+     * don't maintain it and clear it
+     */
+    Delaunay delaunay;
 
     polygons_iterator addPoly(const Polygon&);
     polygons_iterator addPoly(const std::shared_ptr<Polygon>&);
     polygons_iterator erasePoly(const Polygon&);
     polygons_iterator erasePoly(const std::shared_ptr<Polygon>&);
+
+    /**
+     * @brief face of every polygon in `dcel`, npos for a polygon whose focus
+     * duplicates an earlier one's. Set by syncPolygons and kept up to date by
+     * the incremental updates below
+     */
+    std::vector<index> polygonFaces;
+
+    /**
+     * @brief rebuild `edges` of every polygon from `dcel`
+     * every polygon gets its own Edge per half-edge, in counter-clockwise
+     * order and with completeness already marked. Endpoints not yet known by
+     * the sweep are left null
+     * @param threads number of threads to split the polygons across, 0 for
+     * hardware concurrency
+     * @param stop checked by every thread between batches of polygons, once
+     * it returns true syncPolygons returns and leaves them half synced
+     */
+    void syncPolygons(unsigned threads = 1,
+                      const std::function<bool()>& stop = nullptr);
+
+    /**
+     * @brief add a polygon with focus site to the computed diagram
+     * Incremental updates need `dcel` to be the clipped result of
+     * SweepLine::performFortune. Only the cells around the change are swept
+     * again and spliced into `dcel`, which takes time proportional to their
+     * number as long as every site lies inside the clip bounds and the cell
+     * added or removed doesn't reach their border, past which edges aren't
+     * spliced. Otherwise the whole diagram is swept again.
+     * @return indices into polygons of the cells that changed, including the
+     * new polygon, which is appended to polygons
+     */
+    std::vector<size_t> insertSite(const Site& site);
+    /**
+     * @brief erase polygons[polygon] from the computed diagram, the last
+     * polygon is moved into its place
+     * @return indices into polygons of the cells that changed, valid after
+     * the move
+     */
+    std::vector<size_t> eraseSite(size_t polygon);
+    /**
+     * @brief move the focus of polygons[polygon] to site
+     * @return indices into polygons of the cells that changed, including
+     * polygon
+     */
+    std::vector<size_t> moveSite(size_t polygon, const Site& site);
+
+    /**
+     * @brief insertSite, eraseSite and moveSite without the full sweep
+     * The polygons are edited all the same, but where the others would sweep
+     * everything again these return nullopt and leave `dcel` stale. Later
+     * calls return nullopt as well, until a sweep syncs the polygons again
+     */
+    std::optional<std::vector<size_t>> tryInsertSite(const Site& site);
+    std::optional<std::vector<size_t>> tryEraseSite(size_t polygon);
+    std::optional<std::vector<size_t>> tryMoveSite(size_t polygon,
+                                                   const Site& site);
+
+private:
+    // where the next search for a site's face starts from
+    index lastFace = 0;
+    // polygons without a face by their site, which another polygon's face
+    // has, and the number of faces whose site lies outside dcel.bounds
+    std::multimap<std::pair<Coord, Coord>, size_t> duplicates;
+    size_t outsideSites = 0;
+    // set when a try call gave up, dcel doesn't match polygons anymore
+    bool stale = false;
+
+    std::vector<size_t> sweepAll();
+    /**
+     * @brief mark dcel stale, for a try call giving up
+     */
+    std::nullopt_t fallBack();
+    /**
+     * @brief face whose site is nearest to point, walking the cells
+     * @return npos if there's no face with a cell
+     */
+    index nearestFace(const PointF& point) const;
+    /**
+     * @brief give face, whose site is set already, its cell by shrinking the
+     * cells around it
+     * @param nearest face whose site is nearest to face's, npos if face is
+     * the only one
+     */
+    bool attachFace(index face,
+                    index nearest,
+                    std::vector<size_t>& changed);
+    /**
+     * @brief hand the cell of face over to its neighbours, face keeps no
+     * half-edges but isn't removed
+     */
+    bool detachFace(index face, std::vector<size_t>& changed);
+    /**
+     * @brief give polygons[polygon], which has no face, a cell around its
+     * focus, or count it as duplicate if another face has the same site
+     */
+    bool placeSite(size_t polygon, std::vector<size_t>& changed);
+    /**
+     * @brief hand the face of polygons[polygon] to a duplicate of its site
+     * @return false if there's no duplicate
+     */
+    bool handOverFace(size_t polygon, std::vector<size_t>& changed);
+    /**
+     * @brief hand the cell of polygons[polygon] over to its neighbours and
+     * remove its face
+     */
+    bool removeCell(size_t polygon, std::vector<size_t>& changed);
+    /**
+     * @brief sweep cells again together with their neighbours, and splice
+     * the new cells into dcel
+     * @param removed face whose cell is handed over to cells, or npos
+     * @param changed polygons of the rebuilt cells are appended to it
+     * @return false if the local result can't be spliced, dcel is left as it
+     * was then
+     */
+    bool rebuildCells(std::vector<index> cells,
+                      index removed,
+                      std::vector<size_t>& changed);
+    /**
+     * @brief rebuild edges of the polygon of face from its cycle
+     */
+    void syncPolygon(index face);
+    void erasePolygonAt(size_t polygon, std::vector<size_t>& changed);
+    /**
+     * @brief entry of polygons[polygon] in duplicates, end() if it has none
+     */
+    typename std::multimap<std::pair<Coord, Coord>, size_t>::iterator
+    findDuplicate(size_t polygon);
+    void dropDuplicate(size_t polygon);
 };
 
+using Voronoi = BasicVoronoi<int, double>;
+
+extern template class BasicVoronoi<int, double>;
+extern template class BasicVoronoi<int, float>;
+extern template class BasicVoronoi<double, double>;
+extern template class BasicVoronoi<int64_t, double>;
+
 #endif  // VORONOI_H